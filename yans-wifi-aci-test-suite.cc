@@ -0,0 +1,745 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+/*
+ * Tests of the wifi channel with adjacent channel interference: overlap
+ * factors, expiry and distance-bounded reuse of the link loss cache,
+ * delivery to sleeping and energy-only receivers, coalescing of CCA busy
+ * notifications and event order of the bucket scheduler.
+ *
+ * Copy this file to src/wifi/test and add it to the test sources of the
+ * wifi module in src/wifi/wscript, then run
+ *   ./test.py -s yans-wifi-aci
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/yans-wifi-bucket-scheduler.h"
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * Create a YansWifiPhy on a new node at the given position and connect it to the channel.
+ *
+ * \param channel the channel
+ * \param position the position of the node
+ * \param frequency the central frequency in MHz
+ * \param width the channel width in MHz
+ *
+ * \return the PHY
+ */
+Ptr<YansWifiPhy>
+CreatePhy (Ptr<YansWifiChannel> channel, Vector position, uint32_t frequency, uint32_t width)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> device = CreateObject<WifiNetDevice> ();
+  node->AddDevice (device);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (position);
+  node->AggregateObject (mobility);
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+  phy->SetDevice (device);
+  phy->SetMobility (mobility);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211ac);
+  //so that the frequency is applied at once, not saved for the initialization
+  phy->Initialize ();
+  phy->SetChannelWidth (width);
+  phy->SetFrequency (frequency);
+  phy->SetChannel (channel);
+  return phy;
+}
+
+/**
+ * Send a packet at VHT MCS 0 on 20 MHz.
+ *
+ * \param phy the sender
+ * \param size the size of the packet in bytes
+ */
+void
+SendPacket (Ptr<YansWifiPhy> phy, uint32_t size)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (WifiPhy::GetVhtMcs0 ());
+  txVector.SetChannelWidth (20);
+  txVector.SetNss (1);
+  txVector.SetTxPowerLevel (0);
+  phy->SendPacket (Create<Packet> (size), txVector, WIFI_PREAMBLE_VHT);
+}
+
+} //anonymous namespace
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Overlap factors of the 802.11ac masks
+ */
+class YansWifiOverlapFactorTestCase : public TestCase
+{
+public:
+  YansWifiOverlapFactorTestCase ();
+  virtual ~YansWifiOverlapFactorTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+YansWifiOverlapFactorTestCase::YansWifiOverlapFactorTestCase ()
+  : TestCase ("Overlap factors of co-channel, adjacent and partially overlapping configurations")
+{
+}
+
+YansWifiOverlapFactorTestCase::~YansWifiOverlapFactorTestCase ()
+{
+}
+
+void
+YansWifiOverlapFactorTestCase::DoRun (void)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<YansWifiPhy> a = CreatePhy (channel, Vector (0, 0, 0), 5180, 20);
+  Ptr<YansWifiPhy> b = CreatePhy (channel, Vector (1, 0, 0), 5180, 20);
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (channel->GetOverlapFactorDb (a, b), 0.0, 1e-9, "Co-channel signals are not attenuated");
+
+  b->SetFrequency (5200);
+  double adjacent = channel->GetOverlapFactorDb (a, b);
+  NS_TEST_ASSERT_MSG_LT (adjacent, 0.0, "Adjacent channel signals are attenuated");
+  NS_TEST_ASSERT_MSG_EQ_TOL (channel->GetOverlapFactorDb (b, a), adjacent, 1e-9,
+                             "The overlap factor of equal widths is symmetric");
+
+  b->SetFrequency (5220);
+  double next = channel->GetOverlapFactorDb (a, b);
+  NS_TEST_ASSERT_MSG_LT (next, adjacent, "The attenuation grows with the frequency offset");
+
+  //a 40 MHz receiver whose lower half is the channel of the sender
+  b->SetChannelWidth (40);
+  b->SetFrequency (5190);
+  double partial = channel->GetOverlapFactorDb (a, b);
+  NS_TEST_ASSERT_MSG_GT (partial, adjacent, "A partially overlapping channel is attenuated less than an adjacent one");
+  NS_TEST_ASSERT_MSG_LT (partial, 1e-9, "A partially overlapping channel is not amplified");
+
+  //back to the first configuration: the precomputed table gives the same factor
+  b->SetChannelWidth (20);
+  b->SetFrequency (5200);
+  NS_TEST_ASSERT_MSG_EQ_TOL (channel->GetOverlapFactorDb (a, b), adjacent, 1e-12,
+                             "The overlap factor of a known configuration pair is unchanged");
+
+  channel->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Expiry of the cached link loss with FadingCoherenceTime, without
+ * LinkRefreshTolerance: the loss is computed again on every course change
+ */
+class YansWifiLinkCacheExpiryTestCase : public TestCase
+{
+public:
+  YansWifiLinkCacheExpiryTestCase ();
+  virtual ~YansWifiLinkCacheExpiryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send a packet from the sender and record the link cache hits.
+   */
+  void Send (void);
+
+  Ptr<YansWifiChannel> m_channel;     //!< the channel
+  Ptr<YansWifiPhy> m_sender;          //!< the sender
+  std::vector<uint64_t> m_hits;       //!< link cache hits after each transmission
+};
+
+YansWifiLinkCacheExpiryTestCase::YansWifiLinkCacheExpiryTestCase ()
+  : TestCase ("Without tolerance, the cached link loss expires with the coherence time and on course changes")
+{
+}
+
+YansWifiLinkCacheExpiryTestCase::~YansWifiLinkCacheExpiryTestCase ()
+{
+}
+
+void
+YansWifiLinkCacheExpiryTestCase::Send (void)
+{
+  SendPacket (m_sender, 100);
+  m_hits.push_back (m_channel->GetFanOutStatistics ().linkHits);
+}
+
+void
+YansWifiLinkCacheExpiryTestCase::DoRun (void)
+{
+  m_channel = CreateObject<YansWifiChannel> ();
+  m_channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  m_channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  m_channel->SetAttribute ("FadingCoherenceTime", TimeValue (MilliSeconds (10)));
+  m_sender = CreatePhy (m_channel, Vector (0, 0, 0), 5180, 20);
+  //on a channel far enough not to synchronize, so that the signal is energy only
+  Ptr<YansWifiPhy> receiver = CreatePhy (m_channel, Vector (10, 0, 0), 5260, 20);
+  Ptr<ConstantPositionMobilityModel> mobility = receiver->GetMobility ()->GetObject<ConstantPositionMobilityModel> ();
+
+  Simulator::Schedule (MilliSeconds (1000), &YansWifiLinkCacheExpiryTestCase::Send, this);
+  Simulator::Schedule (MilliSeconds (1005), &YansWifiLinkCacheExpiryTestCase::Send, this);
+  Simulator::Schedule (MilliSeconds (1020), &YansWifiLinkCacheExpiryTestCase::Send, this);
+  Simulator::Schedule (MilliSeconds (1021), &ConstantPositionMobilityModel::SetPosition, mobility, Vector (20, 0, 0));
+  Simulator::Schedule (MilliSeconds (1022), &YansWifiLinkCacheExpiryTestCase::Send, this);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_hits.size (), 4, "Four transmissions");
+  NS_TEST_ASSERT_MSG_EQ (m_channel->GetFanOutStatistics ().linkLookups, 4, "One link looked up per transmission");
+  NS_TEST_ASSERT_MSG_EQ (m_hits[0], 0, "The first transmission computes the loss");
+  NS_TEST_ASSERT_MSG_EQ (m_hits[1], 1, "The loss is reused within the coherence time");
+  NS_TEST_ASSERT_MSG_EQ (m_hits[2], 1, "The loss is computed again after the coherence time");
+  NS_TEST_ASSERT_MSG_EQ (m_hits[3], 1, "The loss is computed again after a course change");
+
+  m_channel->Dispose ();
+  m_channel = 0;
+  m_sender = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Reuse of the cached link loss of a moving PHY with LinkRefreshTolerance
+ */
+class YansWifiLinkRefreshToleranceTestCase : public TestCase
+{
+public:
+  YansWifiLinkRefreshToleranceTestCase ();
+  virtual ~YansWifiLinkRefreshToleranceTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send a packet from the sender and record the link cache hits.
+   */
+  void Send (void);
+
+  Ptr<YansWifiChannel> m_channel;     //!< the channel
+  Ptr<YansWifiPhy> m_sender;          //!< the sender
+  std::vector<uint64_t> m_hits;       //!< link cache hits after each transmission
+};
+
+YansWifiLinkRefreshToleranceTestCase::YansWifiLinkRefreshToleranceTestCase ()
+  : TestCase ("With tolerance, the cached link loss is reused across course changes while the distance bound holds")
+{
+}
+
+YansWifiLinkRefreshToleranceTestCase::~YansWifiLinkRefreshToleranceTestCase ()
+{
+}
+
+void
+YansWifiLinkRefreshToleranceTestCase::Send (void)
+{
+  SendPacket (m_sender, 100);
+  m_hits.push_back (m_channel->GetFanOutStatistics ().linkHits);
+}
+
+void
+YansWifiLinkRefreshToleranceTestCase::DoRun (void)
+{
+  m_channel = CreateObject<YansWifiChannel> ();
+  m_channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  m_channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  //1 dB with the exponent 3: the distance of 100 m can shrink by 7.4 m, without FadingCoherenceTime
+  m_channel->SetAttribute ("LinkRefreshTolerance", DoubleValue (1.0));
+  m_channel->SetAttribute ("LinkRefreshMaxAge", TimeValue (MilliSeconds (50)));
+  m_sender = CreatePhy (m_channel, Vector (0, 0, 0), 5180, 20);
+  Ptr<YansWifiPhy> receiver = CreatePhy (m_channel, Vector (100, 0, 0), 5260, 20);
+  Ptr<ConstantPositionMobilityModel> mobility = receiver->GetMobility ()->GetObject<ConstantPositionMobilityModel> ();
+
+  Simulator::Schedule (MilliSeconds (1000), &YansWifiLinkRefreshToleranceTestCase::Send, this);
+  Simulator::Schedule (MilliSeconds (1001), &ConstantPositionMobilityModel::SetPosition, mobility, Vector (101, 0, 0));
+  Simulator::Schedule (MilliSeconds (1002), &YansWifiLinkRefreshToleranceTestCase::Send, this);
+  Simulator::Schedule (MilliSeconds (1003), &ConstantPositionMobilityModel::SetPosition, mobility, Vector (102, 0, 0));
+  Simulator::Schedule (MilliSeconds (1004), &YansWifiLinkRefreshToleranceTestCase::Send, this);
+  Simulator::Schedule (MilliSeconds (1005), &ConstantPositionMobilityModel::SetPosition, mobility, Vector (110, 0, 0));
+  Simulator::Schedule (MilliSeconds (1006), &YansWifiLinkRefreshToleranceTestCase::Send, this);
+  Simulator::Schedule (MilliSeconds (1007), &YansWifiLinkRefreshToleranceTestCase::Send, this);
+  Simulator::Schedule (MilliSeconds (1060), &YansWifiLinkRefreshToleranceTestCase::Send, this);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_hits.size (), 6, "Six transmissions");
+  NS_TEST_ASSERT_MSG_EQ (m_channel->GetFanOutStatistics ().linkLookups, 6,
+                         "The links are cached without FadingCoherenceTime");
+  NS_TEST_ASSERT_MSG_EQ (m_hits[0], 0, "The first transmission computes the loss");
+  NS_TEST_ASSERT_MSG_EQ (m_hits[1], 1, "The loss is reused after a course change within the tolerance");
+  NS_TEST_ASSERT_MSG_EQ (m_hits[2], 2, "The loss is reused while the distance traveled stays within the tolerance");
+  NS_TEST_ASSERT_MSG_EQ (m_hits[3], 2, "The loss is computed again once the distance traveled exceeds the tolerance");
+  NS_TEST_ASSERT_MSG_EQ (m_hits[4], 3, "The loss computed at the new position is reused");
+  NS_TEST_ASSERT_MSG_EQ (m_hits[5], 3, "The loss is computed again after LinkRefreshMaxAge");
+
+  m_channel->Dispose ();
+  m_channel = 0;
+  m_sender = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Delivery of the signals sent to a sleeping PHY with SkipSleepingReceivers
+ */
+class YansWifiSleepRedeliveryTestCase : public TestCase
+{
+public:
+  YansWifiSleepRedeliveryTestCase ();
+  virtual ~YansWifiSleepRedeliveryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send a packet to a PHY that sleeps until the given time.
+   *
+   * \param wakeup the time at which the receiver resumes from sleep
+   */
+  void RunScenario (Time wakeup);
+  /**
+   * Record the sleep drops of the receiver.
+   */
+  void SampleSleepDrops (void);
+  /**
+   * Count a packet received successfully.
+   *
+   * \param packet the packet
+   */
+  void RxEnd (Ptr<const Packet> packet);
+
+  Ptr<YansWifiPhy> m_receiver;        //!< the receiver
+  uint64_t m_sleepDropsBeforeArrival; //!< sleep drops of the receiver before the first bit arrived
+  uint32_t m_rxEnd;                   //!< packets received successfully
+};
+
+YansWifiSleepRedeliveryTestCase::YansWifiSleepRedeliveryTestCase ()
+  : TestCase ("A signal sent to a sleeping PHY is delivered if it wakes up before the first bit arrives")
+{
+}
+
+YansWifiSleepRedeliveryTestCase::~YansWifiSleepRedeliveryTestCase ()
+{
+}
+
+void
+YansWifiSleepRedeliveryTestCase::SampleSleepDrops (void)
+{
+  m_sleepDropsBeforeArrival = m_receiver->GetDropStatistics ().count[YansWifiPhy::DROP_SLEEP];
+}
+
+void
+YansWifiSleepRedeliveryTestCase::RxEnd (Ptr<const Packet> packet)
+{
+  m_rxEnd++;
+}
+
+void
+YansWifiSleepRedeliveryTestCase::RunScenario (Time wakeup)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("SkipSleepingReceivers", BooleanValue (true));
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  //10 ms of propagation delay over 10 m, to wake up while the signal propagates
+  Ptr<ConstantSpeedPropagationDelayModel> delay = CreateObject<ConstantSpeedPropagationDelayModel> ();
+  delay->SetAttribute ("Speed", DoubleValue (1000));
+  channel->SetPropagationDelayModel (delay);
+  Ptr<YansWifiPhy> sender = CreatePhy (channel, Vector (0, 0, 0), 5180, 20);
+  m_receiver = CreatePhy (channel, Vector (10, 0, 0), 5180, 20);
+  m_receiver->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&YansWifiSleepRedeliveryTestCase::RxEnd, this));
+  m_sleepDropsBeforeArrival = 0;
+  m_rxEnd = 0;
+
+  Simulator::Schedule (MilliSeconds (999), &YansWifiPhy::SetSleepMode, m_receiver);
+  Simulator::Schedule (MilliSeconds (1000), &SendPacket, sender, 100);
+  Simulator::Schedule (MilliSeconds (1009), &YansWifiSleepRedeliveryTestCase::SampleSleepDrops, this);
+  Simulator::Schedule (wakeup, &YansWifiPhy::ResumeFromSleep, m_receiver);
+  Simulator::Stop (MilliSeconds (1100));
+  Simulator::Run ();
+  channel->Dispose ();
+}
+
+void
+YansWifiSleepRedeliveryTestCase::DoRun (void)
+{
+  //the receiver wakes up while the signal propagates: the payload is
+  //lost if the PLCP success flag is reset when the first bit arrives
+  RunScenario (MilliSeconds (1005));
+  NS_TEST_ASSERT_MSG_EQ (m_rxEnd, 1, "The signal is delivered after the wakeup and received");
+  NS_TEST_ASSERT_MSG_EQ (m_receiver->GetDropStatistics ().count[YansWifiPhy::DROP_SLEEP], 0,
+                         "A delivered signal is not counted as a sleep drop");
+  m_receiver = 0;
+  Simulator::Destroy ();
+
+  //the receiver sleeps through the whole signal
+  RunScenario (MilliSeconds (1020));
+  NS_TEST_ASSERT_MSG_EQ (m_rxEnd, 0, "The signal is not received while sleeping");
+  NS_TEST_ASSERT_MSG_EQ (m_sleepDropsBeforeArrival, 0, "The drop is not counted before the first bit arrives");
+  NS_TEST_ASSERT_MSG_EQ (m_receiver->GetDropStatistics ().count[YansWifiPhy::DROP_SLEEP], 1,
+                         "The signal is counted as a sleep drop once it arrived");
+  m_receiver = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Energy-only delivery to a PHY that cannot synchronize on the signal
+ */
+class YansWifiEnergyOnlyDeliveryTestCase : public TestCase
+{
+public:
+  YansWifiEnergyOnlyDeliveryTestCase ();
+  virtual ~YansWifiEnergyOnlyDeliveryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send a packet to a PHY on the adjacent channel.
+   *
+   * \param energyOnly the value of the EnergyOnlyDelivery attribute
+   */
+  void RunScenario (bool energyOnly);
+  /**
+   * Record whether the receiver is CCA busy.
+   */
+  void SampleCcaBusy (void);
+  /**
+   * Count a packet dropped with the PhyRxDrop trace.
+   *
+   * \param packet the packet
+   */
+  void RxDrop (Ptr<const Packet> packet);
+
+  Ptr<YansWifiPhy> m_receiver;        //!< the receiver
+  bool m_ccaBusy;                     //!< whether the receiver was CCA busy during the signal
+  uint32_t m_rxDrop;                  //!< PhyRxDrop traces fired
+};
+
+YansWifiEnergyOnlyDeliveryTestCase::YansWifiEnergyOnlyDeliveryTestCase ()
+  : TestCase ("An energy-only signal has the same effect as a packet the PHY cannot sync on, without PhyRxDrop")
+{
+}
+
+YansWifiEnergyOnlyDeliveryTestCase::~YansWifiEnergyOnlyDeliveryTestCase ()
+{
+}
+
+void
+YansWifiEnergyOnlyDeliveryTestCase::SampleCcaBusy (void)
+{
+  m_ccaBusy = m_receiver->IsStateCcaBusy ();
+}
+
+void
+YansWifiEnergyOnlyDeliveryTestCase::RxDrop (Ptr<const Packet> packet)
+{
+  m_rxDrop++;
+}
+
+void
+YansWifiEnergyOnlyDeliveryTestCase::RunScenario (bool energyOnly)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("EnergyOnlyDelivery", BooleanValue (energyOnly));
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<YansWifiPhy> sender = CreatePhy (channel, Vector (0, 0, 0), 5180, 20);
+  m_receiver = CreatePhy (channel, Vector (1, 0, 0), 5200, 20);
+  //low enough for the attenuated signal of the adjacent channel
+  m_receiver->SetCcaMode1Threshold (-100.0);
+  m_receiver->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&YansWifiEnergyOnlyDeliveryTestCase::RxDrop, this));
+  m_ccaBusy = false;
+  m_rxDrop = 0;
+
+  Simulator::Schedule (MilliSeconds (1000), &SendPacket, sender, 100);
+  Simulator::Schedule (MilliSeconds (1000) + MicroSeconds (50), &YansWifiEnergyOnlyDeliveryTestCase::SampleCcaBusy, this);
+  Simulator::Stop (MilliSeconds (1100));
+  Simulator::Run ();
+  channel->Dispose ();
+}
+
+void
+YansWifiEnergyOnlyDeliveryTestCase::DoRun (void)
+{
+  RunScenario (false);
+  NS_TEST_ASSERT_MSG_EQ (m_ccaBusy, true, "The packet of the adjacent channel makes the receiver CCA busy");
+  NS_TEST_ASSERT_MSG_EQ (m_rxDrop, 1, "The packet of the adjacent channel is dropped with PhyRxDrop");
+  NS_TEST_ASSERT_MSG_EQ (m_receiver->GetDropStatistics ().count[YansWifiPhy::DROP_PRIMARY_NOT_OVERLAPPING], 1,
+                         "The drop is counted");
+  m_receiver = 0;
+  Simulator::Destroy ();
+
+  RunScenario (true);
+  NS_TEST_ASSERT_MSG_EQ (m_ccaBusy, true, "The energy of the adjacent channel makes the receiver CCA busy");
+  NS_TEST_ASSERT_MSG_EQ (m_rxDrop, 0, "No packet is dropped with PhyRxDrop");
+  NS_TEST_ASSERT_MSG_EQ (m_receiver->GetDropStatistics ().count[YansWifiPhy::DROP_PRIMARY_NOT_OVERLAPPING], 1,
+                         "The drop is counted as without energy-only delivery");
+  m_receiver = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Counts the CCA busy notifications of a PHY
+ */
+class CcaBusyListener : public WifiPhyListener
+{
+public:
+  CcaBusyListener ()
+    : m_ccaBusyStart (0)
+  {
+  }
+  virtual ~CcaBusyListener ()
+  {
+  }
+  virtual void NotifyRxStart (Time duration)
+  {
+  }
+  virtual void NotifyRxEndOk (void)
+  {
+  }
+  virtual void NotifyRxEndError (void)
+  {
+  }
+  virtual void NotifyTxStart (Time duration, double txPowerDbm)
+  {
+  }
+  virtual void NotifyMaybeCcaBusyStart (Time duration)
+  {
+    m_ccaBusyStart++;
+  }
+  virtual void NotifySwitchingStart (Time duration)
+  {
+  }
+  virtual void NotifySleep (void)
+  {
+  }
+  virtual void NotifyWakeup (void)
+  {
+  }
+
+  uint32_t m_ccaBusyStart; //!< number of CCA busy notifications
+};
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Coalescing of the CCA busy notifications with CoalesceCcaBusy
+ */
+class YansWifiCoalesceCcaBusyTestCase : public TestCase
+{
+public:
+  YansWifiCoalesceCcaBusyTestCase ();
+  virtual ~YansWifiCoalesceCcaBusyTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send a long packet and, during it, a short one to a PHY that cannot
+   * synchronize on them.
+   *
+   * \param coalesce the value of the CoalesceCcaBusy attribute
+   *
+   * \return the number of CCA busy notifications of the receiver
+   */
+  uint32_t RunScenario (bool coalesce);
+};
+
+YansWifiCoalesceCcaBusyTestCase::YansWifiCoalesceCcaBusyTestCase ()
+  : TestCase ("The listeners only hear about a CCA busy period that ends later than the announced one")
+{
+}
+
+YansWifiCoalesceCcaBusyTestCase::~YansWifiCoalesceCcaBusyTestCase ()
+{
+}
+
+uint32_t
+YansWifiCoalesceCcaBusyTestCase::RunScenario (bool coalesce)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  Ptr<YansWifiPhy> first = CreatePhy (channel, Vector (0, 0, 0), 5180, 20);
+  Ptr<YansWifiPhy> second = CreatePhy (channel, Vector (2, 0, 0), 5220, 20);
+  Ptr<YansWifiPhy> receiver = CreatePhy (channel, Vector (1, 0, 0), 5200, 20);
+  receiver->SetAttribute ("CoalesceCcaBusy", BooleanValue (coalesce));
+  receiver->SetCcaMode1Threshold (-100.0);
+  CcaBusyListener listener;
+  receiver->RegisterListener (&listener);
+
+  Simulator::Schedule (MilliSeconds (1000), &SendPacket, first, 1000);
+  //over long before the first one
+  Simulator::Schedule (MilliSeconds (1000) + MicroSeconds (50), &SendPacket, second, 10);
+  Simulator::Stop (MilliSeconds (1100));
+  Simulator::Run ();
+  channel->Dispose ();
+  Simulator::Destroy ();
+  return listener.m_ccaBusyStart;
+}
+
+void
+YansWifiCoalesceCcaBusyTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (RunScenario (false), 2, "One notification per signal without coalescing");
+  NS_TEST_ASSERT_MSG_EQ (RunScenario (true), 1, "The signal within the announced busy period is not notified");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Event order of YansWifiBucketScheduler compared with MapScheduler
+ */
+class YansWifiBucketSchedulerOrderTestCase : public TestCase
+{
+public:
+  YansWifiBucketSchedulerOrderTestCase ();
+  virtual ~YansWifiBucketSchedulerOrderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+YansWifiBucketSchedulerOrderTestCase::YansWifiBucketSchedulerOrderTestCase ()
+  : TestCase ("The bucket scheduler removes the events in the same order as the map scheduler")
+{
+}
+
+YansWifiBucketSchedulerOrderTestCase::~YansWifiBucketSchedulerOrderTestCase ()
+{
+}
+
+void
+YansWifiBucketSchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> reference = CreateObject<MapScheduler> ();
+  Ptr<Scheduler> bucket = CreateObject<YansWifiBucketScheduler> ();
+  Scheduler::Event ev;
+  ev.impl = 0;
+  ev.key.m_context = 0;
+  uint64_t state = 1;
+  uint32_t uid = 0;
+  uint64_t now = 0;
+  for (uint32_t round = 0; round < 2000; round++)
+    {
+      //a burst of arrivals a few ns apart, some at the same time, and one far event
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      uint32_t burst = 1 + (state >> 58);
+      for (uint32_t k = 0; k < burst; k++)
+        {
+          state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+          ev.key.m_ts = now + 1000 + (state >> 61);
+          ev.key.m_uid = uid++;
+          reference->Insert (ev);
+          bucket->Insert (ev);
+        }
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      ev.key.m_ts = now + (state >> 40);
+      ev.key.m_uid = uid++;
+      reference->Insert (ev);
+      bucket->Insert (ev);
+      if (round % 7 == 0)
+        {
+          //cancel the far event
+          reference->Remove (ev);
+          bucket->Remove (ev);
+        }
+      for (uint32_t k = 0; k < 1 + burst / 2 && !reference->IsEmpty (); k++)
+        {
+          Scheduler::Event r = reference->RemoveNext ();
+          Scheduler::Event b = bucket->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (b.key.m_ts, r.key.m_ts, "Same timestamp");
+          NS_TEST_ASSERT_MSG_EQ (b.key.m_uid, r.key.m_uid, "Same uid");
+          now = r.key.m_ts;
+        }
+    }
+  while (!reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (bucket->IsEmpty (), false, "The bucket scheduler has as many events");
+      Scheduler::Event r = reference->RemoveNext ();
+      Scheduler::Event b = bucket->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (b.key.m_ts, r.key.m_ts, "Same timestamp");
+      NS_TEST_ASSERT_MSG_EQ (b.key.m_uid, r.key.m_uid, "Same uid");
+    }
+  NS_TEST_ASSERT_MSG_EQ (bucket->IsEmpty (), true, "The bucket scheduler has no event left");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Tests of the wifi channel with adjacent channel interference
+ */
+class YansWifiAciTestSuite : public TestSuite
+{
+public:
+  YansWifiAciTestSuite ();
+};
+
+YansWifiAciTestSuite::YansWifiAciTestSuite ()
+  : TestSuite ("yans-wifi-aci", UNIT)
+{
+  AddTestCase (new YansWifiOverlapFactorTestCase, TestCase::QUICK);
+  AddTestCase (new YansWifiLinkCacheExpiryTestCase, TestCase::QUICK);
+  AddTestCase (new YansWifiLinkRefreshToleranceTestCase, TestCase::QUICK);
+  AddTestCase (new YansWifiSleepRedeliveryTestCase, TestCase::QUICK);
+  AddTestCase (new YansWifiEnergyOnlyDeliveryTestCase, TestCase::QUICK);
+  AddTestCase (new YansWifiCoalesceCcaBusyTestCase, TestCase::QUICK);
+  AddTestCase (new YansWifiBucketSchedulerOrderTestCase, TestCase::QUICK);
+}
+
+static YansWifiAciTestSuite g_yansWifiAciTestSuite; ///< the test suite
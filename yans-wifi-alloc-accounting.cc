@@ -0,0 +1,270 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#include "yans-wifi-alloc-accounting.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <fstream>
+#include <cstdlib>
+#include <new>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiAllocAccounting");
+
+namespace {
+
+/**
+ * The counters, zero-initialized before any allocation can happen.
+ */
+uint64_t g_allocations[YansWifiAllocAccounting::STAGE_COUNT];
+uint64_t g_bytes[YansWifiAllocAccounting::STAGE_COUNT];
+
+/**
+ * The stage of the calling thread.
+ */
+__thread int g_stage = YansWifiAllocAccounting::OTHER;
+
+/**
+ * The state of the periodic report.
+ */
+struct ReportState
+{
+  std::ofstream file;                                        //!< the CSV file
+  Time interval;                                             //!< the reporting interval
+  uint64_t allocations[YansWifiAllocAccounting::STAGE_COUNT]; //!< allocations at the last report
+  uint64_t bytes[YansWifiAllocAccounting::STAGE_COUNT];       //!< bytes at the last report
+  bool enabled;                                              //!< whether the report is enabled
+};
+
+ReportState &
+GetReportState (void)
+{
+  static ReportState state;
+  static bool initialized = false;
+  if (!initialized)
+    {
+      for (uint32_t i = 0; i < YansWifiAllocAccounting::STAGE_COUNT; i++)
+        {
+          state.allocations[i] = 0;
+          state.bytes[i] = 0;
+        }
+      state.enabled = false;
+      initialized = true;
+    }
+  return state;
+}
+
+} //anonymous namespace
+
+YansWifiAllocAccounting::Scope::Scope (enum Stage stage)
+  : m_previous (static_cast<enum Stage> (g_stage))
+{
+  g_stage = stage;
+}
+
+YansWifiAllocAccounting::Scope::~Scope ()
+{
+  g_stage = m_previous;
+}
+
+void
+YansWifiAllocAccounting::Count (std::size_t size)
+{
+  int stage = g_stage;
+  //background writer threads allocate too
+  __sync_fetch_and_add (&g_allocations[stage], 1);
+  __sync_fetch_and_add (&g_bytes[stage], size);
+}
+
+const char *
+YansWifiAllocAccounting::GetName (enum Stage stage)
+{
+  switch (stage)
+    {
+    case OTHER:
+      return "other";
+    case OVERLAP_FACTOR:
+      return "overlap-factor";
+    case PACKET_COPY:
+      return "packet-copy";
+    case RECEIVE_EVENT:
+      return "receive-event";
+    case INTERFERENCE_EVENT:
+      return "interference-event";
+    case PHY_SCHEDULE:
+      return "phy-schedule";
+    default:
+      return "unknown";
+    }
+}
+
+uint64_t
+YansWifiAllocAccounting::GetAllocationCount (enum Stage stage)
+{
+  return g_allocations[stage];
+}
+
+uint64_t
+YansWifiAllocAccounting::GetByteCount (enum Stage stage)
+{
+  return g_bytes[stage];
+}
+
+void
+YansWifiAllocAccounting::Reset (void)
+{
+  ReportState &state = GetReportState ();
+  for (uint32_t i = 0; i < STAGE_COUNT; i++)
+    {
+      g_allocations[i] = 0;
+      g_bytes[i] = 0;
+      state.allocations[i] = 0;
+      state.bytes[i] = 0;
+    }
+}
+
+void
+YansWifiAllocAccounting::Print (std::ostream &os)
+{
+  for (uint32_t i = 0; i < STAGE_COUNT; i++)
+    {
+      os << GetName (static_cast<enum Stage> (i))
+         << " allocations=" << g_allocations[i]
+         << " bytes=" << g_bytes[i]
+         << std::endl;
+    }
+}
+
+void
+YansWifiAllocAccounting::EnableReport (std::string filename, Time interval)
+{
+  NS_LOG_FUNCTION (filename << interval);
+  NS_ABORT_MSG_IF (!interval.IsStrictlyPositive (), "The reporting interval must be positive");
+  ReportState &state = GetReportState ();
+  NS_ABORT_MSG_IF (state.enabled, "Allocation report already enabled");
+  state.file.open (filename.c_str ());
+  NS_ABORT_MSG_IF (!state.file.is_open (), "Could not open allocation report file " << filename);
+  state.file << "time,stage,allocations,bytes" << std::endl;
+  state.interval = interval;
+  for (uint32_t i = 0; i < STAGE_COUNT; i++)
+    {
+      state.allocations[i] = g_allocations[i];
+      state.bytes[i] = g_bytes[i];
+    }
+  state.enabled = true;
+  Simulator::Schedule (interval, &YansWifiAllocAccounting::Report);
+  Simulator::ScheduleDestroy (&YansWifiAllocAccounting::WriteTotals);
+}
+
+void
+YansWifiAllocAccounting::Report (void)
+{
+  ReportState &state = GetReportState ();
+  if (!state.enabled)
+    {
+      return;
+    }
+  double now = Simulator::Now ().GetSeconds ();
+  for (uint32_t i = 0; i < STAGE_COUNT; i++)
+    {
+      uint64_t allocations = g_allocations[i];
+      uint64_t bytes = g_bytes[i];
+      state.file << now << "," << GetName (static_cast<enum Stage> (i))
+                 << "," << allocations - state.allocations[i]
+                 << "," << bytes - state.bytes[i] << "\n";
+      state.allocations[i] = allocations;
+      state.bytes[i] = bytes;
+    }
+  Simulator::Schedule (state.interval, &YansWifiAllocAccounting::Report);
+}
+
+void
+YansWifiAllocAccounting::WriteTotals (void)
+{
+  ReportState &state = GetReportState ();
+  if (!state.enabled)
+    {
+      return;
+    }
+  state.enabled = false;
+  for (uint32_t i = 0; i < STAGE_COUNT; i++)
+    {
+      state.file << "total," << GetName (static_cast<enum Stage> (i))
+                 << "," << g_allocations[i]
+                 << "," << g_bytes[i] << "\n";
+      NS_LOG_INFO (GetName (static_cast<enum Stage> (i)) << ": " << g_allocations[i] <<
+                   " allocations, " << g_bytes[i] << " bytes");
+    }
+  state.file.close ();
+}
+
+} //namespace ns3
+
+#ifdef YANS_WIFI_ALLOC_ACCOUNTING
+
+#if __cplusplus >= 201103L
+#define YANS_WIFI_THROW_BAD_ALLOC
+#define YANS_WIFI_THROW_NOTHING noexcept
+#else
+#define YANS_WIFI_THROW_BAD_ALLOC throw (std::bad_alloc)
+#define YANS_WIFI_THROW_NOTHING throw ()
+#endif
+
+void *
+operator new (std::size_t size) YANS_WIFI_THROW_BAD_ALLOC
+{
+  ns3::YansWifiAllocAccounting::Count (size);
+  void *p = std::malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void *
+operator new[] (std::size_t size) YANS_WIFI_THROW_BAD_ALLOC
+{
+  return operator new (size);
+}
+
+void
+operator delete (void *p) YANS_WIFI_THROW_NOTHING
+{
+  std::free (p);
+}
+
+void
+operator delete[] (void *p) YANS_WIFI_THROW_NOTHING
+{
+  std::free (p);
+}
+
+#endif /* YANS_WIFI_ALLOC_ACCOUNTING */
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#ifndef YANS_WIFI_ALLOC_ACCOUNTING_H
+#define YANS_WIFI_ALLOC_ACCOUNTING_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <ostream>
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \brief Heap allocation counters for the stages of the channel and PHY reception path
+ * \ingroup wifi
+ *
+ * Every call to the global operator new is counted, with its size, and
+ * attributed to the stage of the innermost enclosing Scope of the calling
+ * thread, or to OTHER. The counters can be read at any time (e.g., by a
+ * benchmark asserting an allocation budget), written to a CSV file for
+ * every interval of simulated time, and are summed up when
+ * Simulator::Destroy is called.
+ *
+ * The accounting is only compiled in when the wifi module is built with
+ * YANS_WIFI_ALLOC_ACCOUNTING defined, e.g.,
+ * CXXFLAGS="-DYANS_WIFI_ALLOC_ACCOUNTING" ./waf configure. It then
+ * replaces the global operator new and delete of the program. Otherwise
+ * YANS_WIFI_ALLOC_STAGE expands to nothing and all the counters stay at zero.
+ */
+class YansWifiAllocAccounting
+{
+public:
+  /**
+   * The stages allocations are attributed to.
+   */
+  enum Stage
+  {
+    OTHER = 0,            //!< allocations outside of any stage
+    OVERLAP_FACTOR,       //!< overlap factor computation in YansWifiChannel
+    PACKET_COPY,          //!< packet copies for the receivers
+    RECEIVE_EVENT,        //!< events scheduled by YansWifiChannel::Send
+    INTERFERENCE_EVENT,   //!< InterferenceHelper events added by YansWifiPhy
+    PHY_SCHEDULE,         //!< events scheduled by YansWifiPhy on reception
+    STAGE_COUNT           //!< number of stages
+  };
+
+  /**
+   * Attribute the allocations of the enclosing C++ scope to a stage.
+   */
+  class Scope
+  {
+  public:
+    /**
+     * \param stage the stage the scope belongs to
+     */
+    Scope (enum Stage stage);
+    ~Scope ();
+  private:
+    enum Stage m_previous;  //!< the stage of the enclosing scope
+  };
+
+  /**
+   * \param stage the stage
+   * \return the name of the stage
+   */
+  static const char * GetName (enum Stage stage);
+  /**
+   * \param stage the stage
+   * \return the number of allocations attributed to the stage
+   */
+  static uint64_t GetAllocationCount (enum Stage stage);
+  /**
+   * \param stage the stage
+   * \return the number of bytes allocated in the stage
+   */
+  static uint64_t GetByteCount (enum Stage stage);
+  /**
+   * Reset all counters to zero.
+   */
+  static void Reset (void);
+  /**
+   * Print the allocation and byte counts of all stages.
+   *
+   * \param os the output stream
+   */
+  static void Print (std::ostream &os);
+
+  /**
+   * Write the allocations and bytes of every stage to a CSV file for each
+   * interval of simulated time, and the totals when Simulator::Destroy is
+   * called. As the report is scheduled periodically, the simulation has
+   * to be ended with Simulator::Stop.
+   *
+   * \param filename the name of the CSV file
+   * \param interval the reporting interval
+   */
+  static void EnableReport (std::string filename, Time interval = Seconds (1));
+
+  /**
+   * Account one allocation to the stage of the calling thread. Called
+   * by the replacement operator new.
+   *
+   * \param size the size of the allocation
+   */
+  static void Count (std::size_t size);
+
+private:
+  /**
+   * Write the counters accumulated since the last report and schedule
+   * the next one.
+   */
+  static void Report (void);
+  /**
+   * Write the totals and close the report file.
+   */
+  static void WriteTotals (void);
+};
+
+} //namespace ns3
+
+#ifdef YANS_WIFI_ALLOC_ACCOUNTING
+#define YANS_WIFI_ALLOC_STAGE(stage) \
+  ns3::YansWifiAllocAccounting::Scope yansWifiAllocScope (ns3::YansWifiAllocAccounting::stage)
+#else
+#define YANS_WIFI_ALLOC_STAGE(stage)
+#endif
+
+#endif /* YANS_WIFI_ALLOC_ACCOUNTING_H */
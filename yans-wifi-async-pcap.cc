@@ -0,0 +1,414 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#include "yans-wifi-async-pcap.h"
+#include "ampdu-subframe-header.h"
+#include "ns3/radiotap-header.h"
+#include "ns3/trace-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiAsyncPcapSink");
+
+NS_OBJECT_ENSURE_REGISTERED (YansWifiAsyncPcapSink);
+
+TypeId
+YansWifiAsyncPcapSink::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::YansWifiAsyncPcapSink")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<YansWifiAsyncPcapSink> ()
+    .AddAttribute ("Capacity",
+                   "The number of frames the ring buffer between the simulation and the writer thread can hold.",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&YansWifiAsyncPcapSink::m_capacity),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("DropWhenFull",
+                   "If true, frames are dropped (and counted) when the ring buffer is full. "
+                   "Otherwise the simulation waits for the writer thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiAsyncPcapSink::m_dropWhenFull),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SnapLength",
+                   "The pcap snapshot length.",
+                   UintegerValue (std::numeric_limits<uint32_t>::max ()),
+                   MakeUintegerAccessor (&YansWifiAsyncPcapSink::m_snapLen),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+YansWifiAsyncPcapSink::YansWifiAsyncPcapSink ()
+  : m_dataLinkType (PcapHelper::DLT_IEEE802_11_RADIO),
+    m_head (0),
+    m_tail (0),
+    m_stopping (false),
+    m_drops (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+YansWifiAsyncPcapSink::~YansWifiAsyncPcapSink ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+YansWifiAsyncPcapSink::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+YansWifiAsyncPcapSink::Open (std::string filename, uint32_t dataLinkType)
+{
+  NS_LOG_FUNCTION (this << filename << dataLinkType);
+  NS_ABORT_MSG_IF (m_thread != 0, "Pcap sink already open");
+  NS_ABORT_MSG_IF (dataLinkType != PcapHelper::DLT_IEEE802_11 && dataLinkType != PcapHelper::DLT_IEEE802_11_RADIO,
+                   "Unsupported data link type " << dataLinkType);
+  m_file.Open (filename, std::ios::out | std::ios::binary);
+  NS_ABORT_MSG_IF (m_file.Fail (), "Could not open pcap file " << filename);
+  m_file.Init (dataLinkType, m_snapLen, 0);
+  m_dataLinkType = dataLinkType;
+  m_ring.resize (m_capacity);
+  m_head = 0;
+  m_tail = 0;
+  m_stopping = false;
+  m_thread = Create<SystemThread> (MakeCallback (&YansWifiAsyncPcapSink::WriterLoop, this));
+  m_thread->Start ();
+}
+
+void
+YansWifiAsyncPcapSink::Close (void)
+{
+  if (m_thread == 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  __sync_synchronize ();
+  m_stopping = true;
+  m_dataReady.SetCondition (true);
+  m_dataReady.Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+  m_file.Close ();
+  if (m_drops > 0)
+    {
+      NS_LOG_WARN ("dropped " << m_drops << " frames because the writer thread fell behind");
+    }
+}
+
+void
+YansWifiAsyncPcapSink::Install (Ptr<YansWifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  phy->TraceConnectWithoutContext ("MonitorSnifferTx", MakeCallback (&YansWifiAsyncPcapSink::SniffTx, this));
+  phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeCallback (&YansWifiAsyncPcapSink::SniffRx, this));
+}
+
+uint64_t
+YansWifiAsyncPcapSink::GetDropCount (void) const
+{
+  return m_drops;
+}
+
+void
+YansWifiAsyncPcapSink::SniffTx (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber,
+                                uint32_t rate, WifiPreamble preamble, WifiTxVector txVector, struct mpduInfo aMpdu)
+{
+  Enqueue (packet, channelFreqMhz, rate, preamble, txVector, aMpdu, 0);
+}
+
+void
+YansWifiAsyncPcapSink::SniffRx (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber,
+                                uint32_t rate, WifiPreamble preamble, WifiTxVector txVector, struct mpduInfo aMpdu,
+                                struct signalNoiseDbm signalNoise)
+{
+  Enqueue (packet, channelFreqMhz, rate, preamble, txVector, aMpdu, &signalNoise);
+}
+
+void
+YansWifiAsyncPcapSink::Enqueue (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint32_t rate, WifiPreamble preamble,
+                                WifiTxVector txVector, struct mpduInfo aMpdu, const struct signalNoiseDbm *signalNoise)
+{
+  if (m_thread == 0)
+    {
+      return;
+    }
+
+  uint32_t tail = m_tail;
+  uint32_t next = (tail + 1) % m_capacity;
+  while (next == m_head)
+    {
+      if (m_dropWhenFull)
+        {
+          m_drops++;
+          return;
+        }
+      m_spaceReady.TimedWait (100000);
+      m_spaceReady.SetCondition (false);
+    }
+
+  Ptr<const Packet> p = packet;
+  if (m_dataLinkType == PcapHelper::DLT_IEEE802_11_RADIO)
+    {
+      //same frame as built by YansWifiPhyHelper::PcapSniffTxEvent and PcapSniffRxEvent
+      Ptr<Packet> frame = packet->Copy ();
+      RadiotapHeader header;
+      uint8_t frameFlags = RadiotapHeader::FRAME_FLAG_NONE;
+      header.SetTsft (Simulator::Now ().GetMicroSeconds ());
+
+      //Our capture includes the FCS, so we set the flag to say so.
+      frameFlags |= RadiotapHeader::FRAME_FLAG_FCS_INCLUDED;
+
+      if (preamble == WIFI_PREAMBLE_SHORT)
+        {
+          frameFlags |= RadiotapHeader::FRAME_FLAG_SHORT_PREAMBLE;
+        }
+
+      if (txVector.IsShortGuardInterval ())
+        {
+          frameFlags |= RadiotapHeader::FRAME_FLAG_SHORT_GUARD;
+        }
+
+      header.SetFrameFlags (frameFlags);
+      header.SetRate (rate);
+
+      uint16_t channelFlags = 0;
+      switch (rate)
+        {
+        case 2:  //1Mbps
+        case 4:  //2Mbps
+        case 10: //5Mbps
+        case 22: //11Mbps
+          channelFlags |= RadiotapHeader::CHANNEL_FLAG_CCK;
+          break;
+
+        default:
+          channelFlags |= RadiotapHeader::CHANNEL_FLAG_OFDM;
+          break;
+        }
+
+      if (channelFreqMhz < 2500)
+        {
+          channelFlags |= RadiotapHeader::CHANNEL_FLAG_SPECTRUM_2GHZ;
+        }
+      else
+        {
+          channelFlags |= RadiotapHeader::CHANNEL_FLAG_SPECTRUM_5GHZ;
+        }
+
+      header.SetChannelFrequencyAndFlags (channelFreqMhz, channelFlags);
+
+      if (signalNoise != 0)
+        {
+          header.SetAntennaSignalPower (signalNoise->signal);
+          header.SetAntennaNoisePower (signalNoise->noise);
+        }
+
+      if (preamble == WIFI_PREAMBLE_HT_MF || preamble == WIFI_PREAMBLE_HT_GF || preamble == WIFI_PREAMBLE_NONE)
+        {
+          uint8_t mcsRate = 0;
+          uint8_t mcsKnown = RadiotapHeader::MCS_KNOWN_NONE;
+          uint8_t mcsFlags = RadiotapHeader::MCS_FLAGS_NONE;
+
+          mcsKnown |= RadiotapHeader::MCS_KNOWN_INDEX;
+          mcsRate = rate - 128;
+
+          mcsKnown |= RadiotapHeader::MCS_KNOWN_BANDWIDTH;
+          if (txVector.GetChannelWidth () == 40)
+            {
+              mcsFlags |= RadiotapHeader::MCS_FLAGS_BANDWIDTH_40;
+            }
+
+          mcsKnown |= RadiotapHeader::MCS_KNOWN_GUARD_INTERVAL;
+          if (txVector.IsShortGuardInterval ())
+            {
+              mcsFlags |= RadiotapHeader::MCS_FLAGS_GUARD_INTERVAL;
+            }
+
+          mcsKnown |= RadiotapHeader::MCS_KNOWN_HT_FORMAT;
+          if (preamble == WIFI_PREAMBLE_HT_GF)
+            {
+              mcsFlags |= RadiotapHeader::MCS_FLAGS_HT_GREENFIELD;
+            }
+
+          mcsKnown |= RadiotapHeader::MCS_KNOWN_NESS;
+          if (txVector.GetNess () & 0x01) //bit 1
+            {
+              mcsFlags |= RadiotapHeader::MCS_FLAGS_NESS_BIT_0;
+            }
+          if (txVector.GetNess () & 0x02) //bit 2
+            {
+              mcsKnown |= RadiotapHeader::MCS_KNOWN_NESS_BIT_1;
+            }
+
+          mcsKnown |= RadiotapHeader::MCS_KNOWN_FEC_TYPE; //only BCC is currently supported
+
+          mcsKnown |= RadiotapHeader::MCS_KNOWN_STBC;
+          if (txVector.IsStbc ())
+            {
+              mcsFlags |= RadiotapHeader::MCS_FLAGS_STBC_STREAMS;
+            }
+
+          header.SetMcsFields (mcsKnown, mcsFlags, mcsRate);
+        }
+
+      if (txVector.IsAggregation ())
+        {
+          uint16_t ampduStatusFlags = RadiotapHeader::A_MPDU_STATUS_NONE;
+          ampduStatusFlags |= RadiotapHeader::A_MPDU_STATUS_DELIMITER_CRC_KNOWN;
+          ampduStatusFlags |= RadiotapHeader::A_MPDU_STATUS_LAST_KNOWN;
+          /* For PCAP file, MPDU Delimiter and Padding should be removed by the MAC Driver */
+          AmpduSubframeHeader hdr;
+          uint32_t extractedLength;
+          frame->RemoveHeader (hdr);
+          extractedLength = hdr.GetLength ();
+          frame = frame->CreateFragment (0, static_cast<uint32_t> (extractedLength));
+          if (aMpdu.type == LAST_MPDU_IN_AGGREGATE || (hdr.GetEof () == true && hdr.GetLength () > 0))
+            {
+              ampduStatusFlags |= RadiotapHeader::A_MPDU_STATUS_LAST;
+            }
+          header.SetAmpduStatus (aMpdu.mpduRefNumber, ampduStatusFlags, hdr.GetCrc ());
+        }
+
+      if (preamble == WIFI_PREAMBLE_VHT)
+        {
+          uint16_t vhtKnown = RadiotapHeader::VHT_KNOWN_NONE;
+          uint8_t vhtFlags = RadiotapHeader::VHT_FLAGS_NONE;
+          uint8_t vhtBandwidth = 0;
+          uint8_t vhtMcsNss[4] = {0,0,0,0};
+          uint8_t vhtCoding = 0;
+          uint8_t vhtGroupId = 0;
+          uint16_t vhtPartialAid = 0;
+
+          vhtKnown |= RadiotapHeader::VHT_KNOWN_STBC;
+          if (txVector.IsStbc ())
+            {
+              vhtFlags |= RadiotapHeader::VHT_FLAGS_STBC;
+            }
+
+          vhtKnown |= RadiotapHeader::VHT_KNOWN_GUARD_INTERVAL;
+          if (txVector.IsShortGuardInterval ())
+            {
+              vhtFlags |= RadiotapHeader::VHT_FLAGS_GUARD_INTERVAL;
+            }
+
+          vhtKnown |= RadiotapHeader::VHT_KNOWN_BEAMFORMED; //Beamforming is currently not supported
+
+          vhtKnown |= RadiotapHeader::VHT_KNOWN_BANDWIDTH;
+          //not all bandwidth values are currently supported
+          if (txVector.GetChannelWidth () == 40)
+            {
+              vhtBandwidth = 1;
+            }
+          else if (txVector.GetChannelWidth () == 80)
+            {
+              vhtBandwidth = 4;
+            }
+          else if (txVector.GetChannelWidth () == 160)
+            {
+              vhtBandwidth = 11;
+            }
+
+          //only SU PPDUs are currently supported
+          vhtMcsNss[0] |= (txVector.GetNss () & 0x0f);
+          vhtMcsNss[0] |= (((rate - 128) << 4) & 0xf0);
+
+          header.SetVhtFields (vhtKnown, vhtFlags, vhtBandwidth, vhtMcsNss, vhtCoding, vhtGroupId, vhtPartialAid);
+        }
+
+      frame->AddHeader (header);
+      p = frame;
+    }
+
+  Slot &slot = m_ring[tail];
+  uint64_t now = Simulator::Now ().GetMicroSeconds ();
+  slot.tsSec = static_cast<uint32_t> (now / 1000000);
+  slot.tsUsec = static_cast<uint32_t> (now % 1000000);
+  slot.data.resize (p->GetSize ());
+  if (!slot.data.empty ())
+    {
+      p->CopyData (&slot.data[0], slot.data.size ());
+    }
+
+  //publish the slot to the writer thread
+  __sync_synchronize ();
+  bool wasEmpty = (m_head == tail);
+  m_tail = next;
+  if (wasEmpty)
+    {
+      m_dataReady.SetCondition (true);
+      m_dataReady.Signal ();
+    }
+}
+
+void
+YansWifiAsyncPcapSink::WriterLoop (void)
+{
+  while (true)
+    {
+      uint32_t head = m_head;
+      if (head == m_tail)
+        {
+          if (m_stopping)
+            {
+              __sync_synchronize ();
+              if (m_head == m_tail)
+                {
+                  break;
+                }
+              continue;
+            }
+          //the producer may miss the empty ring by a few instructions: do not wait forever
+          m_dataReady.TimedWait (1000000);
+          m_dataReady.SetCondition (false);
+          continue;
+        }
+      __sync_synchronize ();
+      const Slot &slot = m_ring[head];
+      m_file.Write (slot.tsSec, slot.tsUsec, slot.data.empty () ? 0 : &slot.data[0], slot.data.size ());
+      __sync_synchronize ();
+      m_head = (head + 1) % m_capacity;
+      m_spaceReady.SetCondition (true);
+      m_spaceReady.Signal ();
+    }
+}
+
+} //namespace ns3
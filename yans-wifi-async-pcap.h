@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#ifndef YANS_WIFI_ASYNC_PCAP_H
+#define YANS_WIFI_ASYNC_PCAP_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include "ns3/pcap-file.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-condition.h"
+#include "yans-wifi-phy.h"
+
+namespace ns3 {
+
+/**
+ * \brief Asynchronous pcap writer for the monitor sniffer traces of YansWifiPhy
+ * \ingroup wifi
+ *
+ * The sink is connected to the MonitorSnifferTx and MonitorSnifferRx trace
+ * sources of one or more PHYs. On the simulation thread, it only builds
+ * the frame exactly as YansWifiPhyHelper does for its pcap traces
+ * (including the radiotap header for DLT_IEEE802_11_RADIO) and copies the
+ * bytes into a single-producer single-consumer ring buffer. A background
+ * thread takes the frames out of the ring and writes them to the pcap
+ * file, so that the files are identical to the ones written synchronously
+ * by the helper.
+ *
+ * When the ring is full, the simulation thread waits for the writer
+ * (back-pressure), or drops the frame and counts it if DropWhenFull is set.
+ */
+class YansWifiAsyncPcapSink : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  YansWifiAsyncPcapSink ();
+  virtual ~YansWifiAsyncPcapSink ();
+
+  /**
+   * Create the pcap file and start the background writer thread.
+   *
+   * \param filename the name of the pcap file
+   * \param dataLinkType PcapHelper::DLT_IEEE802_11 or PcapHelper::DLT_IEEE802_11_RADIO
+   */
+  void Open (std::string filename, uint32_t dataLinkType);
+  /**
+   * Write the pending frames, stop the background writer thread and close
+   * the file. This is done automatically when the object is disposed.
+   */
+  void Close (void);
+
+  /**
+   * Write the frames sent and received by the given PHY.
+   *
+   * \param phy the YansWifiPhy to sniff
+   */
+  void Install (Ptr<YansWifiPhy> phy);
+
+  /**
+   * \return the number of frames dropped because the ring buffer was full
+   */
+  uint64_t GetDropCount (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * A frame waiting in the ring buffer.
+   */
+  struct Slot
+  {
+    uint32_t tsSec;              //!< time stamp, seconds
+    uint32_t tsUsec;             //!< time stamp, microseconds
+    std::vector<uint8_t> data;   //!< frame bytes, its size is the number of valid bytes
+  };
+
+  /**
+   * Sink for MonitorSnifferTx.
+   */
+  void SniffTx (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber,
+                uint32_t rate, WifiPreamble preamble, WifiTxVector txVector, struct mpduInfo aMpdu);
+  /**
+   * Sink for MonitorSnifferRx.
+   */
+  void SniffRx (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber,
+                uint32_t rate, WifiPreamble preamble, WifiTxVector txVector, struct mpduInfo aMpdu,
+                struct signalNoiseDbm signalNoise);
+  /**
+   * Build the frame as the pcap helper does and queue it.
+   *
+   * \param signalNoise the signal and noise power, or 0 for transmitted frames
+   */
+  void Enqueue (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint32_t rate, WifiPreamble preamble,
+                WifiTxVector txVector, struct mpduInfo aMpdu, const struct signalNoiseDbm *signalNoise);
+  /**
+   * Main loop of the background writer thread.
+   */
+  void WriterLoop (void);
+
+  uint32_t m_capacity;          //!< number of slots of the ring buffer
+  bool m_dropWhenFull;          //!< whether to drop frames instead of waiting when the ring is full
+  uint32_t m_snapLen;           //!< pcap snapshot length
+  uint32_t m_dataLinkType;      //!< pcap data link type
+  PcapFile m_file;              //!< the pcap file, only used by the writer thread once open
+  std::vector<Slot> m_ring;     //!< the ring buffer
+  volatile uint32_t m_head;     //!< next slot to be written to the file, owned by the writer thread
+  volatile uint32_t m_tail;     //!< next free slot, owned by the simulation thread
+  volatile bool m_stopping;     //!< whether the writer thread has to exit once the ring is empty
+  uint64_t m_drops;             //!< number of dropped frames
+  Ptr<SystemThread> m_thread;   //!< the background writer thread
+  SystemCondition m_dataReady;  //!< set when a frame is queued in an empty ring
+  SystemCondition m_spaceReady; //!< set when a slot is released
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_ASYNC_PCAP_H */
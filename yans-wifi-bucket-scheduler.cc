@@ -0,0 +1,335 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#include "yans-wifi-bucket-scheduler.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiBucketScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (YansWifiBucketScheduler);
+
+namespace {
+
+const uint32_t CHUNK_NODES = 256;   //!< number of nodes taken from the heap at once
+const uint32_t MIN_BUCKETS = 2;     //!< minimum number of buckets
+
+/**
+ * The scheduler created last, assumed to be the one of the simulator,
+ * see YansWifiBucketScheduler::GetCurrent.
+ */
+const YansWifiBucketScheduler *g_current = 0;
+
+} //anonymous namespace
+
+TypeId
+YansWifiBucketScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::YansWifiBucketScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<YansWifiBucketScheduler> ()
+  ;
+  return tid;
+}
+
+YansWifiBucketScheduler::YansWifiBucketScheduler ()
+  : m_mask (MIN_BUCKETS - 1),
+    m_width (1024),
+    m_size (0),
+    m_removed (0),
+    m_lastBucket (0),
+    m_bucketTop (1024),
+    m_lastTs (0),
+    m_free (0)
+{
+  NS_LOG_FUNCTION (this);
+  struct Bucket empty = {0, 0};
+  m_buckets.assign (MIN_BUCKETS, empty);
+  g_current = this;
+}
+
+YansWifiBucketScheduler::~YansWifiBucketScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Node *>::const_iterator i = m_chunks.begin (); i != m_chunks.end (); i++)
+    {
+      delete [] *i;
+    }
+  if (g_current == this)
+    {
+      g_current = 0;
+    }
+}
+
+uint32_t
+YansWifiBucketScheduler::GetSize (void) const
+{
+  return m_size;
+}
+
+uint64_t
+YansWifiBucketScheduler::GetNRemoved (void) const
+{
+  return m_removed;
+}
+
+const YansWifiBucketScheduler *
+YansWifiBucketScheduler::GetCurrent (void)
+{
+  return g_current;
+}
+
+bool
+YansWifiBucketScheduler::IsEarlier (const Node *a, const Node *b)
+{
+  return a->ev.key < b->ev.key;
+}
+
+YansWifiBucketScheduler::Node *
+YansWifiBucketScheduler::AllocateNode (void)
+{
+  if (m_free == 0)
+    {
+      Node *chunk = new Node [CHUNK_NODES];
+      m_chunks.push_back (chunk);
+      for (uint32_t i = 0; i < CHUNK_NODES; i++)
+        {
+          chunk[i].next = m_free;
+          m_free = &chunk[i];
+        }
+    }
+  Node *node = m_free;
+  m_free = node->next;
+  return node;
+}
+
+void
+YansWifiBucketScheduler::ReleaseNode (Node *node)
+{
+  node->next = m_free;
+  m_free = node;
+}
+
+void
+YansWifiBucketScheduler::InsertNode (Node *node)
+{
+  struct Bucket &bucket = m_buckets[(node->ev.key.m_ts / m_width) & m_mask];
+  node->next = 0;
+  if (bucket.head == 0)
+    {
+      bucket.head = node;
+      bucket.tail = node;
+    }
+  else if (IsEarlier (bucket.tail, node))
+    {
+      //the common case: the latest event of its bucket
+      bucket.tail->next = node;
+      bucket.tail = node;
+    }
+  else if (IsEarlier (node, bucket.head))
+    {
+      node->next = bucket.head;
+      bucket.head = node;
+    }
+  else
+    {
+      Node *previous = bucket.head;
+      while (IsEarlier (previous->next, node))
+        {
+          previous = previous->next;
+        }
+      node->next = previous->next;
+      previous->next = node;
+    }
+}
+
+void
+YansWifiBucketScheduler::Insert (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  Node *node = AllocateNode ();
+  node->ev = ev;
+  InsertNode (node);
+  m_size++;
+  if (m_size > 2 * m_buckets.size ())
+    {
+      Resize (2 * m_buckets.size ());
+    }
+}
+
+bool
+YansWifiBucketScheduler::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+uint32_t
+YansWifiBucketScheduler::FindNext (void) const
+{
+  NS_ASSERT (m_size > 0);
+  //scan the buckets for an event of the current year, starting from the last one
+  uint32_t i = m_lastBucket;
+  uint64_t top = m_bucketTop;
+  for (uint32_t k = 0; k <= m_mask; k++)
+    {
+      const struct Bucket &bucket = m_buckets[i];
+      if (bucket.head != 0 && bucket.head->ev.key.m_ts < top)
+        {
+          return i;
+        }
+      i = (i + 1) & m_mask;
+      top += m_width;
+    }
+  //all the events are at least one year ahead: direct search
+  uint32_t next = m_mask + 1;
+  for (i = 0; i <= m_mask; i++)
+    {
+      const Node *head = m_buckets[i].head;
+      if (head != 0 && (next > m_mask || IsEarlier (head, m_buckets[next].head)))
+        {
+          next = i;
+        }
+    }
+  return next;
+}
+
+Scheduler::Event
+YansWifiBucketScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_buckets[FindNext ()].head->ev;
+}
+
+Scheduler::Event
+YansWifiBucketScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t i = FindNext ();
+  struct Bucket &bucket = m_buckets[i];
+  Node *node = bucket.head;
+  bucket.head = node->next;
+  if (bucket.head == 0)
+    {
+      bucket.tail = 0;
+    }
+  Scheduler::Event ev = node->ev;
+  ReleaseNode (node);
+  m_size--;
+  m_removed++;
+  m_lastBucket = i;
+  m_lastTs = ev.key.m_ts;
+  m_bucketTop = (m_lastTs / m_width + 1) * m_width;
+  if (m_size < m_buckets.size () / 2 && m_buckets.size () > MIN_BUCKETS)
+    {
+      Resize (m_buckets.size () / 2);
+    }
+  return ev;
+}
+
+void
+YansWifiBucketScheduler::Remove (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  struct Bucket &bucket = m_buckets[(ev.key.m_ts / m_width) & m_mask];
+  Node *previous = 0;
+  Node *node = bucket.head;
+  while (node != 0 && node->ev.key.m_uid != ev.key.m_uid)
+    {
+      previous = node;
+      node = node->next;
+    }
+  NS_ASSERT (node != 0);
+  if (previous == 0)
+    {
+      bucket.head = node->next;
+    }
+  else
+    {
+      previous->next = node->next;
+    }
+  if (bucket.tail == node)
+    {
+      bucket.tail = previous;
+    }
+  ReleaseNode (node);
+  m_size--;
+  if (m_size < m_buckets.size () / 2 && m_buckets.size () > MIN_BUCKETS)
+    {
+      Resize (m_buckets.size () / 2);
+    }
+}
+
+void
+YansWifiBucketScheduler::Resize (uint32_t nBuckets)
+{
+  NS_LOG_FUNCTION (this << nBuckets);
+  std::vector<Node *> nodes;
+  nodes.reserve (m_size);
+  for (std::vector<struct Bucket>::const_iterator i = m_buckets.begin (); i != m_buckets.end (); i++)
+    {
+      for (Node *node = i->head; node != 0; node = node->next)
+        {
+          nodes.push_back (node);
+        }
+    }
+  std::sort (nodes.begin (), nodes.end (), &YansWifiBucketScheduler::IsEarlier);
+
+  /*
+   * Three times the mean gap over the first nine tenths of the queue, so
+   * that a year covers them. The gaps between the earliest events alone
+   * are nanoseconds during a fan-out burst, which sent the later events
+   * many years ahead. The last tenth is left out so that a few far events
+   * (e.g., the end of the simulation) do not widen the buckets of all the
+   * others; they are found by the direct search if needed.
+   */
+  if (nodes.size () >= 2)
+    {
+      uint32_t last = std::max<uint32_t> (1, (nodes.size () - 1) * 9 / 10);
+      uint64_t span = nodes[last]->ev.key.m_ts - nodes[0]->ev.key.m_ts;
+      if (span > 0)
+        {
+          m_width = std::max<uint64_t> (1, 3 * span / last);
+        }
+    }
+
+  struct Bucket empty = {0, 0};
+  m_buckets.assign (nBuckets, empty);
+  m_mask = nBuckets - 1;
+  for (std::vector<Node *>::const_iterator i = nodes.begin (); i != nodes.end (); i++)
+    {
+      InsertNode (*i);
+    }
+  m_lastBucket = (m_lastTs / m_width) & m_mask;
+  m_bucketTop = (m_lastTs / m_width + 1) * m_width;
+}
+
+} //namespace ns3
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#ifndef YANS_WIFI_BUCKET_SCHEDULER_H
+#define YANS_WIFI_BUCKET_SCHEDULER_H
+
+#include <vector>
+#include <stdint.h>
+#include "ns3/scheduler.h"
+
+namespace ns3 {
+
+/**
+ * \brief Calendar queue scheduler for the fan-out of the wifi channel
+ * \ingroup wifi
+ *
+ * Events are hashed by timestamp into a power-of-two number of buckets,
+ * each bucket covering a fixed time width and holding its events sorted
+ * by (timestamp, uid) in a singly-linked list with a tail pointer. A
+ * transmission on YansWifiChannel schedules one event per receiver
+ * within a few microseconds, then two events per synchronized receiver
+ * at the end of the PLCP header and of the frame: these land at the tail
+ * of their bucket, so that their insertion is O(1), and the next event
+ * is usually found in the current bucket.
+ *
+ * The number of buckets follows the number of events (doubling above two
+ * events per bucket, halving below one per two buckets), and the bucket
+ * width is set at each resize from the mean gap between the events of
+ * the first nine tenths of the queue, so that a year covers them even
+ * when the earliest events are a burst of arrivals a few ns apart.
+ * List nodes are recycled through a free list. The events are removed in
+ * exactly the same order as with the other ns-3 schedulers.
+ *
+ * Select it with
+ * \code
+ *   ObjectFactory factory;
+ *   factory.SetTypeId ("ns3::YansWifiBucketScheduler");
+ *   Simulator::SetScheduler (factory);
+ * \endcode
+ * or with the SchedulerType global value, e.g., --SchedulerType=ns3::YansWifiBucketScheduler.
+ */
+class YansWifiBucketScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  YansWifiBucketScheduler ();
+  virtual ~YansWifiBucketScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+  /**
+   * \return the number of events in the queue
+   */
+  uint32_t GetSize (void) const;
+  /**
+   * \return the number of events removed with RemoveNext, i.e., run by the simulator
+   */
+  uint64_t GetNRemoved (void) const;
+  /**
+   * The simulator creates its scheduler internally and does not give
+   * access to it: this returns the YansWifiBucketScheduler created last,
+   * for progress reports. It assumes the single simulator of the process
+   * owns the only instance alive, which holds with the default simulator
+   * implementation (Simulator::SetScheduler creates the new scheduler
+   * before it destroys the old one). If other instances are created, e.g.,
+   * by a benchmark, it is the last one of them, whatever the simulator
+   * uses. Not thread-safe.
+   *
+   * \return the YansWifiBucketScheduler created last, or 0 if it was destroyed
+   */
+  static const YansWifiBucketScheduler * GetCurrent (void);
+
+private:
+  /**
+   * A list node.
+   */
+  struct Node
+  {
+    Scheduler::Event ev;  //!< the event
+    Node *next;           //!< next node of the bucket or of the free list
+  };
+  /**
+   * The events of a bucket, sorted.
+   */
+  struct Bucket
+  {
+    Node *head;           //!< earliest event
+    Node *tail;           //!< latest event
+  };
+
+  /**
+   * \param a a node
+   * \param b another node
+   *
+   * \return whether the event of a is to be run before the event of b
+   */
+  static bool IsEarlier (const Node *a, const Node *b);
+  /**
+   * \return a free node
+   */
+  Node * AllocateNode (void);
+  /**
+   * \param node the node to put back on the free list
+   */
+  void ReleaseNode (Node *node);
+  /**
+   * Insert a node in its bucket.
+   *
+   * \param node the node
+   */
+  void InsertNode (Node *node);
+  /**
+   * \return the index of the bucket holding the next event, the queue
+   *         being not empty
+   */
+  uint32_t FindNext (void) const;
+  /**
+   * Change the number of buckets and compute the bucket width again.
+   *
+   * \param nBuckets the new number of buckets, a power of two
+   */
+  void Resize (uint32_t nBuckets);
+
+  std::vector<struct Bucket> m_buckets;  //!< the buckets
+  uint32_t m_mask;                       //!< number of buckets minus one
+  uint64_t m_width;                      //!< time width of a bucket, in timestamp units
+  uint32_t m_size;                       //!< number of events
+  uint64_t m_removed;                    //!< number of events removed with RemoveNext
+  uint32_t m_lastBucket;                 //!< bucket of the last event removed
+  uint64_t m_bucketTop;                  //!< end of the time window of m_lastBucket in the current year
+  uint64_t m_lastTs;                     //!< timestamp of the last event removed
+  Node *m_free;                          //!< free list
+  std::vector<Node *> m_chunks;          //!< node chunks taken from the heap
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_BUCKET_SCHEDULER_H */
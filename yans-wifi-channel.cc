@@ -58,12 +58,26 @@
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/object-factory.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
 #include "yans-wifi-channel.h"
+#include "yans-wifi-profiler.h"
+#include "yans-wifi-event-pool.h"
+#include "yans-wifi-alloc-accounting.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/propagation-delay-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/abort.h"
 #include <cmath>
 #include <algorithm>
 #include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 
 
 namespace ns3 {
@@ -72,6 +86,60 @@ NS_LOG_COMPONENT_DEFINE ("YansWifiChannel");
 
 NS_OBJECT_ENSURE_REGISTERED (YansWifiChannel);
 
+/**
+ * Event delivering the first bit of a packet to the i-th PHY, taken from
+ * a pool instead of the heap since one is scheduled per receiver.
+ */
+class YansWifiChannel::ReceiveEvent : public YansWifiPooledEvent<YansWifiChannel::ReceiveEvent>
+{
+public:
+  ReceiveEvent (const YansWifiChannel *channel, uint32_t i, Ptr<const Packet> packet, const struct Parameters &parameters)
+    : m_channel (channel),
+      m_i (i),
+      m_packet (packet),
+      m_parameters (parameters)
+  {
+  }
+
+private:
+  virtual void Notify (void)
+  {
+    m_channel->Receive (m_i, m_packet, m_parameters);
+  }
+
+  const YansWifiChannel *m_channel;  //!< the channel
+  uint32_t m_i;                      //!< index of the receiver in the PHY list
+  Ptr<const Packet> m_packet;        //!< the packet
+  struct Parameters m_parameters;    //!< the reception parameters
+};
+
+/**
+ * Event delivering the first bit of a signal to the i-th PHY when that
+ * PHY cannot synchronize on it: only the size of the packet is kept.
+ */
+class YansWifiChannel::ReceiveEnergyEvent : public YansWifiPooledEvent<YansWifiChannel::ReceiveEnergyEvent>
+{
+public:
+  ReceiveEnergyEvent (const YansWifiChannel *channel, uint32_t i, uint32_t size, const struct Parameters &parameters)
+    : m_channel (channel),
+      m_i (i),
+      m_size (size),
+      m_parameters (parameters)
+  {
+  }
+
+private:
+  virtual void Notify (void)
+  {
+    m_channel->ReceiveEnergy (m_i, m_size, m_parameters);
+  }
+
+  const YansWifiChannel *m_channel;  //!< the channel
+  uint32_t m_i;                      //!< index of the receiver in the PHY list
+  uint32_t m_size;                   //!< the size of the packet in bytes
+  struct Parameters m_parameters;    //!< the reception parameters
+};
+
 TypeId
 YansWifiChannel::GetTypeId (void)
 {
@@ -87,18 +155,197 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("FadingCoherenceTime",
+                   "The time during which the propagation loss of a link is reused instead of "
+                   "being computed again by the loss model, so that frames exchanged in a row "
+                   "(e.g., data and ACK, A-MPDU bursts) see the same fading realization in both "
+                   "directions. A cached link is computed again once either PHY changes course "
+                   "(CourseChange trace of its mobility model). Zero disables the cache. It has no "
+                   "effect with LinkRefreshTolerance, see LinkRefreshMaxAge instead.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&YansWifiChannel::SetFadingCoherenceTime,
+                                     &YansWifiChannel::GetFadingCoherenceTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("LinkRefreshTolerance",
+                   "The largest change in dB of the loss of a link for which its cached loss and delay "
+                   "are reused. The change is bounded from the distance traveled by both PHYs since the "
+                   "link was computed, followed through the CourseChange trace of their mobility models, "
+                   "assuming a log-distance loss with LinkRefreshExponent. Meant for continuously moving "
+                   "nodes: course changes do not invalidate a link, which is only computed again once "
+                   "the bound no longer holds or LinkRefreshMaxAge has elapsed. It replaces the exact "
+                   "reuse of FadingCoherenceTime, hence the cache is also enabled without it. Zero "
+                   "disables it.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::SetLinkRefreshTolerance,
+                                       &YansWifiChannel::GetLinkRefreshTolerance),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("LinkRefreshExponent",
+                   "The path loss exponent used to bound the loss change of a link, see LinkRefreshTolerance. "
+                   "It should not be smaller than the one of the propagation loss model.",
+                   DoubleValue (3.0),
+                   MakeDoubleAccessor (&YansWifiChannel::SetLinkRefreshExponent,
+                                       &YansWifiChannel::GetLinkRefreshExponent),
+                   MakeDoubleChecker<double> (0.1))
+    .AddAttribute ("LinkRefreshMaxAge",
+                   "The time after which a link reused with LinkRefreshTolerance is computed again, "
+                   "even if the distance bound still holds, e.g., to draw a new fading realization. "
+                   "Zero leaves the distance bound alone.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&YansWifiChannel::SetLinkRefreshMaxAge,
+                                     &YansWifiChannel::GetLinkRefreshMaxAge),
+                   MakeTimeChecker ())
+    .AddAttribute ("TxMaskFile",
+                   "File with the transmit spectrum masks used by default, one \"width offset psd\" "
+                   "breakpoint per line (channel width in MHz, offset from the central frequency in MHz, "
+                   "power spectral density in dBr), in increasing offset order for each width. "
+                   "Widths not in the file, or an empty file name, use the 802.11ac mask.",
+                   StringValue (""),
+                   MakeStringAccessor (&YansWifiChannel::SetTxMaskFile,
+                                       &YansWifiChannel::GetTxMaskFile),
+                   MakeStringChecker ())
+    .AddAttribute ("RxMaskFile",
+                   "File with the receive filter responses used by default, in the same format as TxMaskFile. "
+                   "Widths not in the file, or an empty file name, use the 802.11ac mask.",
+                   StringValue (""),
+                   MakeStringAccessor (&YansWifiChannel::SetRxMaskFile,
+                                       &YansWifiChannel::GetRxMaskFile),
+                   MakeStringChecker ())
+    .AddAttribute ("SkipSleepingReceivers",
+                   "If true, no packet copy nor reception event is created for PHYs in SLEEP state "
+                   "or for PHYs that are switching channel until after the end of the signal. "
+                   "Signals still on the air when a PHY wakes up are added to its interference tracker, "
+                   "and those that have not arrived yet are delivered as usual. "
+                   "The drops are still counted, but the PhyRxDrop trace is not fired for these "
+                   "receivers, unlike in stock ns-3, hence it is off by default.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_skipSleepingReceivers),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EnergyOnlyDelivery",
+                   "If true, receivers whose primary channel does not match the one of the sender, "
+                   "or that are narrower than the sender, get the signal as energy only: no packet "
+                   "is attached to the reception event and the PHY only updates its interference "
+                   "tracker, CCA state and drop counters. As the PhyRxDrop trace is not fired for these "
+                   "receivers, unlike in stock ns-3, it is off by default: every receiver gets a copy "
+                   "of the packet. Whether a "
+                   "receiver can sync is decided when the signal is sent: a receiver that completes a "
+                   "channel switch onto the sender's primary channel while the signal propagates still "
+                   "gets the energy only. This needs a ChannelSwitchDelay shorter than the propagation "
+                   "delay, since a receiver still switching at arrival drops the signal anyway.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_energyOnlyDelivery),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LinearPowerPipeline",
+                   "If true, the rx power is also handed to the PHYs in W, computed from the tx power "
+                   "converted once per transmission, the cached link and far-field gains and the "
+                   "precomputed linear overlap factors, so that the PHYs add the rx gain and track "
+                   "the signal without converting from dBm. The rx power in dBm is still given for "
+                   "the traces. Links whose loss is computed by the loss model still need one conversion.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::SetLinearPowerPipeline,
+                                        &YansWifiChannel::GetLinearPowerPipeline),
+                   MakeBooleanChecker ())
+    .AddAttribute ("NearRadius",
+                   "Distance in m beyond which the rx power is not computed with the propagation loss model "
+                   "but read from a precomputed log-distance table binned by distance, before the overlap "
+                   "factor is applied. Meant for receivers far beyond the energy detection range, for which "
+                   "only the aggregate interference matters. Zero uses the loss model for all the receivers.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_nearRadius),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("FarFieldExponent",
+                   "The path loss exponent of the far-field log-distance model.",
+                   DoubleValue (3.0),
+                   MakeDoubleAccessor (&YansWifiChannel::SetFarFieldExponent,
+                                       &YansWifiChannel::GetFarFieldExponent),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("FarFieldReferenceLoss",
+                   "The loss in dB of the far-field log-distance model at 1 m.",
+                   DoubleValue (46.6777),
+                   MakeDoubleAccessor (&YansWifiChannel::SetFarFieldReferenceLoss,
+                                       &YansWifiChannel::GetFarFieldReferenceLoss),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("FarFieldBinWidth",
+                   "The width in m of the distance bins of the far-field table. The loss of a bin "
+                   "is the one at its center. The table covers at most 8192 bins from NearRadius; "
+                   "the loss of the bins beyond is computed on use.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&YansWifiChannel::SetFarFieldBinWidth,
+                                       &YansWifiChannel::GetFarFieldBinWidth),
+                   MakeDoubleChecker<double> (0.001))
+    .AddAttribute ("ValidateFarField",
+                   "If true, the rx power of far receivers is also computed with the propagation loss "
+                   "model and the error of the far-field table is accumulated and printed when the "
+                   "channel is disposed. The signals still use the far-field rx power, but the extra "
+                   "draws change the random streams of the loss model.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_validateFarField),
+                   MakeBooleanChecker ())
+    .AddAttribute ("OccupancyAccounting",
+                   "If true, the airtime of each channel configuration and the transmit energy put "
+                   "into each 20 MHz subchannel are accounted for every transmission, see GetAirtime, "
+                   "GetSubchannelTxEnergy and EnableOccupancyReport, which enables it.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_occupancyAccounting),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_maskSets (1),
+    m_skipSleepingReceivers (false),
+    m_energyOnlyDelivery (false),
+    m_linearPowerPipeline (false),
+    m_linkSweepSize (512),
+    m_linkRefreshTolerance (0.0),
+    m_linkRefreshExponent (3.0),
+    m_linkRefreshFactor (0.0),
+    m_nearRadius (0.0),
+    m_farFieldExponent (3.0),
+    m_farFieldReferenceLoss (46.6777),
+    m_farFieldBinWidth (1.0),
+    m_validateFarField (false),
+    m_farFieldFirstBin (0),
+    m_occupancyAccounting (false),
+    m_occupancyKnownConfigs (0)
 {
+  ResetFarFieldStatistics ();
+  std::memset (&m_fanOutStats, 0, sizeof (m_fanOutStats));
 }
 
 YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_phyList.clear ();
+  m_phyIndex.clear ();
+  m_skipped.clear ();
+  m_sensors.clear ();
+}
+
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_validateFarField && m_farFieldStats.farLinks > 0)
+    {
+      PrintFarFieldStatistics (std::clog);
+    }
+  m_occupancyStream = 0;
+  m_sensorStream = 0;
+  m_sensorLoss = 0;
+  //the mobility models may outlive the channel
+  for (uint32_t i = 0; i < m_motion.size (); i++)
+    {
+      if (m_motion[i].mobility != 0)
+        {
+          std::ostringstream context;
+          context << i;
+          m_motion[i].mobility->TraceDisconnect ("CourseChange", context.str (),
+                                                 MakeCallback (&YansWifiChannel::NotifyCourseChange, this));
+        }
+    }
+  m_motion.clear ();
+  WifiChannel::DoDispose ();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -109,7 +356,7 @@ YansWifiChannel::~YansWifiChannel ()
 
 
 // calculate area between y and x by dividing into trapezoids
-double trapz(std::vector<double> fo, std::vector<double> psdo)
+double trapz(const std::vector<double> &fo, const std::vector<double> &psdo)
 {
   double area=0.0;
   
@@ -121,385 +368,1706 @@ double trapz(std::vector<double> fo, std::vector<double> psdo)
   return area;
 }
 
-double overlapFactorToBeDecoded(uint32_t senderChannelWidth, uint32_t receiverChannelWidth, uint32_t senderChannelFrequencyMHz,  uint32_t receiverChannelFrequencyMHz)
+// overlapping factor of a transmit mask (f1, psd1) and a receive mask (f2, psd2),
+// given as absolute frequencies in MHz and linear power spectral densities
+// with any number of breakpoints in increasing frequency order
+double overlapFactor(const std::vector<double> &f1, const std::vector<double> &psd1,
+                     const std::vector<double> &f2, const std::vector<double> &psd2)
 {
+  YANS_WIFI_PROFILE_SCOPE (OVERLAP_FACTOR);
+  YANS_WIFI_ALLOC_STAGE (OVERLAP_FACTOR);
+  uint32_t n1 = f1.size ();
+  uint32_t n2 = f2.size ();
   // overlapping factor to be returned  
   double alpha=0.0;
 
-  // spectrum mask given by standard
-  double psd_db[11] = {-40, -40, -28, -20, 0, 0, 0, -20, -28, -40, -40};
-  
-  //double inf = std::numeric_limits<double>::infinity();
-
-  double f_tx_20MHz[11] = {-50, -30, -20, -11, -9, 0, 9, 11, 20, 30, 50};
-  double f_tx_40MHz[11] = {-100, -60, -40, -21, -19, 0, 19, 21, 40, 60, 100};
-  double f_tx_80MHz[11] = {-200, -120, -80, -40, -39, 0, 39, 41, 80, 120, 200};
-  double f_tx_160MHz[11] = {-400, -240, -160, -81, -79, 0, 79, 81, 160, 240, 400};
-
-  double f_rx_20MHz[11] = {-50, -30, -20, -11, -9, 0, 9, 11, 20, 30, 50};
-  double f_rx_40MHz[11] = {-100, -60, -40, -21, -19, 0, 19, 21, 40, 60, 100};
-  double f_rx_80MHz[11] = {-200, -120, -80, -40, -39, 0, 39, 41, 80, 120, 200};
-  double f_rx_160MHz[11] = {-400, -240, -160, -81, -79, 0, 79, 81, 160, 240, 400};
-
-  // spectrum mask for given transmitter and receiver
-  double f1[11];
-  double f2[11];
-  double psd1[11]; 
-  double psd2[11]; 
-
-  switch (senderChannelWidth)
-        {
-         case 20:
-                for(uint32_t i=0; i<11; i++)
-                        {
-                         f1[i]=senderChannelFrequencyMHz+f_tx_20MHz[i];
-                         psd1[i]=pow(10, psd_db[i]/10.0);
-                        }
-                break;
-         case 40:
-                for(uint32_t i=0; i<11; i++)
-                        {
-                         f1[i]=senderChannelFrequencyMHz+f_tx_40MHz[i];
-                         psd1[i]=pow(10, psd_db[i]/10.0);
-                        }
-                break;
-         case 80:
-                for(uint32_t i=0; i<11; i++)
-                        {
-                         f1[i]=senderChannelFrequencyMHz+f_tx_80MHz[i];
-                         psd1[i]=pow(10, psd_db[i]/10.0);
-                        }
-                break;
-         case 160:
-                for(uint32_t i=0; i<11; i++)
-                        {
-                         f1[i]=senderChannelFrequencyMHz+f_tx_160MHz[i];
-                         psd1[i]=pow(10, psd_db[i]/10.0);
-                        }
-                break;
-          }
-
-  switch (receiverChannelWidth)
-        {
-         case 20:
-                for(uint32_t i=0; i<11; i++)
-                        {
-                         f2[i]=receiverChannelFrequencyMHz+f_rx_20MHz[i];
-                         psd2[i]=pow(10, psd_db[i]/10.0);
-                        }
-                break;
-         case 40:
-                for(uint32_t i=0; i<11; i++)
-                        {
-                         f2[i]=receiverChannelFrequencyMHz+f_rx_40MHz[i];
-                         psd2[i]=pow(10, psd_db[i]/10.0);
-                        }
-                break;
-         case 80:
-                for(uint32_t i=0; i<11; i++)
-                        {
-                         f2[i]=receiverChannelFrequencyMHz+f_rx_80MHz[i];
-                         psd2[i]=pow(10, psd_db[i]/10.0);
-                        }
-                break;
-         case 160:
-                for(uint32_t i=0; i<11; i++)
-                        {
-                         f2[i]=receiverChannelFrequencyMHz+f_rx_160MHz[i];
-                         psd2[i]=pow(10, psd_db[i]/10.0);
-                        }
-                break;
-          }
-
-
   // calculate overlapping area of masks
   std::vector<double> psdo;
   std::vector<double> fo;
   double f_min=std::max(f1[0],f2[0]);
-  double f_max=std::min(f1[10],f2[10]);
- 
+  double f_max=std::min(f1[n1-1],f2[n2-1]);
 
   if (f_min>f_max)
-	{
-	 return alpha;
-	}
+    {
+      return alpha;
+    }
 
-  for (uint32_t i=0; i<11; i++)
-        if (f_min<=f1[i] && f1[i]<=f_max)
-                fo.push_back(f1[i]);
+  for (uint32_t i=0; i<n1; i++)
+    {
+      if (f_min<=f1[i] && f1[i]<=f_max)
+        {
+          fo.push_back(f1[i]);
+        }
+    }
 
-  for (uint32_t i=0; i<11; i++)
+  for (uint32_t i=0; i<n2; i++)
+    {
+      if (f_min<=f2[i] && f2[i]<=f_max && std::find (fo.begin (), fo.end (), f2[i]) == fo.end ())
         {
-         bool aux=0;
-         for (uint32_t j=0; j<11; j++)
-                {
-                 if (fo[j]==f2[i])
-                        aux=1;
-                }
-         if(aux==0 && f_min<=f2[i] && f2[i]<=f_max)
-                fo.push_back(f2[i]);
+          fo.push_back(f2[i]);
         }
+    }
   std::sort(fo.begin(), fo.end());
 
-
   std::vector<double> fo_aux;
   std::vector<double> psdo_aux;
-  
+
   // fill in values for psdo and add extra intersection points
-  uint32_t aux1;
-  uint32_t aux2;
-  for (std::vector<int>::size_type i=0; i<fo.size(); i++)
-        {
-          aux1=1000; // just any number not valid as index in this context
-          aux2=1000;
-          for (uint32_t j=0; j<11; j++)
-                if (f1[j]==fo[i]) aux1=j;
-          for (uint32_t j=0; j<11; j++)
-                if (f2[j]==fo[i]) aux2=j;
-          if (aux1!=1000 && aux2!=1000)
+  for (uint32_t i=0; i<fo.size(); i++)
+    {
+      uint32_t aux1=n1; // not valid as index
+      uint32_t aux2=n2;
+      for (uint32_t j=0; j<n1; j++)
+        {
+          if (f1[j]==fo[i]) aux1=j;
+        }
+      for (uint32_t j=0; j<n2; j++)
+        {
+          if (f2[j]==fo[i]) aux2=j;
+        }
+      if (aux1!=n1 && aux2!=n2)
+        {
+          psdo.push_back(psd1[aux1]*psd2[aux2]);
+          // add additional intersection points
+          if (aux1+1<n1 && aux2+1<n2
+              && ((psd1[aux1]<psd2[aux2] && psd1[aux1+1]>psd2[aux2+1]) || (psd1[aux1]>psd2[aux2] && psd1[aux1+1]<psd2[aux2+1])))
+            {
+              double ax1=f1[aux1];
+              double bx1=f1[aux1+1];
+              double ay1=psd1[aux1];
+              double by1=psd1[aux1+1];
+              double ax2=f2[aux2];
+              double bx2=f2[aux2+1];
+              double ay2=psd2[aux2];
+              double by2=psd2[aux2+1];
+              double wx=(((ax2*(by2-ay2))/(bx2-ax2))-ay2-((ax1*(by1-ay1))/(bx1-ax1))+ay1)/(((by2-ay2)/(bx2-ax2))-((by1-ay1)/(bx1-ax1)));
+              double wy=(wx*(by2-ay2)/(bx2-ax2))-(ax2*(by2-ay2)/(bx2-ax2))+ay2;
+              fo_aux.push_back(wx);
+              psdo_aux.push_back(wy);
+            }
+        }
+      else if (aux1!=n1 && aux2==n2)
+        {
+          for (uint32_t j=0; j<n2-1; j++)
+            {
+              if ((f2[j]<f1[aux1]) && (f1[aux1]<f2[j+1]))
+                {
+                  double ax=f2[j];
+                  double bx=f2[j+1];
+                  double ay=psd2[j];
+                  double by=psd2[j+1];
+                  double wx=f1[aux1];
+                  double wy=((by-ay)*(wx-ax)/(bx-ax))+ay;
+                  psdo.push_back(wy*psd1[aux1]);
+                }
+            }
+        }
+      else if (aux1==n1 && aux2!=n2)
+        {
+          for (uint32_t j=0; j<n1-1; j++)
+            {
+              if ((f1[j]<f2[aux2]) && (f2[aux2]<f1[j+1]))
                 {
-                 psdo.push_back(psd1[aux1]*psd2[aux2]);
-                 // add additional intersection points
-                 if ((psd1[aux1]<psd2[aux2] && psd1[aux1+1]>psd2[aux2+1]) || (psd1[aux1]>psd2[aux2] && psd1[aux1+1]<psd2[aux2+1]))
-                        {
-                         double ax1=f1[aux1];
-                         double bx1=f1[aux1+1];
-                         double ay1=psd1[aux1];
-                         double by1=psd1[aux1+1];
-                         double ax2=f2[aux2];
-                         double bx2=f2[aux2+1];
-                         double ay2=psd2[aux2];
-                         double by2=psd2[aux2+1];
-                         double wx=(((ax2*(by2-ay2))/(bx2-ax2))-ay2-((ax1*(by1-ay1))/(bx1-ax1))+ay1)/(((by2-ay2)/(bx2-ax2))-((by1-ay1)/(bx1-ax1)));   
-                         double wy=(wx*(by2-ay2)/(bx2-ax2))-(ax2*(by2-ay2)/(bx2-ax2))+ay2;
-                         fo_aux.push_back(wx);
-                         psdo_aux.push_back(wy); 
-                        }
+                  double ax=f1[j];
+                  double bx=f1[j+1];
+                  double ay=psd1[j];
+                  double by=psd1[j+1];
+                  double wx=f2[aux2];
+                  double wy=((by-ay)*(wx-ax)/(bx-ax))+ay;
+                  psdo.push_back(wy*psd2[aux2]);
                 }
-           else
-                if (aux1!=1000 && aux2==1000)
-                        {
-                         for (uint32_t j=0; j<11-1; j++)
-                                {
-                                 if ((f2[j]<f1[aux1]) && (f1[aux1]<f2[j+1]))
-                                        {
-					 double ax=f2[j];
-                                         double bx=f2[j+1];
-                                         double ay=psd2[j];
-                                         double by=psd2[j+1];
-                                         double wx=f1[aux1];
-                                         double wy=((by-ay)*(wx-ax)/(bx-ax))+ay;
-                                         psdo.push_back(wy*psd1[aux1]);              
-                                        }
-                                }
-                        }
-                else
-                    if (aux1==1000 && aux2!=1000)
-                            {
-                             for (uint32_t j=0; j<11-1; j++)
-                                {
-                                 if ((f1[j]<f2[aux2]) && (f2[aux2]<f1[j+1]))
-                                        {
-					 double ax=f1[j];
-                                         double bx=f1[j+1];
-                                         double ay=psd1[j];
-                                         double by=psd1[j+1];
-                                         double wx=f2[aux2];
-                                         double wy=((by-ay)*(wx-ax)/(bx-ax))+ay;
-                                         psdo.push_back(wy*psd2[aux2]);              
-                                        }
-                                }
-                        }  
-          
-        }
-   
+            }
+        }
+    }
 
   // merge original frequency points with additional intersection points
   for (uint32_t i=0; i<fo_aux.size(); i++)
+    {
+      for (uint32_t k=0; k+1<fo.size(); k++)
         {
-	 std::vector<double>::iterator itp=psdo.begin();	
-	 for (std::vector<double>::iterator it=fo.begin(); it<fo.end()-1; it++)
-                {
-		 itp++;
-		 if (fo_aux[i]>*it && fo_aux[i]<*(it+1))
-                        {
-			 fo.insert(it+1,fo_aux[i]);
-         		 psdo.insert(itp,psdo_aux[i]*psdo_aux[i]);
-			 break; 
-                        }
-		}
-        }
-
-  /*
-  std::cout<<"fo=[ ";
-  for (uint32_t i=0; i<fo.size(); i++)
-  	std::cout<<fo[i]<<" ";
-  std::cout<<"\n";
-  std::cout<<"psdo=[ ";
-  for (uint32_t i=0; i<psdo.size(); i++)
-  	std::cout<<psdo[i]<<" ";
-  std::cout<<"\n";
-  */
-
-  std::vector<double> psd1_vector;
-  std::vector<double> f1_vector;
-  
-  for (uint32_t i=0; i<11; i++)
-  	{	
-   	psd1_vector.push_back(psd1[i]);
-   	f1_vector.push_back(f1[i]);
-  	}
+          if (fo_aux[i]>fo[k] && fo_aux[i]<fo[k+1])
+            {
+              fo.insert(fo.begin()+k+1,fo_aux[i]);
+              psdo.insert(psdo.begin()+k+1,psdo_aux[i]*psdo_aux[i]);
+              break;
+            }
+        }
+    }
 
-    
   if (fo.size()>1)
-  	{
-  	 alpha = trapz(fo, psdo) / trapz(f1_vector, psd1_vector);
-  	}
-  
+    {
+      alpha = trapz(fo, psdo) / trapz(f1, psd1);
+    }
+
   return alpha;
 }
 
+double overlapFactorToBeDecoded(uint32_t senderChannelWidth, uint32_t receiverChannelWidth, uint32_t senderChannelFrequencyMHz,  uint32_t receiverChannelFrequencyMHz)
+{
+  // spectrum mask given by standard, for both transmitter and receiver
+  YansWifiChannel::SpectrumMask txMask = YansWifiChannel::GetStandardMask (senderChannelWidth);
+  YansWifiChannel::SpectrumMask rxMask = YansWifiChannel::GetStandardMask (receiverChannelWidth);
+  std::vector<double> f1 (txMask.offsetMhz.size ());
+  std::vector<double> f2 (rxMask.offsetMhz.size ());
+  for (uint32_t i=0; i<f1.size(); i++)
+    {
+      f1[i]=senderChannelFrequencyMHz+txMask.offsetMhz[i];
+    }
+  for (uint32_t i=0; i<f2.size(); i++)
+    {
+      f2[i]=receiverChannelFrequencyMHz+rxMask.offsetMhz[i];
+    }
+  return overlapFactor (f1, txMask.psd, f2, rxMask.psd);
+}
+
+YansWifiChannel::SpectrumMask
+YansWifiChannel::GetStandardMask (uint32_t width)
+{
+  // spectrum mask given by the 802.11ac standard
+  static const double psd_db[11] = {-40, -40, -28, -20, 0, 0, 0, -20, -28, -40, -40};
 
+  static const double f_20MHz[11] = {-50, -30, -20, -11, -9, 0, 9, 11, 20, 30, 50};
+  static const double f_40MHz[11] = {-100, -60, -40, -21, -19, 0, 19, 21, 40, 60, 100};
+  static const double f_80MHz[11] = {-200, -120, -80, -40, -39, 0, 39, 41, 80, 120, 200};
+  static const double f_160MHz[11] = {-400, -240, -160, -81, -79, 0, 79, 81, 160, 240, 400};
 
-///////////////////////////////////////////////////////////////////////////////
-///////////////////////////////  End of Added code ////////////////////////////
-///////////////////////////////////////////////////////////////////////////////
-void
-YansWifiChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
+  SpectrumMask mask;
+  for (uint32_t i=0; i<11; i++)
+    {
+      double offset;
+      switch (width)
+        {
+        case 20:
+          offset = f_20MHz[i];
+          break;
+        case 40:
+          offset = f_40MHz[i];
+          break;
+        case 80:
+          offset = f_80MHz[i];
+          break;
+        case 160:
+          offset = f_160MHz[i];
+          break;
+        default:
+          //e.g., 5 and 10 MHz channels: scaled 20 MHz mask
+          offset = f_20MHz[i] * width / 20.0;
+          break;
+        }
+      mask.offsetMhz.push_back (offset);
+      mask.psd.push_back (pow(10, psd_db[i]/10.0));
+    }
+  return mask;
+}
+
+YansWifiChannel::SpectrumMaskMap
+YansWifiChannel::LoadSpectrumMasks (std::string filename)
 {
-  m_loss = loss;
+  NS_LOG_FUNCTION (filename);
+  SpectrumMaskMap masks;
+  if (filename.empty ())
+    {
+      return masks;
+    }
+  std::ifstream is (filename.c_str ());
+  if (!is.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open spectrum mask file " << filename);
+    }
+  std::string line;
+  while (std::getline (is, line))
+    {
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+      std::istringstream record (line);
+      uint32_t width;
+      double offset, psdDb;
+      if (!(record >> width >> offset >> psdDb))
+        {
+          NS_FATAL_ERROR ("Malformed breakpoint \"" << line << "\" in spectrum mask file " << filename);
+        }
+      SpectrumMask &mask = masks[width];
+      NS_ABORT_MSG_IF (!mask.offsetMhz.empty () && offset < mask.offsetMhz.back (),
+                       "Breakpoints of the " << width << " MHz mask are not in increasing frequency order in " << filename);
+      mask.offsetMhz.push_back (offset);
+      mask.psd.push_back (pow (10, psdDb / 10.0));
+    }
+  for (SpectrumMaskMap::const_iterator i = masks.begin (); i != masks.end (); i++)
+    {
+      NS_ABORT_MSG_IF (i->second.offsetMhz.size () < 2, "The " << i->first << " MHz mask of " << filename <<
+                       " needs at least two breakpoints");
+    }
+  return masks;
 }
 
-void
-YansWifiChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel> delay)
+const YansWifiChannel::SpectrumMask &
+YansWifiChannel::GetMask (SpectrumMaskMap &masks, uint32_t width)
 {
-  m_delay = delay;
+  SpectrumMaskMap::iterator it = masks.find (width);
+  if (it == masks.end ())
+    {
+      it = masks.insert (std::make_pair (width, GetStandardMask (width))).first;
+    }
+  return it->second;
+}
+
+struct YansWifiChannel::Overlap
+YansWifiChannel::ComputeOverlap (const struct PhyConfig &tx, const struct PhyConfig &rx) const
+{
+  struct Overlap overlap;
+  m_fanOutStats.overlapComputed++;
+  const SpectrumMask &txMask = GetMask (m_maskSets[tx.maskSet].tx, tx.width);
+  std::vector<double> f1 (txMask.offsetMhz.size ());
+  for (uint32_t i = 0; i < f1.size (); i++)
+    {
+      f1[i] = tx.frequency + txMask.offsetMhz[i];
+    }
+
+  overlap.nSubchannels = std::max<uint32_t> (1, std::min<uint32_t> (Parameters::MAX_SUBCHANNELS, rx.width / 20));
+  if ((tx.frequency-tx.width/2<=rx.frequency-rx.width/2) && (tx.frequency+tx.width/2>=rx.frequency+rx.width/2))
+    {
+      // Sender's bandwidth included in receiver's bandwidth
+      // Co channel interference
+      overlap.db = 0.0;
+      overlap.linear = 1.0;
+      //the whole power is seen, spread evenly over the subchannels
+      for (uint32_t k = 0; k < overlap.nSubchannels; k++)
+        {
+          overlap.subchannelLinear[k] = 1.0 / overlap.nSubchannels;
+          overlap.subchannelDb[k] = 10 * log10 (overlap.subchannelLinear[k]);
+        }
+      return overlap;
+    }
+  else
+    {
+      const SpectrumMask &rxMask = GetMask (m_maskSets[rx.maskSet].rx, rx.width);
+      std::vector<double> f2 (rxMask.offsetMhz.size ());
+      for (uint32_t i = 0; i < f2.size (); i++)
+        {
+          f2[i] = rx.frequency + rxMask.offsetMhz[i];
+        }
+      double alpha = overlapFactor (f1, txMask.psd, f2, rxMask.psd);
+      overlap.db = 10*log10(alpha);
+      overlap.linear = alpha;
+    }
+
+  //share of the sender's power seen through the 20 MHz filter of each subchannel of the receiver
+  double subchannelWidth = static_cast<double> (rx.width) / overlap.nSubchannels;
+  const SpectrumMask &subchannelMask = GetMask (m_maskSets[rx.maskSet].rx, static_cast<uint32_t> (subchannelWidth));
+  std::vector<double> f2 (subchannelMask.offsetMhz.size ());
+  for (uint32_t k = 0; k < overlap.nSubchannels; k++)
+    {
+      double center = rx.frequency - rx.width / 2.0 + subchannelWidth * (k + 0.5);
+      for (uint32_t i = 0; i < f2.size (); i++)
+        {
+          f2[i] = center + subchannelMask.offsetMhz[i];
+        }
+      overlap.subchannelLinear[k] = overlapFactor (f1, txMask.psd, f2, subchannelMask.psd);
+      overlap.subchannelDb[k] = 10 * log10 (overlap.subchannelLinear[k]);
+    }
+  return overlap;
+}
+
+uint32_t
+YansWifiChannel::RegisterConfig (uint32_t maskSet, uint32_t frequency, uint32_t width) const
+{
+  uint64_t key = (static_cast<uint64_t> (maskSet) << 48) | (static_cast<uint64_t> (frequency) << 16) | width;
+  std::map<uint64_t, uint32_t>::const_iterator it = m_configIndex.find (key);
+  if (it != m_configIndex.end ())
+    {
+      return it->second;
+    }
+  NS_LOG_FUNCTION (this << maskSet << frequency << width);
+  uint32_t id = m_configs.size ();
+  struct PhyConfig config;
+  config.maskSet = maskSet;
+  config.frequency = frequency;
+  config.width = width;
+  m_configs.push_back (config);
+  m_configIndex[key] = id;
+  //all the pairs with the new configuration, in both directions
+  for (uint32_t c = 0; c < id; c++)
+    {
+      m_overlapDb[c].push_back (ComputeOverlap (m_configs[c], config));
+    }
+  m_overlapDb.push_back (std::vector<struct Overlap> (id + 1));
+  for (uint32_t c = 0; c <= id; c++)
+    {
+      m_overlapDb[id][c] = ComputeOverlap (config, m_configs[c]);
+    }
+  return id;
+}
+
+uint32_t
+YansWifiChannel::GetPhyConfig (uint32_t i) const
+{
+  uint32_t id = m_phyConfig[i];
+  uint32_t frequency = m_phyList[i]->GetFrequency ();
+  uint32_t width = m_phyList[i]->GetChannelWidth ();
+  if (id == 0xffffffff || m_configs[id].frequency != frequency || m_configs[id].width != width)
+    {
+      id = RegisterConfig (m_phyMaskSet[i], frequency, width);
+      m_phyConfig[i] = id;
+    }
+  return id;
 }
 
 void
-YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
-                       WifiTxVector txVector, WifiPreamble preamble, enum mpduType mpdutype, Time duration) const
+YansWifiChannel::ResetOverlapTables (void)
 {
-  Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
-  NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  double overlappingFactorDb = 0.0;
+  m_configs.clear ();
+  m_configIndex.clear ();
+  m_overlapDb.clear ();
+  std::fill (m_phyConfig.begin (), m_phyConfig.end (), 0xffffffff);
+  std::fill (m_sensorConfig.begin (), m_sensorConfig.end (), 0xffffffff);
+  //the accounted airtime and energy are kept, as they are indexed by frequency
+  m_occupancyConfigs.clear ();
+  m_occupancyKnownConfigs = 0;
+}
 
-  ////////////////////////////////////
-  // ADJACENT CHANNEL INTERFERENCE //  for 802.11ac
-  ////////////////////////////////////
+uint32_t
+YansWifiChannel::GetMaskSet (std::string txMaskFile, std::string rxMaskFile)
+{
+  for (uint32_t i = 1; i < m_maskSets.size (); i++)
+    {
+      if (m_maskSets[i].txFile == txMaskFile && m_maskSets[i].rxFile == rxMaskFile)
+        {
+          return i;
+        }
+    }
+  struct MaskSet maskSet;
+  maskSet.txFile = txMaskFile;
+  maskSet.rxFile = rxMaskFile;
+  maskSet.tx = LoadSpectrumMasks (txMaskFile);
+  maskSet.rx = LoadSpectrumMasks (rxMaskFile);
+  m_maskSets.push_back (maskSet);
+  return m_maskSets.size () - 1;
+}
 
+void
+YansWifiChannel::SetTxMaskFile (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_maskSets[0].txFile = filename;
+  m_maskSets[0].tx = LoadSpectrumMasks (filename);
+  ResetOverlapTables ();
+}
 
-  // The term co-channel interference is used when all the power coming from the interfer
-  // has to be taken into account. Therefore overlapingFactor is 0.0.
-  //
-  // On the contrary, the term adjacent channel interference is used when only a part of  
-  // the interferer's power should be taken into account. 
+std::string
+YansWifiChannel::GetTxMaskFile (void) const
+{
+  return m_maskSets[0].txFile;
+}
 
- 
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
-    { 
-      //uint32_t senderChannelNo = sender->GetChannelNumber();
-      uint32_t senderChannelWidth = sender->GetChannelWidth(); 
-      uint32_t senderCentralFrequency = sender->GetFrequency();
-      
-      //uint32_t receiverChannelNo = (*i)->GetChannelNumber();
-      uint32_t receiverChannelWidth = (*i)->GetChannelWidth(); 
-      uint32_t receiverCentralFrequency = (*i)->GetFrequency(); 
-      //double receiverPower = (*i)->GetTxPowerEnd(); //in dBm
+void
+YansWifiChannel::SetRxMaskFile (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  m_maskSets[0].rxFile = filename;
+  m_maskSets[0].rx = LoadSpectrumMasks (filename);
+  ResetOverlapTables ();
+}
 
+std::string
+YansWifiChannel::GetRxMaskFile (void) const
+{
+  return m_maskSets[0].rxFile;
+}
 
-      bool setModifs = true;
-      
-      if (sender != (*i))
-        {   
+void
+YansWifiChannel::SetSpectrumMasks (Ptr<YansWifiPhy> phy, std::string txMaskFile, std::string rxMaskFile)
+{
+  NS_LOG_FUNCTION (this << phy << txMaskFile << rxMaskFile);
+  PhyIndex::const_iterator it = m_phyIndex.find (phy);
+  NS_ABORT_MSG_IF (it == m_phyIndex.end (), "PHY not connected to this channel");
+  m_phyMaskSet[it->second] = GetMaskSet (txMaskFile, rxMaskFile);
+  m_phyConfig[it->second] = 0xffffffff;
+}
 
-          if((*i)->GetChannelNumber () != sender->GetChannelNumber () && !setModifs)
-                {
-                  continue;
-                }
+double
+YansWifiChannel::GetOverlapFactorDb (Ptr<YansWifiPhy> sender, Ptr<YansWifiPhy> receiver) const
+{
+  PhyIndex::const_iterator s = m_phyIndex.find (sender);
+  PhyIndex::const_iterator r = m_phyIndex.find (receiver);
+  NS_ABORT_MSG_IF (s == m_phyIndex.end () || r == m_phyIndex.end (), "PHY not connected to this channel");
+  uint32_t senderConfig = GetPhyConfig (s->second);
+  uint32_t receiverConfig = GetPhyConfig (r->second);
+  return m_overlapDb[senderConfig][receiverConfig].db;
+}
 
-          if ((senderCentralFrequency-senderChannelWidth/2<=receiverCentralFrequency-receiverChannelWidth/2) && (senderCentralFrequency+senderChannelWidth/2>=receiverCentralFrequency+receiverChannelWidth/2))
-                {
-                 // Sender's bandwidth included in receiver's bandwidth
-                 // Co channel interference
-                 overlappingFactorDb = 0.0;
-                }
-          else 
-                {
-                 double alpha = overlapFactorToBeDecoded(senderChannelWidth, receiverChannelWidth, senderCentralFrequency,  receiverCentralFrequency);
-                 overlappingFactorDb = 10*log10(alpha);
-                 }
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////  End of Added code ////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+void
+YansWifiChannel::SetPropagationLossModel (Ptr<PropagationLossModel> loss)
+{
+  m_loss = loss;
+  m_linkLoss.clear ();
+}
 
-              Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-              Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-              double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-              rxPowerDbm += overlappingFactorDb;
-              NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-              Ptr<Packet> copy = packet->Copy ();
-              Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
-              uint32_t dstNode;
+void
+YansWifiChannel::SetSensorPropagationLossModel (Ptr<PropagationLossModel> loss)
+{
+  NS_LOG_FUNCTION (this << loss);
+  m_sensorLoss = loss;
+}
 
-          //---------End of modification
+void
+YansWifiChannel::SetFadingCoherenceTime (Time coherenceTime)
+{
+  NS_LOG_FUNCTION (this << coherenceTime);
+  m_fadingCoherenceTime = coherenceTime;
+  m_linkLoss.clear ();
+}
 
+Time
+YansWifiChannel::GetFadingCoherenceTime (void) const
+{
+  return m_fadingCoherenceTime;
+}
 
-          if (dstNetDevice == 0)
-            {
-              dstNode = 0xffffffff;
-            }
-          else
-            {
-              dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
-            }
+double
+YansWifiChannel::CalcRxPower (double txPowerDbm, Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> receiverMobility,
+                              uint32_t sender, uint32_t receiver, Time &delay, double &gain) const
+{
+  if ((m_fadingCoherenceTime.IsZero () && m_linkRefreshTolerance <= 0) || sender == 0xffffffff)
+    {
+      delay = m_delay->GetDelay (senderMobility, receiverMobility);
+      double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+      if (m_linearPowerPipeline)
+        {
+          gain = std::pow (10.0, (rxPowerDbm - txPowerDbm) / 10);
+        }
+      return rxPowerDbm;
+    }
+  m_fanOutStats.linkLookups++;
+  //one entry per unordered pair: the realization is the same in both directions
+  uint32_t first = std::min (sender, receiver);
+  uint32_t second = std::max (sender, receiver);
+  Ptr<MobilityModel> firstMobility = (first == sender) ? senderMobility : receiverMobility;
+  Ptr<MobilityModel> secondMobility = (first == sender) ? receiverMobility : senderMobility;
+  uint32_t firstCourse = GetMotion (first, firstMobility).courseChanges;
+  uint32_t secondCourse = GetMotion (second, secondMobility).courseChanges;
+  uint64_t key = (static_cast<uint64_t> (first) << 32) | second;
+  std::map<uint64_t, struct LinkLoss>::iterator it = m_linkLoss.lower_bound (key);
+  if (it == m_linkLoss.end () || it->first != key)
+    {
+      if (m_linkLoss.size () >= 2 * m_linkSweepSize)
+        {
+          SweepLinks ();
+          it = m_linkLoss.lower_bound (key);
+        }
+      struct LinkLoss empty;
+      empty.lossDb = 0.0;
+      empty.gain = 0.0;
+      empty.distance = 0.0;
+      empty.firstOdometer = 0.0;
+      empty.secondOdometer = 0.0;
+      empty.firstCourse = firstCourse;
+      empty.secondCourse = secondCourse;
+      it = m_linkLoss.insert (it, std::make_pair (key, empty));
+    }
+  struct LinkLoss &link = it->second;
+  Time now = Simulator::Now ();
+  if (m_linkRefreshTolerance <= 0)
+    {
+      if (link.firstCourse != firstCourse || link.secondCourse != secondCourse)
+        {
+          //either PHY changed course: the cached realization is stale
+          link.expires = Seconds (0);
+        }
+      if (now < link.expires)
+        {
+          m_fanOutStats.linkHits++;
+          delay = m_delay->GetDelay (senderMobility, receiverMobility);
+          gain = link.gain;
+          return txPowerDbm + link.lossDb;
+        }
+    }
+  else if (now < link.expires && IsLinkWithinTolerance (first, second, link))
+    {
+      //the course changes are accounted for by the odometers
+      m_fanOutStats.linkHits++;
+      delay = link.delay;
+      gain = link.gain;
+      return txPowerDbm + link.lossDb;
+    }
+  delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  link.lossDb = rxPowerDbm - txPowerDbm;
+  link.gain = m_linearPowerPipeline ? std::pow (10.0, link.lossDb / 10) : 0.0;
+  gain = link.gain;
+  link.firstCourse = firstCourse;
+  link.secondCourse = secondCourse;
+  if (m_linkRefreshTolerance <= 0)
+    {
+      link.expires = now + m_fadingCoherenceTime;
+    }
+  else
+    {
+      link.expires = m_linkRefreshMaxAge.IsZero () ? Time::Max () : now + m_linkRefreshMaxAge;
+      link.delay = delay;
+      link.distance = senderMobility->GetDistanceFrom (receiverMobility);
+      link.firstOdometer = GetOdometer (first, firstMobility);
+      link.secondOdometer = GetOdometer (second, secondMobility);
+    }
+  return rxPowerDbm;
+}
 
-          struct Parameters parameters;
-          parameters.rxPowerDbm = rxPowerDbm;
-          parameters.type = mpdutype;
-          parameters.duration = duration;
-          parameters.txVector = txVector;
-          parameters.preamble = preamble;
-          // change
-          parameters.channelFrequency = sender->GetFrequency ();
-          parameters.channelWidth = sender->GetChannelWidth ();
-          // end change
+bool
+YansWifiChannel::IsLinkWithinTolerance (uint32_t first, uint32_t second, const struct LinkLoss &link) const
+{
+  if (link.distance <= 0)
+    {
+      return false;
+    }
+  //the distance can have shrunk by at most the distance traveled by both PHYs
+  double moved = GetOdometer (first, m_motion[first].mobility) - link.firstOdometer
+    + GetOdometer (second, m_motion[second].mobility) - link.secondOdometer;
+  return moved <= link.distance * m_linkRefreshFactor;
+}
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, parameters);
+void
+YansWifiChannel::SweepLinks (void) const
+{
+  Time now = Simulator::Now ();
+  std::map<uint64_t, struct LinkLoss>::iterator it = m_linkLoss.begin ();
+  while (it != m_linkLoss.end ())
+    {
+      if (it->second.expires <= now
+          || (m_linkRefreshTolerance > 0
+              && !IsLinkWithinTolerance (it->first >> 32, it->first & 0xffffffff, it->second)))
+        {
+          m_linkLoss.erase (it++);
+        }
+      else
+        {
+          ++it;
         }
     }
+  m_linkSweepSize = std::max<std::size_t> (512, m_linkLoss.size ());
+}
+
+struct YansWifiChannel::Motion &
+YansWifiChannel::GetMotion (uint32_t i, Ptr<MobilityModel> mobility) const
+{
+  if (m_motion.size () <= i)
+    {
+      struct Motion motion;
+      motion.speed = 0.0;
+      motion.odometer = 0.0;
+      motion.mobility = 0;
+      motion.courseChanges = 0;
+      m_motion.resize (m_phyList.size (), motion);
+    }
+  struct Motion &motion = m_motion[i];
+  if (motion.mobility == 0)
+    {
+      std::ostringstream context;
+      context << i;
+      mobility->TraceConnect ("CourseChange", context.str (),
+                              MakeCallback (&YansWifiChannel::NotifyCourseChange, this));
+      motion.position = mobility->GetPosition ();
+      motion.speed = CalculateDistance (mobility->GetVelocity (), Vector ());
+      motion.time = Simulator::Now ();
+      motion.mobility = mobility;
+    }
+  return motion;
+}
+
+double
+YansWifiChannel::GetOdometer (uint32_t i, Ptr<MobilityModel> mobility) const
+{
+  const struct Motion &motion = GetMotion (i, mobility);
+  return motion.odometer + motion.speed * (Simulator::Now () - motion.time).GetSeconds ();
 }
 
 void
-YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const
+YansWifiChannel::NotifyCourseChange (std::string context, Ptr<const MobilityModel> mobility) const
 {
-  m_phyList[i]->StartReceivePreambleAndHeader (packet, parameters.rxPowerDbm, parameters.txVector, parameters.preamble, parameters.type, parameters.duration, parameters.channelFrequency, parameters.channelWidth); //--------change here
+  struct Motion &motion = m_motion[std::atoi (context.c_str ())];
+  Vector position = mobility->GetPosition ();
+  Time now = Simulator::Now ();
+  //exact for piecewise linear motion, and also covers jumps
+  motion.odometer += std::max (CalculateDistance (position, motion.position),
+                               motion.speed * (now - motion.time).GetSeconds ());
+  motion.position = position;
+  motion.speed = CalculateDistance (mobility->GetVelocity (), Vector ());
+  motion.time = now;
+  motion.courseChanges++;
 }
 
-uint32_t
-YansWifiChannel::GetNDevices (void) const
+void
+YansWifiChannel::SetLinkRefreshTolerance (double tolerance)
 {
-  return m_phyList.size ();
+  NS_LOG_FUNCTION (this << tolerance);
+  m_linkRefreshTolerance = tolerance;
+  m_linkRefreshFactor = 1 - std::pow (10.0, -tolerance / (10 * m_linkRefreshExponent));
+  m_linkLoss.clear ();
 }
 
-Ptr<NetDevice>
-YansWifiChannel::GetDevice (uint32_t i) const
+double
+YansWifiChannel::GetLinkRefreshTolerance (void) const
 {
-  return m_phyList[i]->GetDevice ()->GetObject<NetDevice> ();
+  return m_linkRefreshTolerance;
 }
 
 void
-YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
+YansWifiChannel::SetLinkRefreshExponent (double exponent)
 {
-  m_phyList.push_back (phy);
+  NS_LOG_FUNCTION (this << exponent);
+  m_linkRefreshExponent = exponent;
+  m_linkRefreshFactor = 1 - std::pow (10.0, -m_linkRefreshTolerance / (10 * m_linkRefreshExponent));
+  m_linkLoss.clear ();
 }
 
-int64_t
-YansWifiChannel::AssignStreams (int64_t stream)
+double
+YansWifiChannel::GetLinkRefreshExponent (void) const
 {
-  int64_t currentStream = stream;
-  currentStream += m_loss->AssignStreams (stream);
+  return m_linkRefreshExponent;
+}
+
+void
+YansWifiChannel::SetLinkRefreshMaxAge (Time maxAge)
+{
+  NS_LOG_FUNCTION (this << maxAge);
+  m_linkRefreshMaxAge = maxAge;
+  m_linkLoss.clear ();
+}
+
+Time
+YansWifiChannel::GetLinkRefreshMaxAge (void) const
+{
+  return m_linkRefreshMaxAge;
+}
+
+void
+YansWifiChannel::SetLinearPowerPipeline (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  m_linearPowerPipeline = enable;
+  //the cached links have no gain if they were computed without the pipeline
+  m_linkLoss.clear ();
+}
+
+bool
+YansWifiChannel::GetLinearPowerPipeline (void) const
+{
+  return m_linearPowerPipeline;
+}
+
+void
+YansWifiChannel::SetFarFieldExponent (double exponent)
+{
+  m_farFieldExponent = exponent;
+  m_farFieldLossDb.clear ();
+  m_farFieldGain.clear ();
+}
+
+double
+YansWifiChannel::GetFarFieldExponent (void) const
+{
+  return m_farFieldExponent;
+}
+
+void
+YansWifiChannel::SetFarFieldReferenceLoss (double loss)
+{
+  m_farFieldReferenceLoss = loss;
+  m_farFieldLossDb.clear ();
+  m_farFieldGain.clear ();
+}
+
+double
+YansWifiChannel::GetFarFieldReferenceLoss (void) const
+{
+  return m_farFieldReferenceLoss;
+}
+
+void
+YansWifiChannel::SetFarFieldBinWidth (double width)
+{
+  m_farFieldBinWidth = width;
+  m_farFieldLossDb.clear ();
+  m_farFieldGain.clear ();
+}
+
+double
+YansWifiChannel::GetFarFieldBinWidth (void) const
+{
+  return m_farFieldBinWidth;
+}
+
+double
+YansWifiChannel::ComputeFarFieldLossDb (uint64_t bin) const
+{
+  return GetMeanLossDb ((bin + 0.5) * m_farFieldBinWidth);
+}
+
+double
+YansWifiChannel::GetMeanLossDb (double distance) const
+{
+  //the model is flat below the 1 m reference distance
+  return m_farFieldReferenceLoss + 10 * m_farFieldExponent * std::log10 (std::max (distance, 1.0));
+}
+
+int32_t
+YansWifiChannel::GetFarFieldIndex (double distance) const
+{
+  if (m_farFieldLossDb.empty ())
+    {
+      m_farFieldFirstBin = static_cast<uint64_t> (m_nearRadius / m_farFieldBinWidth);
+    }
+  double bin = std::floor (distance / m_farFieldBinWidth);
+  if (bin < m_farFieldFirstBin || bin >= m_farFieldFirstBin + MAX_FAR_FIELD_BINS)
+    {
+      return -1;
+    }
+  uint32_t index = static_cast<uint32_t> (bin - m_farFieldFirstBin);
+  if (index >= m_farFieldLossDb.size ())
+    {
+      uint32_t first = m_farFieldLossDb.size ();
+      m_farFieldLossDb.resize (index + 1);
+      m_farFieldGain.resize (index + 1);
+      for (uint32_t k = first; k <= index; k++)
+        {
+          m_farFieldLossDb[k] = ComputeFarFieldLossDb (m_farFieldFirstBin + k);
+          m_farFieldGain[k] = std::pow (10.0, -m_farFieldLossDb[k] / 10);
+        }
+    }
+  return index;
+}
+
+double
+YansWifiChannel::GetFarFieldLossDb (double distance) const
+{
+  int32_t index = GetFarFieldIndex (distance);
+  if (index < 0)
+    {
+      return ComputeFarFieldLossDb (static_cast<uint64_t> (distance / m_farFieldBinWidth));
+    }
+  return m_farFieldLossDb[index];
+}
+
+double
+YansWifiChannel::GetFarFieldGain (double distance) const
+{
+  int32_t index = GetFarFieldIndex (distance);
+  if (index < 0)
+    {
+      return std::pow (10.0, -ComputeFarFieldLossDb (static_cast<uint64_t> (distance / m_farFieldBinWidth)) / 10);
+    }
+  return m_farFieldGain[index];
+}
+
+void
+YansWifiChannel::RecordFarFieldError (double exactDbm, double approxDbm) const
+{
+  double error = approxDbm - exactDbm;
+  m_farFieldStats.validatedLinks++;
+  m_farFieldStats.sumErrorDb += error;
+  m_farFieldStats.sumSquaredErrorDb += error * error;
+  m_farFieldStats.maxAbsErrorDb = std::max (m_farFieldStats.maxAbsErrorDb, std::abs (error));
+  m_farFieldStats.exactPowerW += std::pow (10.0, (exactDbm - 30) / 10);
+  m_farFieldStats.approxPowerW += std::pow (10.0, (approxDbm - 30) / 10);
+}
+
+const struct YansWifiChannel::FarFieldStatistics &
+YansWifiChannel::GetFarFieldStatistics (void) const
+{
+  return m_farFieldStats;
+}
+
+void
+YansWifiChannel::ResetFarFieldStatistics (void)
+{
+  m_farFieldStats.nearLinks = 0;
+  m_farFieldStats.farLinks = 0;
+  m_farFieldStats.validatedLinks = 0;
+  m_farFieldStats.sumErrorDb = 0;
+  m_farFieldStats.sumSquaredErrorDb = 0;
+  m_farFieldStats.maxAbsErrorDb = 0;
+  m_farFieldStats.exactPowerW = 0;
+  m_farFieldStats.approxPowerW = 0;
+}
+
+const struct YansWifiChannel::FanOutStatistics &
+YansWifiChannel::GetFanOutStatistics (void) const
+{
+  return m_fanOutStats;
+}
+
+void
+YansWifiChannel::PrintFarFieldStatistics (std::ostream &os) const
+{
+  os << "near=" << m_farFieldStats.nearLinks << " far=" << m_farFieldStats.farLinks;
+  uint64_t n = m_farFieldStats.validatedLinks;
+  if (n > 0)
+    {
+      double mean = m_farFieldStats.sumErrorDb / n;
+      os << " validated=" << n
+         << " meanErrorDb=" << mean
+         << " rmsErrorDb=" << std::sqrt (m_farFieldStats.sumSquaredErrorDb / n)
+         << " maxAbsErrorDb=" << m_farFieldStats.maxAbsErrorDb
+         << " exactInterferenceW=" << m_farFieldStats.exactPowerW
+         << " approxInterferenceW=" << m_farFieldStats.approxPowerW;
+      if (m_farFieldStats.exactPowerW > 0)
+        {
+          os << " interferenceErrorDb="
+             << 10 * std::log10 (m_farFieldStats.approxPowerW / m_farFieldStats.exactPowerW);
+        }
+    }
+  os << std::endl;
+}
+
+const struct YansWifiChannel::OccupancyConfig &
+YansWifiChannel::GetOccupancyConfig (uint32_t config) const
+{
+  if (m_occupancyKnownConfigs < m_configs.size ())
+    {
+      //add the 20 MHz subchannels of the new configurations
+      bool added = false;
+      for (uint32_t c = m_occupancyKnownConfigs; c < m_configs.size (); c++)
+        {
+          uint32_t nSubchannels = std::max<uint32_t> (1, std::min<uint32_t> (Parameters::MAX_SUBCHANNELS, m_configs[c].width / 20));
+          for (uint32_t k = 0; k < nSubchannels; k++)
+            {
+              uint32_t center = m_configs[c].frequency - m_configs[c].width / 2 + m_configs[c].width * (2 * k + 1) / (2 * nSubchannels);
+              uint32_t s = 0;
+              while (s < m_subchannelEnergy.size () && m_subchannelEnergy[s].frequency != center)
+                {
+                  s++;
+                }
+              if (s == m_subchannelEnergy.size ())
+                {
+                  struct SubchannelEnergy energy = {center, 0.0, 0.0};
+                  m_subchannelEnergy.push_back (energy);
+                  added = true;
+                }
+            }
+        }
+      m_occupancyKnownConfigs = m_configs.size ();
+      if (added)
+        {
+          //the shares of all the configurations have to include the new subchannels
+          m_occupancyConfigs.clear ();
+        }
+    }
+  if (config >= m_occupancyConfigs.size ())
+    {
+      struct OccupancyConfig empty;
+      empty.airtime = 0xffffffff;
+      m_occupancyConfigs.resize (m_configs.size (), empty);
+    }
+  struct OccupancyConfig &occupancy = m_occupancyConfigs[config];
+  if (occupancy.airtime == 0xffffffff)
+    {
+      const struct PhyConfig &tx = m_configs[config];
+      uint32_t a = 0;
+      while (a < m_airtime.size () && (m_airtime[a].frequency != tx.frequency || m_airtime[a].width != tx.width))
+        {
+          a++;
+        }
+      if (a == m_airtime.size ())
+        {
+          struct Airtime airtime = {tx.frequency, tx.width, Seconds (0), Seconds (0)};
+          m_airtime.push_back (airtime);
+        }
+      occupancy.airtime = a;
+
+      const SpectrumMask &txMask = GetMask (m_maskSets[tx.maskSet].tx, tx.width);
+      const SpectrumMask &filter = GetMask (m_maskSets[0].rx, 20);
+      std::vector<double> f1 (txMask.offsetMhz.size ());
+      for (uint32_t i = 0; i < f1.size (); i++)
+        {
+          f1[i] = tx.frequency + txMask.offsetMhz[i];
+        }
+      std::vector<double> f2 (filter.offsetMhz.size ());
+      for (uint32_t s = 0; s < m_subchannelEnergy.size (); s++)
+        {
+          for (uint32_t i = 0; i < f2.size (); i++)
+            {
+              f2[i] = m_subchannelEnergy[s].frequency + filter.offsetMhz[i];
+            }
+          double fraction = overlapFactor (f1, txMask.psd, f2, filter.psd);
+          if (fraction > 0)
+            {
+              occupancy.subchannels.push_back (s);
+              occupancy.fractions.push_back (fraction);
+            }
+        }
+    }
+  return occupancy;
+}
+
+void
+YansWifiChannel::RecordOccupancy (uint32_t config, double txPowerDbm, Time duration) const
+{
+  const struct OccupancyConfig &occupancy = GetOccupancyConfig (config);
+  m_airtime[occupancy.airtime].total += duration;
+  double energyJ = std::pow (10.0, (txPowerDbm - 30) / 10.0) * duration.GetSeconds ();
+  for (uint32_t k = 0; k < occupancy.subchannels.size (); k++)
+    {
+      m_subchannelEnergy[occupancy.subchannels[k]].totalJ += energyJ * occupancy.fractions[k];
+    }
+}
+
+Time
+YansWifiChannel::GetAirtime (uint32_t frequency, uint32_t width) const
+{
+  for (std::vector<struct Airtime>::const_iterator it = m_airtime.begin (); it != m_airtime.end (); it++)
+    {
+      if (it->frequency == frequency && it->width == width)
+        {
+          return it->total;
+        }
+    }
+  return Seconds (0);
+}
+
+double
+YansWifiChannel::GetSubchannelTxEnergy (uint32_t frequency) const
+{
+  for (std::vector<struct SubchannelEnergy>::const_iterator it = m_subchannelEnergy.begin (); it != m_subchannelEnergy.end (); it++)
+    {
+      if (it->frequency == frequency)
+        {
+          return it->totalJ;
+        }
+    }
+  return 0.0;
+}
+
+void
+YansWifiChannel::EnableOccupancyReport (std::string filename, Time interval)
+{
+  NS_LOG_FUNCTION (this << filename << interval);
+  NS_ABORT_MSG_IF (!interval.IsStrictlyPositive (), "The sampling interval must be positive");
+  NS_ABORT_MSG_IF (m_occupancyStream != 0, "Occupancy report already enabled");
+  m_occupancyStream = Create<OutputStreamWrapper> (filename, std::ios::out);
+  *m_occupancyStream->GetStream () << "time,kind,frequency,width,value" << std::endl;
+  m_occupancyInterval = interval;
+  m_occupancyAccounting = true;
+  for (std::vector<struct Airtime>::iterator it = m_airtime.begin (); it != m_airtime.end (); it++)
+    {
+      it->reported = it->total;
+    }
+  for (std::vector<struct SubchannelEnergy>::iterator it = m_subchannelEnergy.begin (); it != m_subchannelEnergy.end (); it++)
+    {
+      it->reportedJ = it->totalJ;
+    }
+  Simulator::Schedule (interval, &YansWifiChannel::SampleOccupancy, this);
+}
+
+void
+YansWifiChannel::SampleOccupancy (void)
+{
+  if (m_occupancyStream == 0)
+    {
+      return;
+    }
+  std::ostream &os = *m_occupancyStream->GetStream ();
+  double now = Simulator::Now ().GetSeconds ();
+  for (std::vector<struct Airtime>::iterator it = m_airtime.begin (); it != m_airtime.end (); it++)
+    {
+      if (it->total != it->reported)
+        {
+          os << now << ",airtime," << it->frequency << "," << it->width << ","
+             << (it->total - it->reported).GetSeconds () << "\n";
+          it->reported = it->total;
+        }
+    }
+  for (std::vector<struct SubchannelEnergy>::iterator it = m_subchannelEnergy.begin (); it != m_subchannelEnergy.end (); it++)
+    {
+      if (it->totalJ != it->reportedJ)
+        {
+          os << now << ",txenergy," << it->frequency << ",20," << it->totalJ - it->reportedJ << "\n";
+          it->reportedJ = it->totalJ;
+        }
+    }
+  Simulator::Schedule (m_occupancyInterval, &YansWifiChannel::SampleOccupancy, this);
+}
+
+void
+YansWifiChannel::AddSensor (Ptr<YansWifiSensor> sensor)
+{
+  NS_LOG_FUNCTION (this << sensor);
+  NS_ABORT_MSG_IF (sensor->GetMobility () == 0, "The sensor has no mobility model");
+  m_sensors.push_back (sensor);
+  m_sensorConfig.push_back (0xffffffff);
+}
+
+uint32_t
+YansWifiChannel::GetNSensors (void) const
+{
+  return m_sensors.size ();
+}
+
+Ptr<YansWifiSensor>
+YansWifiChannel::GetSensor (uint32_t i) const
+{
+  return m_sensors[i];
+}
+
+void
+YansWifiChannel::DeliverToSensors (Ptr<MobilityModel> senderMobility, uint32_t senderConfig,
+                                   double txPowerDbm, Time duration) const
+{
+  double subchannelRxPowerDbm[Parameters::MAX_SUBCHANNELS];
+  for (uint32_t s = 0; s < m_sensors.size (); s++)
+    {
+      const Ptr<YansWifiSensor> &sensor = m_sensors[s];
+      uint32_t config = m_sensorConfig[s];
+      if (config == 0xffffffff || m_configs[config].frequency != sensor->GetFrequency ()
+          || m_configs[config].width != sensor->GetChannelWidth ())
+        {
+          config = RegisterConfig (0, sensor->GetFrequency (), sensor->GetChannelWidth ());
+          m_sensorConfig[s] = config;
+        }
+      const struct Overlap &overlap = m_overlapDb[senderConfig][config];
+      m_fanOutStats.overlapLookups++;
+      Ptr<MobilityModel> sensorMobility = sensor->GetMobility ();
+      //never the loss model of the PHYs, whose random streams must not depend on the sensors
+      double lossRxPowerDbm;
+      if (m_sensorLoss != 0)
+        {
+          lossRxPowerDbm = m_sensorLoss->CalcRxPower (txPowerDbm, senderMobility, sensorMobility);
+        }
+      else
+        {
+          lossRxPowerDbm = txPowerDbm - GetMeanLossDb (senderMobility->GetDistanceFrom (sensorMobility));
+        }
+      for (uint32_t k = 0; k < overlap.nSubchannels; k++)
+        {
+          subchannelRxPowerDbm[k] = lossRxPowerDbm + overlap.subchannelDb[k];
+        }
+      sensor->AddEnergy (subchannelRxPowerDbm, overlap.nSubchannels, duration);
+    }
+}
+
+void
+YansWifiChannel::EnableSensorReport (std::string filename, Time interval)
+{
+  NS_LOG_FUNCTION (this << filename << interval);
+  NS_ABORT_MSG_IF (!interval.IsStrictlyPositive (), "The sampling interval must be positive");
+  NS_ABORT_MSG_IF (m_sensorStream != 0, "Sensor report already enabled");
+  m_sensorStream = Create<OutputStreamWrapper> (filename, std::ios::out);
+  *m_sensorStream->GetStream () << "time,sensor,frequency,energy" << std::endl;
+  m_sensorInterval = interval;
+  Simulator::Schedule (interval, &YansWifiChannel::SampleSensors, this);
+}
+
+void
+YansWifiChannel::SampleSensors (void)
+{
+  if (m_sensorStream == 0)
+    {
+      return;
+    }
+  std::ostream &os = *m_sensorStream->GetStream ();
+  for (uint32_t s = 0; s < m_sensors.size (); s++)
+    {
+      m_sensors[s]->WriteSample (os, s);
+    }
+  Simulator::Schedule (m_sensorInterval, &YansWifiChannel::SampleSensors, this);
+}
+
+void
+YansWifiChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel> delay)
+{
+  m_delay = delay;
+}
+
+void
+YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
+                       WifiTxVector txVector, WifiPreamble preamble, enum mpduType mpdutype, Time duration) const
+{
+  YANS_WIFI_PROFILE_SCOPE (CHANNEL_SEND);
+  m_fanOutStats.sends++;
+  Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
+  NS_ASSERT (senderMobility != 0);
+  uint32_t j = 0;
+  double overlappingFactorDb = 0.0;
+  PhyIndex::const_iterator senderIndex = m_phyIndex.find (sender);
+  uint32_t senderId = (senderIndex != m_phyIndex.end ()) ? GetNodeId (senderIndex->second) : 0xffffffff;
+  //one copy shared by all the receivers: each PHY copies it again only if it syncs to it.
+  //It is made on first use, as receivers that get the energy only do not need it.
+  Ptr<const Packet> copy;
+  uint32_t size = packet->GetSize ();
+
+  ////////////////////////////////////
+  // ADJACENT CHANNEL INTERFERENCE //  for 802.11ac
+  ////////////////////////////////////
+
+
+  // The term co-channel interference is used when all the power coming from the interfer
+  // has to be taken into account. Therefore overlapingFactor is 0.0.
+  //
+  // On the contrary, the term adjacent channel interference is used when only a part of  
+  // the interferer's power should be taken into account. 
+
+ 
+  //overlap factors of all the configuration pairs are precomputed in m_overlapDb
+  uint32_t senderConfig = (senderIndex != m_phyIndex.end ()) ? GetPhyConfig (senderIndex->second) :
+    RegisterConfig (0, sender->GetFrequency (), sender->GetChannelWidth ());
+  if (m_occupancyAccounting)
+    {
+      RecordOccupancy (senderConfig, txPowerDbm, duration);
+    }
+  if (!m_sensors.empty ())
+    {
+      DeliverToSensors (senderMobility, senderConfig, txPowerDbm, duration);
+    }
+
+  //with the linear pipeline, the only conversion per transmission
+  double txPowerW = m_linearPowerPipeline ? std::pow (10.0, (txPowerDbm - 30) / 10) : 0.0;
+
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+    { 
+      //receivers with the co-channel reception policy behave as in stock ns-3.26
+      enum YansWifiPhy::ReceptionPolicy policy = (*i)->GetReceptionPolicy ();
+      bool setModifs = (policy != YansWifiPhy::RECEPTION_CO_CHANNEL);
+      
+      if (sender != (*i))
+        {   
+
+          if((*i)->GetChannelNumber () != sender->GetChannelNumber () && !setModifs)
+                {
+                  continue;
+                }
+
+          m_fanOutStats.receivers++;
+          const struct Overlap *overlap = 0;
+          overlappingFactorDb = 0.0;
+          if (setModifs)
+            {
+              uint32_t receiverConfig = GetPhyConfig (j);
+              overlap = &m_overlapDb[senderConfig][receiverConfig];
+              m_fanOutStats.overlapLookups++;
+              overlappingFactorDb = overlap->db;
+            }
+
+              Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+              Time delay;
+              double lossRxPowerDbm;
+              double gain = 0.0;
+              double distance = (m_nearRadius > 0) ? senderMobility->GetDistanceFrom (receiverMobility) : 0.0;
+              if (m_nearRadius > 0 && distance > m_nearRadius)
+                {
+                  //far receiver: only its contribution to the aggregate interference matters
+                  delay = m_delay->GetDelay (senderMobility, receiverMobility);
+                  lossRxPowerDbm = txPowerDbm - GetFarFieldLossDb (distance);
+                  if (m_linearPowerPipeline)
+                    {
+                      gain = GetFarFieldGain (distance);
+                    }
+                  m_farFieldStats.farLinks++;
+                  if (m_validateFarField)
+                    {
+                      double exactRxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+                      RecordFarFieldError (exactRxPowerDbm + overlappingFactorDb, lossRxPowerDbm + overlappingFactorDb);
+                    }
+                }
+              else
+                {
+                  lossRxPowerDbm = CalcRxPower (txPowerDbm, senderMobility, receiverMobility,
+                                                (senderIndex != m_phyIndex.end ()) ? senderIndex->second : 0xffffffff, j, delay, gain);
+                  m_farFieldStats.nearLinks++;
+                }
+              double rxPowerDbm = lossRxPowerDbm + overlappingFactorDb;
+              NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+
+          //---------End of modification
+
+
+          struct Parameters parameters;
+          parameters.rxPowerDbm = rxPowerDbm;
+          parameters.type = mpdutype;
+          parameters.duration = duration;
+          parameters.txVector = txVector;
+          parameters.preamble = preamble;
+          // change
+          parameters.channelFrequency = sender->GetFrequency ();
+          parameters.channelWidth = sender->GetChannelWidth ();
+          // end change
+          parameters.senderId = senderId;
+          parameters.overlapFactorDb = overlappingFactorDb;
+          parameters.rxPowerW = 0.0;
+          if (m_linearPowerPipeline)
+            {
+              parameters.rxPowerW = txPowerW * gain * ((overlap != 0) ? overlap->linear : 1.0);
+            }
+          parameters.nSubchannels = 0;
+          if (policy == YansWifiPhy::RECEPTION_SUBCHANNEL)
+            {
+              parameters.nSubchannels = overlap->nSubchannels;
+              for (uint32_t k = 0; k < overlap->nSubchannels; k++)
+                {
+                  parameters.subchannelRxPowerDbm[k] = lossRxPowerDbm + overlap->subchannelDb[k];
+                  parameters.subchannelRxPowerW[k] = txPowerW * gain * overlap->subchannelLinear[k];
+                }
+            }
+
+          if (m_skipSleepingReceivers)
+            {
+              if (m_asleep[j])
+                {
+                  //the receiver gets the signal as interference when it wakes up
+                  (*i)->NotifyReceptionSkipped (YansWifiPhy::DROP_SLEEP, rxPowerDbm, Simulator::Now () + delay);
+                  if (copy == 0)
+                    {
+                      YANS_WIFI_ALLOC_STAGE (PACKET_COPY);
+                      copy = packet->Copy ();
+                    }
+                  RecordSkippedReception (j, copy, parameters, Simulator::Now () + delay);
+                  continue;
+                }
+              if ((*i)->IsStateSwitching () && delay + duration <= (*i)->GetDelayUntilIdle ())
+                {
+                  //the signal is over before the channel switching completes
+                  (*i)->NotifyReceptionSkipped (YansWifiPhy::DROP_SWITCHING, rxPowerDbm, Simulator::Now () + delay);
+                  continue;
+                }
+            }
+
+          uint32_t dstNode = GetNodeId (j);
+          if (m_energyOnlyDelivery && setModifs
+              && !(*i)->CanSync (parameters.channelFrequency, parameters.channelWidth))
+            {
+              YANS_WIFI_ALLOC_STAGE (RECEIVE_EVENT);
+              Simulator::ScheduleWithContext (dstNode, delay,
+                                              new ReceiveEnergyEvent (this, j, size, parameters));
+              continue;
+            }
+          if (copy == 0)
+            {
+              YANS_WIFI_ALLOC_STAGE (PACKET_COPY);
+              copy = packet->Copy ();
+            }
+          YANS_WIFI_ALLOC_STAGE (RECEIVE_EVENT);
+          Simulator::ScheduleWithContext (dstNode, delay,
+                                          new ReceiveEvent (this, j, copy, parameters));
+        }
+    }
+}
+
+void
+YansWifiChannel::Receive (uint32_t i, Ptr<const Packet> packet, struct Parameters parameters) const
+{
+  YANS_WIFI_PROFILE_SCOPE (CHANNEL_RECEIVE);
+  m_phyList[i]->StartReceivePreambleAndHeader (packet, parameters); //--------change here
+}
+
+void
+YansWifiChannel::ReceiveEnergy (uint32_t i, uint32_t size, struct Parameters parameters) const
+{
+  YANS_WIFI_PROFILE_SCOPE (CHANNEL_RECEIVE);
+  m_phyList[i]->StartReceiveEnergy (size, parameters);
+}
+
+uint32_t
+YansWifiChannel::GetNDevices (void) const
+{
+  return m_phyList.size ();
+}
+
+Ptr<NetDevice>
+YansWifiChannel::GetDevice (uint32_t i) const
+{
+  return m_phyList[i]->GetDevice ()->GetObject<NetDevice> ();
+}
+
+void
+YansWifiChannel::RecordSkippedReception (uint32_t i, Ptr<const Packet> packet, struct Parameters parameters, Time arrival) const
+{
+  std::deque<SkippedReception> &skipped = m_skipped[i];
+  Time now = Simulator::Now ();
+  while (!skipped.empty () && skipped.front ().arrival + skipped.front ().parameters.duration <= now)
+    {
+      skipped.pop_front ();
+    }
+  SkippedReception reception;
+  reception.packet = packet;
+  reception.parameters = parameters;
+  reception.arrival = arrival;
+  skipped.push_back (reception);
+}
+
+void
+YansWifiChannel::NotifySleep (Ptr<YansWifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  PhyIndex::const_iterator it = m_phyIndex.find (phy);
+  NS_ASSERT (it != m_phyIndex.end ());
+  m_asleep[it->second] = true;
+}
+
+void
+YansWifiChannel::NotifyWakeup (Ptr<YansWifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  PhyIndex::const_iterator it = m_phyIndex.find (phy);
+  NS_ASSERT (it != m_phyIndex.end ());
+  uint32_t j = it->second;
+  if (!m_asleep[j])
+    {
+      return;
+    }
+  m_asleep[j] = false;
+  //the signals still to arrive are delivered below, they are not dropped
+  phy->CancelSkippedReceptions (YansWifiPhy::DROP_SLEEP);
+
+  Time now = Simulator::Now ();
+  bool setModifs = (phy->GetReceptionPolicy () != YansWifiPhy::RECEPTION_CO_CHANNEL);
+  std::deque<SkippedReception> &skipped = m_skipped[j];
+  for (std::deque<SkippedReception>::const_iterator k = skipped.begin (); k != skipped.end (); k++)
+    {
+      const struct Parameters &parameters = k->parameters;
+      Time end = k->arrival + parameters.duration;
+      if (k->arrival > now)
+        {
+          //the first bit has not arrived yet: deliver it as Send would have
+          YANS_WIFI_ALLOC_STAGE (RECEIVE_EVENT);
+          if (m_energyOnlyDelivery && setModifs
+              && !phy->CanSync (parameters.channelFrequency, parameters.channelWidth))
+            {
+              Simulator::ScheduleWithContext (GetNodeId (j), k->arrival - now,
+                                              new ReceiveEnergyEvent (this, j, k->packet->GetSize (), parameters));
+            }
+          else
+            {
+              Simulator::ScheduleWithContext (GetNodeId (j), k->arrival - now,
+                                              new ReceiveEvent (this, j, k->packet, parameters));
+            }
+        }
+      else if (end > now)
+        {
+          //still on the air: only its energy is left to be sensed
+          phy->AddInterference (k->packet->GetSize (), parameters, end - now);
+        }
+    }
+  skipped.clear ();
+}
+
+void
+YansWifiChannel::SaveState (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  std::streamsize precision = os.precision (17);
+  os << "channel " << m_phyList.size () << "\n";
+
+  std::ostringstream links;
+  uint32_t nLinks = 0;
+  links.precision (17);
+  for (std::map<uint64_t, struct LinkLoss>::const_iterator it = m_linkLoss.begin (); it != m_linkLoss.end (); it++)
+    {
+      //the links reused by distance are computed again after a restore, as the odometers are not saved
+      if (it->second.expires > now && it->second.distance <= 0)
+        {
+          links << (it->first >> 32) << " " << (it->first & 0xffffffff) << " "
+                << (it->second.expires - now).GetNanoSeconds () << " " << it->second.lossDb << "\n";
+          nLinks++;
+        }
+    }
+  os << "links " << nLinks << "\n" << links.str ();
+
+  std::ostringstream skipped;
+  uint32_t nSkipped = 0;
+  skipped.precision (17);
+  for (uint32_t i = 0; i < m_skipped.size (); i++)
+    {
+      for (std::deque<SkippedReception>::const_iterator k = m_skipped[i].begin (); k != m_skipped[i].end (); k++)
+        {
+          const struct Parameters &parameters = k->parameters;
+          Time end = k->arrival + parameters.duration;
+          if (end <= now)
+            {
+              continue;
+            }
+          //only the energy of the signal is needed when the PHY wakes up
+          Time start = std::max (k->arrival, now);
+          skipped << i << " " << (end - start).GetNanoSeconds () << " " << k->packet->GetSize ()
+                  << " " << parameters.rxPowerDbm << " " << static_cast<uint32_t> (parameters.preamble)
+                  << " " << parameters.nSubchannels;
+          for (uint32_t n = 0; n < parameters.nSubchannels; n++)
+            {
+              skipped << " " << parameters.subchannelRxPowerDbm[n];
+            }
+          skipped << "\n";
+          nSkipped++;
+        }
+    }
+  os << "skipped " << nSkipped << "\n" << skipped.str ();
+
+  os << "farfield " << m_farFieldStats.nearLinks << " " << m_farFieldStats.farLinks
+     << " " << m_farFieldStats.validatedLinks << " " << m_farFieldStats.sumErrorDb
+     << " " << m_farFieldStats.sumSquaredErrorDb << " " << m_farFieldStats.maxAbsErrorDb
+     << " " << m_farFieldStats.exactPowerW << " " << m_farFieldStats.approxPowerW << "\n";
+  os.precision (precision);
+
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+    {
+      (*i)->SaveState (os);
+    }
+}
+
+void
+YansWifiChannel::RestoreState (std::istream &is)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  std::string tag;
+  uint32_t nPhys;
+  is >> tag >> nPhys;
+  NS_ABORT_MSG_IF (!is || tag != "channel", "Malformed YansWifiChannel state record");
+  NS_ABORT_MSG_IF (nPhys != m_phyList.size (), "The saved channel has " << nPhys << " PHYs, this one "
+                   << m_phyList.size ());
+
+  uint32_t nLinks;
+  is >> tag >> nLinks;
+  NS_ABORT_MSG_IF (!is || tag != "links", "Malformed YansWifiChannel link record");
+  m_linkLoss.clear ();
+  for (uint32_t k = 0; k < nLinks; k++)
+    {
+      uint32_t i;
+      uint32_t j;
+      int64_t remaining;
+      double lossDb;
+      is >> i >> j >> remaining >> lossDb;
+      NS_ABORT_MSG_IF (!is || i >= nPhys || j >= nPhys, "Malformed YansWifiChannel link record");
+      struct LinkLoss &link = m_linkLoss[(static_cast<uint64_t> (i) << 32) | j];
+      link.expires = now + NanoSeconds (remaining);
+      link.lossDb = lossDb;
+      link.gain = std::pow (10.0, lossDb / 10);
+      link.distance = 0.0;
+      link.firstOdometer = 0.0;
+      link.secondOdometer = 0.0;
+      //the course changes seen so far, if the channel already follows them
+      link.firstCourse = (i < m_motion.size ()) ? m_motion[i].courseChanges : 0;
+      link.secondCourse = (j < m_motion.size ()) ? m_motion[j].courseChanges : 0;
+    }
+  m_linkSweepSize = std::max<std::size_t> (512, m_linkLoss.size ());
+
+  uint32_t nSkipped;
+  is >> tag >> nSkipped;
+  NS_ABORT_MSG_IF (!is || tag != "skipped", "Malformed YansWifiChannel skipped signal record");
+  std::vector<std::pair<uint32_t, SkippedReception> > skipped;
+  for (uint32_t k = 0; k < nSkipped; k++)
+    {
+      uint32_t i;
+      int64_t remaining;
+      uint32_t size;
+      uint32_t preamble;
+      struct Parameters parameters;
+      is >> i >> remaining >> size >> parameters.rxPowerDbm >> preamble >> parameters.nSubchannels;
+      NS_ABORT_MSG_IF (!is || i >= nPhys || parameters.nSubchannels > Parameters::MAX_SUBCHANNELS,
+                       "Malformed YansWifiChannel skipped signal record");
+      for (uint32_t n = 0; n < parameters.nSubchannels; n++)
+        {
+          is >> parameters.subchannelRxPowerDbm[n];
+        }
+      parameters.rxPowerW = 0.0;
+      parameters.type = NORMAL_MPDU;
+      parameters.duration = NanoSeconds (remaining);
+      parameters.preamble = static_cast<enum WifiPreamble> (preamble);
+      parameters.channelFrequency = 0;
+      parameters.channelWidth = 0;
+      parameters.senderId = 0xffffffff;
+      parameters.overlapFactorDb = 0.0;
+      SkippedReception reception;
+      reception.packet = Create<Packet> (size);
+      reception.parameters = parameters;
+      //already on the air: NotifyWakeup only adds its energy
+      reception.arrival = now;
+      skipped.push_back (std::make_pair (i, reception));
+    }
+
+  is >> tag >> m_farFieldStats.nearLinks >> m_farFieldStats.farLinks >> m_farFieldStats.validatedLinks
+  >> m_farFieldStats.sumErrorDb >> m_farFieldStats.sumSquaredErrorDb >> m_farFieldStats.maxAbsErrorDb
+  >> m_farFieldStats.exactPowerW >> m_farFieldStats.approxPowerW;
+  NS_ABORT_MSG_IF (!is || tag != "farfield", "Malformed YansWifiChannel far-field record");
+
+  //sleeping PHYs notify the channel, which must then hold their skipped signals
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+    {
+      (*i)->RestoreState (is);
+    }
+  for (uint32_t i = 0; i < m_skipped.size (); i++)
+    {
+      m_skipped[i].clear ();
+    }
+  for (std::vector<std::pair<uint32_t, SkippedReception> >::const_iterator k = skipped.begin (); k != skipped.end (); k++)
+    {
+      if (m_asleep[k->first])
+        {
+          m_skipped[k->first].push_back (k->second);
+        }
+      else
+        {
+          m_phyList[k->first]->AddInterference (k->second.packet->GetSize (), k->second.parameters,
+                                                k->second.parameters.duration);
+        }
+    }
+}
+
+uint32_t
+YansWifiChannel::GetNodeId (uint32_t i) const
+{
+  if (m_nodeIds[i] == 0xffffffff)
+    {
+      Ptr<Object> dstNetDevice = m_phyList[i]->GetDevice ();
+      if (dstNetDevice != 0)
+        {
+          m_nodeIds[i] = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+        }
+    }
+  return m_nodeIds[i];
+}
+
+void
+YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  m_phyIndex[phy] = m_phyList.size ();
+  m_phyList.push_back (phy);
+  m_nodeIds.push_back (0xffffffff);
+  m_asleep.push_back (false);
+  m_skipped.push_back (std::deque<SkippedReception> ());
+  m_phyMaskSet.push_back (0);
+  m_phyConfig.push_back (0xffffffff);
+  if (phy->GetFrequency () != 0)
+    {
+      //precompute the overlap factors with the PHYs already connected
+      GetPhyConfig (m_phyList.size () - 1);
+    }
+}
+
+void
+YansWifiChannel::Reserve (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_phyList.reserve (n);
+  m_nodeIds.reserve (n);
+  m_asleep.reserve (n);
+  m_skipped.reserve (n);
+  m_phyMaskSet.reserve (n);
+  m_phyConfig.reserve (n);
+}
+
+void
+YansWifiChannel::AddAll (const std::vector<Ptr<YansWifiPhy> > &phys)
+{
+  NS_LOG_FUNCTION (this << phys.size ());
+  uint32_t first = m_phyList.size ();
+  Reserve (first + phys.size ());
+  for (std::vector<Ptr<YansWifiPhy> >::const_iterator i = phys.begin (); i != phys.end (); i++)
+    {
+      //SetChannel calls back into Add
+      (*i)->SetChannel (this);
+    }
+  for (uint32_t j = first; j < m_phyList.size (); j++)
+    {
+      GetNodeId (j);
+    }
+}
+
+void
+YansWifiChannel::ApplyTopologyRecord (uint32_t i, Vector position, uint32_t frequency, uint32_t width)
+{
+  Ptr<YansWifiPhy> phy = m_phyList[i];
+  Ptr<Object> object = phy->GetMobility ();
+  NS_ABORT_MSG_IF (object == 0, "PHY " << i << " has no mobility object to place");
+  Ptr<MobilityModel> mobility = object->GetObject<MobilityModel> ();
+  if (mobility == 0)
+    {
+      mobility = CreateObject<ConstantPositionMobilityModel> ();
+      object->AggregateObject (mobility);
+    }
+  mobility->SetPosition (position);
+  if (width != 0)
+    {
+      phy->SetChannelWidth (width);
+    }
+  if (frequency != 0)
+    {
+      phy->SetFrequency (frequency);
+    }
+}
+
+uint32_t
+YansWifiChannel::LoadTopology (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!is.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open topology file " << filename);
+    }
+
+  uint32_t applied = 0;
+  char magic[4];
+  is.read (magic, 4);
+  if (is.gcount () == 4 && std::string (magic, 4) == "YWTP")
+    {
+      uint32_t count;
+      is.read (reinterpret_cast<char *> (&count), sizeof (count));
+      NS_ABORT_MSG_IF (!is, "Truncated topology file " << filename);
+      NS_ABORT_MSG_IF (count > m_phyList.size (), "Topology file " << filename << " has " << count <<
+                       " records but only " << m_phyList.size () << " PHYs are connected");
+      for (; applied < count; applied++)
+        {
+          double xyz[3];
+          uint32_t fw[2];
+          is.read (reinterpret_cast<char *> (xyz), sizeof (xyz));
+          is.read (reinterpret_cast<char *> (fw), sizeof (fw));
+          NS_ABORT_MSG_IF (!is, "Truncated topology file " << filename << " at record " << applied);
+          ApplyTopologyRecord (applied, Vector (xyz[0], xyz[1], xyz[2]), fw[0], fw[1]);
+        }
+    }
+  else
+    {
+      is.clear ();
+      is.seekg (0);
+      std::string line;
+      while (std::getline (is, line))
+        {
+          if (line.empty () || line[0] == '#')
+            {
+              continue;
+            }
+          std::replace (line.begin (), line.end (), ',', ' ');
+          std::istringstream record (line);
+          double x, y, z;
+          uint32_t frequency, width;
+          if (!(record >> x >> y >> z >> frequency >> width))
+            {
+              NS_FATAL_ERROR ("Malformed record \"" << line << "\" in topology file " << filename);
+            }
+          NS_ABORT_MSG_IF (applied >= m_phyList.size (), "Topology file " << filename <<
+                           " has more records than the " << m_phyList.size () << " connected PHYs");
+          ApplyTopologyRecord (applied, Vector (x, y, z), frequency, width);
+          applied++;
+        }
+    }
+  m_linkLoss.clear ();
+  NS_LOG_DEBUG ("applied " << applied << " topology records from " << filename);
+  return applied;
+}
+
+int64_t
+YansWifiChannel::AssignStreams (int64_t stream)
+{
+  int64_t currentStream = stream;
+  currentStream += m_loss->AssignStreams (stream);
+  currentStream += m_delay->AssignStreams (currentStream);
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+    {
+      currentStream += (*i)->AssignStreams (currentStream);
+    }
   return (currentStream - stream);
 }
 
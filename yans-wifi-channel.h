@@ -53,6 +53,11 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <ostream>
+#include <istream>
 #include <stdint.h>
 #include "ns3/packet.h"
 #include "wifi-channel.h"
@@ -60,24 +65,17 @@
 #include "wifi-preamble.h"
 #include "wifi-tx-vector.h"
 #include "yans-wifi-phy.h"
+#include "yans-wifi-sensor.h"
 #include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/output-stream-wrapper.h"
 
 namespace ns3 {
 
 class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
-
-struct Parameters
-{
-  double rxPowerDbm;
-  enum mpduType type;
-  Time duration;
-  WifiTxVector txVector;
-  WifiPreamble preamble;
-  uint32_t channelFrequency; //----------change
-  uint32_t channelWidth; //-------------change
-};
+class MobilityModel;
 
 /**
  * \brief A Yans wifi channel
@@ -110,10 +108,173 @@ public:
    */
   void Add (Ptr<YansWifiPhy> phy);
 
+  /**
+   * Reserve storage for the given total number of PHYs so that subsequent
+   * calls to Add do not reallocate the PHY list and the channel-side indexes.
+   *
+   * \param n the total number of PHYs expected on this channel
+   */
+  void Reserve (uint32_t n);
+
+  /**
+   * Connect all the given YansWifiPhys to this channel in one pass.
+   * Storage is reserved up front and the channel-side indexes
+   * (PHY index and receiver node ids) are built for the whole batch.
+   *
+   * \param phys the YansWifiPhys to be connected to this channel
+   */
+  void AddAll (const std::vector<Ptr<YansWifiPhy> > &phys);
+
+  /**
+   * Attach a passive spectrum sensor to the channel. Sensors are not
+   * devices of the channel: they get the energy of every transmission
+   * but no packet and no event, see YansWifiSensor. The sensors do not
+   * use the propagation loss model of the PHYs, so that they do not draw
+   * from its random streams: their rx power is given by the mean
+   * log-distance loss of the FarFieldExponent and FarFieldReferenceLoss
+   * attributes, or by SetSensorPropagationLossModel.
+   *
+   * \param sensor the YansWifiSensor, with its mobility model set
+   */
+  void AddSensor (Ptr<YansWifiSensor> sensor);
+  /**
+   * \return the number of sensors attached to the channel
+   */
+  uint32_t GetNSensors (void) const;
+  /**
+   * \param i the index of the sensor, in attachment order
+   *
+   * \return the sensor
+   */
+  Ptr<YansWifiSensor> GetSensor (uint32_t i) const;
+  /**
+   * Write the energy received by the sensors since the previous sample
+   * to a CSV file for each interval of simulated time, one
+   * "time,sensor,frequency,energy" row per sensor and 20 MHz subchannel
+   * that received energy, sensor being the index of the sensor and
+   * energy in J. As the samples are scheduled periodically, the
+   * simulation has to be ended with Simulator::Stop.
+   *
+   * \param filename the name of the CSV file
+   * \param interval the sampling interval
+   */
+  void EnableSensorReport (std::string filename, Time interval = MilliSeconds (100));
+
+  /**
+   * Notify the channel that the given PHY entered SLEEP state. Until
+   * NotifyWakeup is called, the channel does not deliver packets to it.
+   *
+   * \param phy the YansWifiPhy that went to sleep
+   */
+  void NotifySleep (Ptr<YansWifiPhy> phy);
+  /**
+   * Notify the channel that the given PHY resumed from SLEEP state.
+   * Signals sent while the PHY was asleep and still on the air are
+   * handed over to the PHY so that its CCA state is correct. Those
+   * whose first bit has not arrived yet are delivered as Send would
+   * have delivered them, and are not counted as dropped.
+   *
+   * \param phy the YansWifiPhy that woke up
+   */
+  void NotifyWakeup (Ptr<YansWifiPhy> phy);
+
+  /**
+   * Load the position, central frequency and channel width of the PHYs
+   * connected to this channel from a topology file. Record i of the file
+   * is applied to the i-th PHY in registration order. The file is read
+   * as a stream, record by record.
+   *
+   * Two formats are supported:
+   *  - CSV: one "x,y,z,frequency,width" record per line, lines starting
+   *    with '#' are ignored;
+   *  - binary: the 4-byte magic "YWTP", a uint32_t record count and then
+   *    packed records of three doubles (x, y, z) followed by two uint32_t
+   *    (frequency in MHz, width in MHz), all in host byte order.
+   *
+   * A frequency or width of 0 leaves the corresponding PHY setting
+   * unchanged. If the node of a PHY has no MobilityModel yet, a
+   * ConstantPositionMobilityModel is aggregated to it.
+   *
+   * \param filename the name of the topology file
+   *
+   * \return the number of records applied
+   */
+  uint32_t LoadTopology (std::string filename);
+
+  /**
+   * Write the state of the channel and of its PHYs as text records: the
+   * number of PHYs, the cached link losses (see FadingCoherenceTime, the
+   * links reused with LinkRefreshTolerance are not written),
+   * the signals not delivered to sleeping PHYs, the far-field statistics
+   * and then the state of each PHY in registration order (see
+   * YansWifiPhy::SaveState). Times are relative to the current time.
+   *
+   * \param os the output stream
+   */
+  void SaveState (std::ostream &os) const;
+  /**
+   * Restore a state written by SaveState at the current simulation time
+   * into this channel, which must have the same number of PHYs connected
+   * in the same order. The overlap factors are not part of the state:
+   * they are computed again from the configurations of the PHYs.
+   *
+   * \param is the input stream
+   */
+  void RestoreState (std::istream &is);
+
+  /**
+   * A spectrum mask: breakpoints of a piecewise linear power spectral
+   * density, as offsets from the central frequency.
+   */
+  struct SpectrumMask
+  {
+    std::vector<double> offsetMhz;  //!< offsets from the central frequency in MHz, increasing
+    std::vector<double> psd;        //!< linear power spectral density relative to the in-band level
+  };
+
+  /**
+   * \param width the channel width in MHz
+   *
+   * \return the 802.11ac spectrum mask for the given width (the 20 MHz
+   *         mask scaled to the width for widths other than 20, 40, 80 and 160 MHz)
+   */
+  static SpectrumMask GetStandardMask (uint32_t width);
+
+  /**
+   * Use the masks of the given files for the given PHY, both when it
+   * transmits and when it receives, instead of the ones set by the
+   * TxMaskFile and RxMaskFile attributes. The files have the same format
+   * as these attributes. The overlap factors with the other PHYs are
+   * computed once per pair of distinct mask sets and channel
+   * configurations, not per packet.
+   *
+   * \param phy the YansWifiPhy, already connected to this channel
+   * \param txMaskFile the transmit mask file (empty for the 802.11ac mask)
+   * \param rxMaskFile the receive filter file (empty for the 802.11ac mask)
+   */
+  void SetSpectrumMasks (Ptr<YansWifiPhy> phy, std::string txMaskFile, std::string rxMaskFile);
+  /**
+   * \param sender the transmitting YansWifiPhy
+   * \param receiver the receiving YansWifiPhy
+   *
+   * \return the overlap factor in dB applied to the signals from sender
+   *         to receiver with their current channel configuration
+   */
+  double GetOverlapFactorDb (Ptr<YansWifiPhy> sender, Ptr<YansWifiPhy> receiver) const;
+
   /**
    * \param loss the new propagation loss model.
    */
   void SetPropagationLossModel (Ptr<PropagationLossModel> loss);
+  /**
+   * Use a propagation loss model of their own for the sensors instead of
+   * the mean log-distance loss. Its random variables, if any, are not
+   * assigned by AssignStreams: assign them on the model itself, so that
+   * adding sensors does not change the streams of the PHYs.
+   *
+   * \param loss the propagation loss model of the sensors, 0 for the mean log-distance loss
+   */
+  void SetSensorPropagationLossModel (Ptr<PropagationLossModel> loss);
   /**
    * \param delay the new propagation delay model.
    */
@@ -141,12 +302,113 @@ public:
    * used by this model.  Return the number of streams (possibly zero) that
    * have been assigned.
    *
+   * The streams are assigned, in this order, to the propagation loss
+   * model chain, the propagation delay model and the PHYs connected to
+   * the channel (the PLCP and payload success draws), so that one call
+   * covers all the random variables of the reception path. A later call
+   * to WifiHelper::AssignStreams overrides the streams of the PHYs.
+   *
    * \param stream first stream index to use
    *
    * \return the number of stream indices assigned by this model
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * Statistics of the far-field approximation, see the NearRadius attribute.
+   * The errors are only accumulated when ValidateFarField is set.
+   */
+  struct FarFieldStatistics
+  {
+    uint64_t nearLinks;        //!< number of signals computed with the loss model
+    uint64_t farLinks;         //!< number of signals computed with the far-field table
+    uint64_t validatedLinks;   //!< number of far-field signals also computed with the loss model
+    double sumErrorDb;         //!< sum of the approximate minus the exact rx power in dB
+    double sumSquaredErrorDb;  //!< sum of the squared errors in dB
+    double maxAbsErrorDb;      //!< largest absolute error in dB
+    double exactPowerW;        //!< sum of the exact rx powers, including the overlap factor, in W
+    double approxPowerW;       //!< sum of the approximate rx powers, including the overlap factor, in W
+  };
+
+  /**
+   * \return the statistics of the far-field approximation since the
+   *         creation of the channel or the last reset
+   */
+  const struct FarFieldStatistics & GetFarFieldStatistics (void) const;
+  /**
+   * Reset the statistics of the far-field approximation.
+   */
+  void ResetFarFieldStatistics (void);
+  /**
+   * Print the statistics of the far-field approximation: the number of
+   * near and far signals and, in validation mode, the mean, RMS and
+   * maximum error in dB and the relative error of the aggregate
+   * interference power of the far receivers.
+   *
+   * \param os the output stream
+   */
+  void PrintFarFieldStatistics (std::ostream &os) const;
+
+  /**
+   * Counters of the fan-out of the transmissions to the receivers, for
+   * progress reports.
+   */
+  struct FanOutStatistics
+  {
+    uint64_t sends;            //!< number of calls to Send
+    uint64_t receivers;        //!< number of receivers visited by Send
+    uint64_t overlapLookups;   //!< number of overlap factors read from the precomputed table
+    uint64_t overlapComputed;  //!< number of overlap factors computed for new configurations
+    uint64_t linkLookups;      //!< number of links looked up in the link loss cache
+    uint64_t linkHits;         //!< number of links whose cached loss was reused
+  };
+
+  /**
+   * \return the fan-out counters since the creation of the channel
+   */
+  const struct FanOutStatistics & GetFanOutStatistics (void) const;
+
+  /**
+   * Write the occupancy accounted since the previous sample to a CSV file
+   * for each interval of simulated time, one "time,kind,frequency,width,value"
+   * row per non-zero value:
+   *  - kind "airtime": the sum of the durations of the transmissions on the
+   *    given central frequency and width started in the interval, in s;
+   *  - kind "txenergy": the transmit energy of the transmissions started in
+   *    the interval times the share of their spectrum mask that falls into
+   *    the 20 MHz subchannel centered on the given frequency, in J. There
+   *    is no propagation loss: this is what the senders put on the
+   *    subchannel, not what any receiver sees (see YansWifiSensor for that).
+   * The subchannels are the 20 MHz subchannels of all the channel
+   * configurations seen so far. The accounting is enabled from now on if
+   * the OccupancyAccounting attribute is false. As the samples are scheduled
+   * periodically, the simulation has to be ended with Simulator::Stop.
+   *
+   * \param filename the name of the CSV file
+   * \param interval the sampling interval
+   */
+  void EnableOccupancyReport (std::string filename, Time interval = MilliSeconds (100));
+  /**
+   * \param frequency the central frequency in MHz
+   * \param width the channel width in MHz
+   *
+   * \return the sum of the durations of all the transmissions sent on the
+   *         channel with the given central frequency and width while the
+   *         occupancy was accounted
+   */
+  Time GetAirtime (uint32_t frequency, uint32_t width) const;
+  /**
+   * \param frequency the central frequency of a 20 MHz subchannel in MHz
+   *
+   * \return the transmit energy in J of all the transmissions sent on the
+   *         channel while the occupancy was accounted, times the share of
+   *         their spectrum mask in the subchannel, without propagation loss
+   */
+  double GetSubchannelTxEnergy (uint32_t frequency) const;
+
+protected:
+  virtual void DoDispose (void);
+
 
 private:
   /**
@@ -160,15 +422,491 @@ private:
    * bit of the packet has arrived.
    *
    * \param i index of the corresponding YansWifiPhy in the PHY list
+   * \param packet the packet being sent, shared by all the receivers
+   * \param parameters the reception parameters
+   */
+  void Receive (uint32_t i, Ptr<const Packet> packet, struct Parameters parameters) const;
+
+  /**
+   * This method is scheduled by Send for each associated YansWifiPhy that
+   * cannot synchronize on the signal, see the EnergyOnlyDelivery attribute.
+   *
+   * \param i index of the corresponding YansWifiPhy in the PHY list
+   * \param size the size of the packet in bytes
+   * \param parameters the reception parameters
+   */
+  void ReceiveEnergy (uint32_t i, uint32_t size, struct Parameters parameters) const;
+
+  class ReceiveEvent;
+  friend class ReceiveEvent;
+  class ReceiveEnergyEvent;
+  friend class ReceiveEnergyEvent;
+
+  /**
+   * The propagation loss of a link, cached for the fading coherence time
+   * and until either PHY changes course or, with LinkRefreshTolerance, as
+   * long as the PHYs did not move enough to change it by more than the
+   * tolerance.
+   */
+  struct LinkLoss
+  {
+    Time expires;            //!< the time until which lossDb can be reused
+    double lossDb;           //!< rx power minus tx power in dB
+    double gain;             //!< lossDb as a linear factor, 0 if not computed
+    Time delay;              //!< the propagation delay
+    double distance;         //!< the distance when lossDb was computed, 0 if unknown or without LinkRefreshTolerance
+    double firstOdometer;    //!< odometer of the PHY with the lower index when lossDb was computed
+    double secondOdometer;   //!< odometer of the PHY with the higher index when lossDb was computed
+    uint32_t firstCourse;    //!< course changes of the PHY with the lower index when lossDb was computed
+    uint32_t secondCourse;   //!< course changes of the PHY with the higher index when lossDb was computed
+  };
+
+  /**
+   * The motion of a PHY, updated on each course change of its mobility model.
+   */
+  struct Motion
+  {
+    Vector position;         //!< the position at the last course change
+    double speed;            //!< the speed since the last course change in m/s
+    Time time;               //!< the time of the last course change
+    double odometer;         //!< the distance traveled until the last course change in m
+    Ptr<MobilityModel> mobility; //!< the mobility model whose CourseChange trace is connected, 0 if none
+    uint32_t courseChanges;  //!< number of course changes since the trace was connected
+  };
+
+  /**
+   * Compute the rx power and the delay of a link with the propagation
+   * loss and delay models, or reuse the loss computed on the same link,
+   * in either direction: less than FadingCoherenceTime ago and with no
+   * course change of either PHY since then or, with LinkRefreshTolerance,
+   * as long as the PHYs did not move enough since it was computed to
+   * change it by more than the tolerance, within LinkRefreshMaxAge if
+   * set. The delay is then reused as well.
+   *
+   * \param txPowerDbm the tx power in dBm
+   * \param senderMobility the mobility model of the sender
+   * \param receiverMobility the mobility model of the receiver
+   * \param sender index of the sender in the PHY list, 0xffffffff if it is not connected
+   * \param receiver index of the receiver in the PHY list
+   * \param delay the propagation delay of the link
+   * \param gain the rx power over the tx power as a linear factor, only
+   *        set with LinearPowerPipeline
+   *
+   * \return the rx power in dBm
+   */
+  double CalcRxPower (double txPowerDbm, Ptr<MobilityModel> senderMobility, Ptr<MobilityModel> receiverMobility,
+                      uint32_t sender, uint32_t receiver, Time &delay, double &gain) const;
+  /**
+   * \param i index of the corresponding YansWifiPhy in the PHY list
+   * \param mobility the mobility model of the PHY
+   *
+   * \return the motion of the PHY, connecting the channel to its
+   *         CourseChange trace on first use
+   */
+  struct Motion &GetMotion (uint32_t i, Ptr<MobilityModel> mobility) const;
+  /**
+   * \param i index of the corresponding YansWifiPhy in the PHY list
+   * \param mobility the mobility model of the PHY
+   *
+   * \return an upper bound of the distance traveled by the PHY since the
+   *         channel started following its course changes
+   */
+  double GetOdometer (uint32_t i, Ptr<MobilityModel> mobility) const;
+  /**
+   * \param first index of the PHY of the link with the lower index
+   * \param second index of the PHY of the link with the higher index
+   * \param link the cached link, computed with LinkRefreshTolerance
+   *
+   * \return whether the PHYs did not move enough since the link was
+   *         computed to change its loss by more than the tolerance
+   */
+  bool IsLinkWithinTolerance (uint32_t first, uint32_t second, const struct LinkLoss &link) const;
+  /**
+   * Forget the cached links that expired or, with LinkRefreshTolerance,
+   * whose distance bound no longer holds, so that the cache only holds
+   * the links that can still be reused.
+   */
+  void SweepLinks (void) const;
+  /**
+   * Update the motion of a PHY. Connected to the CourseChange trace of its mobility model.
+   *
+   * \param context the index of the PHY in the PHY list
+   * \param mobility the mobility model
+   */
+  void NotifyCourseChange (std::string context, Ptr<const MobilityModel> mobility) const;
+  /**
+   * \param tolerance the largest loss change in dB for which a link is not computed again
+   */
+  void SetLinkRefreshTolerance (double tolerance);
+  /**
+   * \return the largest loss change in dB for which a link is not computed again
+   */
+  double GetLinkRefreshTolerance (void) const;
+  /**
+   * \param exponent the path loss exponent used to bound the loss change
+   */
+  void SetLinkRefreshExponent (double exponent);
+  /**
+   * \return the path loss exponent used to bound the loss change
+   */
+  double GetLinkRefreshExponent (void) const;
+  /**
+   * \param maxAge the time after which a link reused with the tolerance is computed again, 0 for none
+   */
+  void SetLinkRefreshMaxAge (Time maxAge);
+  /**
+   * \return the time after which a link reused with the tolerance is computed again, 0 for none
+   */
+  Time GetLinkRefreshMaxAge (void) const;
+  /**
+   * \param enable whether the rx power is also handed to the PHYs in W
+   */
+  void SetLinearPowerPipeline (bool enable);
+  /**
+   * \return whether the rx power is also handed to the PHYs in W
+   */
+  bool GetLinearPowerPipeline (void) const;
+  /**
+   * \param distance the distance between the sender and the receiver in m,
+   *        larger than NearRadius
+   *
+   * \return the loss of the far-field log-distance model in dB, read from
+   *         the table of the distance bin, or computed for the bin if it
+   *         is out of the table
+   */
+  double GetFarFieldLossDb (double distance) const;
+  /**
+   * \param distance the distance between the sender and the receiver in m,
+   *        larger than NearRadius
+   *
+   * \return the loss of the far-field log-distance model as a linear gain,
+   *         read from the table of the distance bin, or computed for the bin
+   *         if it is out of the table
+   */
+  double GetFarFieldGain (double distance) const;
+  /**
+   * \param bin the distance bin
+   *
+   * \return the far-field loss in dB at the center of the bin
+   */
+  double ComputeFarFieldLossDb (uint64_t bin) const;
+  /**
+   * \param distance the distance between the sender and the receiver in m
+   *
+   * \return the loss of the far-field log-distance model in dB at that
+   *         exact distance, without randomness
+   */
+  double GetMeanLossDb (double distance) const;
+  /**
+   * \param distance the distance between the sender and the receiver in m
+   *
+   * \return the index of the distance in the far-field table, or -1 if it
+   *         is out of the table, which is extended on use up to
+   *         MAX_FAR_FIELD_BINS bins beyond the bin of NearRadius
+   */
+  int32_t GetFarFieldIndex (double distance) const;
+  /**
+   * Account the error of the far-field approximation of one signal.
+   *
+   * \param exactDbm the rx power computed with the loss model in dBm
+   * \param approxDbm the rx power computed with the far-field table in dBm
+   */
+  void RecordFarFieldError (double exactDbm, double approxDbm) const;
+  /**
+   * \param exponent the path loss exponent of the far-field model
+   */
+  void SetFarFieldExponent (double exponent);
+  /**
+   * \return the path loss exponent of the far-field model
+   */
+  double GetFarFieldExponent (void) const;
+  /**
+   * \param loss the loss of the far-field model at 1 m in dB
+   */
+  void SetFarFieldReferenceLoss (double loss);
+  /**
+   * \return the loss of the far-field model at 1 m in dB
+   */
+  double GetFarFieldReferenceLoss (void) const;
+  /**
+   * \param width the width of the distance bins of the far-field table in m
+   */
+  void SetFarFieldBinWidth (double width);
+  /**
+   * \return the width of the distance bins of the far-field table in m
+   */
+  double GetFarFieldBinWidth (void) const;
+  /**
+   * \param coherenceTime the fading coherence time, zero to disable the cache unless LinkRefreshTolerance is set
+   */
+  void SetFadingCoherenceTime (Time coherenceTime);
+  /**
+   * \return the fading coherence time
+   */
+  Time GetFadingCoherenceTime (void) const;
+
+  /**
+   * Return the id of the node of the i-th PHY, resolving and caching it
+   * on first use.
+   *
+   * \param i index of the corresponding YansWifiPhy in the PHY list
+   *
+   * \return the node id, or 0xffffffff if the PHY has no device yet
+   */
+  uint32_t GetNodeId (uint32_t i) const;
+
+  /**
+   * Apply one topology record to the i-th PHY.
+   *
+   * \param i index of the corresponding YansWifiPhy in the PHY list
+   * \param position the position of the PHY
+   * \param frequency the central frequency in MHz (0 to keep the current one)
+   * \param width the channel width in MHz (0 to keep the current one)
+   */
+  void ApplyTopologyRecord (uint32_t i, Vector position, uint32_t frequency, uint32_t width);
+
+  /**
+   * A signal that was not delivered to a sleeping PHY.
+   */
+  struct SkippedReception
+  {
+    Ptr<const Packet> packet;      //!< the packet, not copied
+    struct Parameters parameters;  //!< the reception parameters
+    Time arrival;                  //!< the arrival time of the first bit
+  };
+
+  /**
+   * Remember a signal that was not delivered to the sleeping i-th PHY.
+   * Signals that are already over are discarded.
+   *
+   * \param i index of the corresponding YansWifiPhy in the PHY list
    * \param packet the packet being sent
-   * \param atts a vector containing the received power in dBm and the packet type
-   * \param txVector the TXVECTOR of the packet
-   * \param preamble the type of preamble being used to send the packet
+   * \param parameters the reception parameters
+   * \param arrival the arrival time of the first bit
+   */
+  void RecordSkippedReception (uint32_t i, Ptr<const Packet> packet, struct Parameters parameters, Time arrival) const;
+
+  /**
+   * Spectrum masks by channel width.
+   */
+  typedef std::map<uint32_t, SpectrumMask> SpectrumMaskMap;
+
+  /**
+   * The transmit and receive masks of a group of PHYs.
+   */
+  struct MaskSet
+  {
+    std::string txFile;   //!< the transmit mask file
+    std::string rxFile;   //!< the receive filter file
+    SpectrumMaskMap tx;   //!< the transmit masks, completed with the standard ones on use
+    SpectrumMaskMap rx;   //!< the receive filters, completed with the standard ones on use
+  };
+
+  /**
+   * A channel configuration of a PHY as far as the overlap factor is concerned.
+   */
+  struct PhyConfig
+  {
+    uint32_t maskSet;     //!< index of the mask set in m_maskSets
+    uint32_t frequency;   //!< the central frequency in MHz
+    uint32_t width;       //!< the channel width in MHz
+  };
+
+  /**
+   * \param filename the name of the mask file, or an empty string
+   *
+   * \return the masks in the file, by channel width
+   */
+  static SpectrumMaskMap LoadSpectrumMasks (std::string filename);
+  /**
+   * \param masks the masks by channel width
+   * \param width the channel width in MHz
+   *
+   * \return the mask for the width, the standard one being added to
+   *         the map if there is none
+   */
+  static const SpectrumMask & GetMask (SpectrumMaskMap &masks, uint32_t width);
+  /**
+   * The overlap factors of a pair of configurations.
+   */
+  struct Overlap
+  {
+    double db;                 //!< overlap factor of the whole receiver channel in dB
+    double linear;             //!< overlap factor of the whole receiver channel as a linear factor
+    uint32_t nSubchannels;     //!< number of 20 MHz subchannels of the receiver
+    double subchannelDb[Parameters::MAX_SUBCHANNELS]; //!< overlap factor of each subchannel in dB, lowest first
+    double subchannelLinear[Parameters::MAX_SUBCHANNELS]; //!< overlap factor of each subchannel as a linear factor
+  };
+
+  /**
+   * \param tx the configuration of the sender
+   * \param rx the configuration of the receiver
+   *
+   * \return the overlap factors of the whole channel and of each 20 MHz
+   *         subchannel of the receiver. In the co-channel case, the whole
+   *         factor is 1 and the subchannel factors split it evenly, so that
+   *         they add up to it.
+   */
+  struct Overlap ComputeOverlap (const struct PhyConfig &tx, const struct PhyConfig &rx) const;
+  /**
+   * Return the index of a configuration, adding it and computing its
+   * overlap factors with all the known configurations if it is new.
+   *
+   * \param maskSet index of the mask set
+   * \param frequency the central frequency in MHz
+   * \param width the channel width in MHz
+   *
+   * \return the index of the configuration in m_configs
+   */
+  uint32_t RegisterConfig (uint32_t maskSet, uint32_t frequency, uint32_t width) const;
+  /**
+   * \param i index of the corresponding YansWifiPhy in the PHY list
+   *
+   * \return the index of the current configuration of the i-th PHY
+   */
+  uint32_t GetPhyConfig (uint32_t i) const;
+  /**
+   * Forget all the configurations and overlap factors.
+   */
+  void ResetOverlapTables (void);
+  /**
+   * \param txMaskFile the transmit mask file
+   * \param rxMaskFile the receive filter file
+   *
+   * \return the index of the mask set of these files, loading them if needed
+   */
+  uint32_t GetMaskSet (std::string txMaskFile, std::string rxMaskFile);
+  /**
+   * \param filename the default transmit mask file
+   */
+  void SetTxMaskFile (std::string filename);
+  /**
+   * \return the default transmit mask file
+   */
+  std::string GetTxMaskFile (void) const;
+  /**
+   * \param filename the default receive filter file
+   */
+  void SetRxMaskFile (std::string filename);
+  /**
+   * \return the default receive filter file
+   */
+  std::string GetRxMaskFile (void) const;
+
+  /**
+   * The airtime accounted on one central frequency and width.
+   */
+  struct Airtime
+  {
+    uint32_t frequency;   //!< the central frequency in MHz
+    uint32_t width;       //!< the channel width in MHz
+    Time total;           //!< the sum of the transmission durations
+    Time reported;        //!< the total at the last sample
+  };
+  /**
+   * The transmit energy accounted on one 20 MHz subchannel.
+   */
+  struct SubchannelEnergy
+  {
+    uint32_t frequency;   //!< the central frequency of the subchannel in MHz
+    double totalJ;        //!< the transmit energy in J
+    double reportedJ;     //!< the transmit energy at the last sample in J
+  };
+  /**
+   * Where the transmissions of a configuration are accounted.
+   */
+  struct OccupancyConfig
+  {
+    uint32_t airtime;                   //!< index in m_airtime, 0xffffffff if not computed yet
+    std::vector<uint32_t> subchannels;  //!< indexes in m_subchannelEnergy of the subchannels reached
+    std::vector<double> fractions;      //!< share of the transmit power seen on each of them
+  };
+
+  /**
+   * Account the airtime and the transmit energy of a transmission.
+   *
+   * \param config the configuration of the sender
+   * \param txPowerDbm the tx power in dBm
+   * \param duration the duration of the transmission
+   */
+  void RecordOccupancy (uint32_t config, double txPowerDbm, Time duration) const;
+  /**
+   * \param config the configuration of a sender
+   *
+   * \return where the transmissions of the configuration are accounted,
+   *         the subchannels of new configurations being added first
+   */
+  const struct OccupancyConfig & GetOccupancyConfig (uint32_t config) const;
+  /**
+   * Write the occupancy accounted since the last sample and schedule the next one.
+   */
+  void SampleOccupancy (void);
+  /**
+   * Add the energy of a transmission to all the sensors.
+   *
+   * \param senderMobility the mobility model of the sender
+   * \param senderConfig the configuration of the sender
+   * \param txPowerDbm the tx power in dBm
+   * \param duration the duration of the transmission
+   */
+  void DeliverToSensors (Ptr<MobilityModel> senderMobility, uint32_t senderConfig,
+                         double txPowerDbm, Time duration) const;
+  /**
+   * Write the energy received by the sensors since the last sample and schedule the next one.
+   */
+  void SampleSensors (void);
+
+  /**
+   * A map from YansWifiPhy to its index in the PHY list.
    */
-  void Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const;
+  typedef std::map<Ptr<YansWifiPhy>, uint32_t> PhyIndex;
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
+  PhyIndex m_phyIndex;                 //!< Index of each YansWifiPhy in m_phyList
+  mutable std::vector<uint32_t> m_nodeIds; //!< Cached node id of each YansWifiPhy in m_phyList
+  std::vector<bool> m_asleep;          //!< Whether each YansWifiPhy in m_phyList is in SLEEP state
+  mutable std::vector<std::deque<SkippedReception> > m_skipped; //!< Signals skipped while each YansWifiPhy sleeps
+  mutable std::vector<MaskSet> m_maskSets; //!< Mask sets, the first one being the default
+  std::vector<uint32_t> m_phyMaskSet;  //!< Mask set of each YansWifiPhy in m_phyList
+  mutable std::vector<uint32_t> m_phyConfig; //!< Last configuration of each YansWifiPhy in m_phyList
+  mutable std::vector<struct PhyConfig> m_configs; //!< Known configurations
+  mutable std::map<uint64_t, uint32_t> m_configIndex; //!< Index of each known configuration
+  mutable std::vector<std::vector<struct Overlap> > m_overlapDb; //!< Overlap factors by sender and receiver configuration
+  bool m_skipSleepingReceivers;        //!< Whether sleeping and switching receivers are skipped
+  bool m_energyOnlyDelivery;           //!< Whether receivers that cannot sync get the energy only
+  bool m_linearPowerPipeline;          //!< Whether the rx power is also handed to the PHYs in W
+  Time m_fadingCoherenceTime;          //!< Time during which the loss of a link is reused
+  mutable std::map<uint64_t, struct LinkLoss> m_linkLoss; //!< Cached link losses by lower (high 32 bits) and higher PHY index
+  mutable std::size_t m_linkSweepSize; //!< Size of m_linkLoss after the last sweep, the next one happens at twice this size
+  double m_linkRefreshTolerance;       //!< Largest loss change in dB for which a link is reused, 0 to disable it
+  double m_linkRefreshExponent;        //!< Path loss exponent used to bound the loss change
+  double m_linkRefreshFactor;          //!< Share of the distance a link can shrink by within the tolerance
+  Time m_linkRefreshMaxAge;            //!< Time after which a link reused with the tolerance is computed again, 0 for none
+  mutable std::vector<struct Motion> m_motion; //!< Motion of each YansWifiPhy in m_phyList
+  double m_nearRadius;                 //!< Distance beyond which the far-field table is used, 0 to disable it
+  double m_farFieldExponent;           //!< Path loss exponent of the far-field model
+  double m_farFieldReferenceLoss;      //!< Loss of the far-field model at 1 m in dB
+  double m_farFieldBinWidth;           //!< Width of the distance bins of the far-field table in m
+  bool m_validateFarField;             //!< Whether far-field signals are also computed with the loss model
+  static const uint32_t MAX_FAR_FIELD_BINS = 8192; //!< Largest number of bins of the far-field table
+  mutable uint64_t m_farFieldFirstBin; //!< Distance bin of the first entry of the far-field table
+  mutable std::vector<double> m_farFieldLossDb; //!< Far-field loss by distance bin from m_farFieldFirstBin, extended on use
+  mutable std::vector<double> m_farFieldGain; //!< Far-field loss by distance bin as a linear gain, extended with m_farFieldLossDb
+  mutable struct FarFieldStatistics m_farFieldStats; //!< Statistics of the far-field approximation
+  mutable struct FanOutStatistics m_fanOutStats; //!< Fan-out counters
+  mutable std::vector<struct Airtime> m_airtime; //!< Airtime by central frequency and width
+  bool m_occupancyAccounting;          //!< Whether the airtime and transmit energy are accounted in Send
+  mutable std::vector<struct SubchannelEnergy> m_subchannelEnergy; //!< Transmit energy by 20 MHz subchannel
+  mutable std::vector<struct OccupancyConfig> m_occupancyConfigs; //!< Accounting of each configuration
+  mutable uint32_t m_occupancyKnownConfigs; //!< Number of configurations whose subchannels are in m_subchannelEnergy
+  Ptr<OutputStreamWrapper> m_occupancyStream; //!< Occupancy report, 0 if disabled
+  Time m_occupancyInterval;            //!< Sampling interval of the occupancy report
+  std::vector<Ptr<YansWifiSensor> > m_sensors; //!< Sensors attached to this YansWifiChannel
+  mutable std::vector<uint32_t> m_sensorConfig; //!< Last configuration of each sensor
+  Ptr<OutputStreamWrapper> m_sensorStream; //!< Sensor report, 0 if disabled
+  Time m_sensorInterval;               //!< Sampling interval of the sensor report
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
+  Ptr<PropagationLossModel> m_sensorLoss; //!< Propagation loss model of the sensors, 0 for the mean log-distance loss
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
 };
 
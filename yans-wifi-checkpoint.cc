@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#include "yans-wifi-checkpoint.h"
+#include "yans-wifi-channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/channel.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiCheckpoint");
+
+namespace {
+
+/**
+ * The variant of this process.
+ */
+int32_t g_variant = -1;
+
+} //anonymous namespace
+
+void
+YansWifiCheckpoint::Save (std::ostream &os)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  uint32_t nChannels = 0;
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); i++)
+    {
+      if (DynamicCast<YansWifiChannel> (*i) != 0)
+        {
+          nChannels++;
+        }
+    }
+  os << "yans-wifi-checkpoint 2 " << Simulator::Now ().GetNanoSeconds () << " " << nChannels << "\n";
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); i++)
+    {
+      Ptr<YansWifiChannel> channel = DynamicCast<YansWifiChannel> (*i);
+      if (channel != 0)
+        {
+          os << "id " << channel->GetId () << "\n";
+          channel->SaveState (os);
+        }
+    }
+}
+
+void
+YansWifiCheckpoint::Save (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+  std::ofstream file (filename.c_str ());
+  NS_ABORT_MSG_IF (!file.is_open (), "Could not open checkpoint file " << filename);
+  Save (file);
+  file.close ();
+  NS_ABORT_MSG_IF (file.fail (), "Could not write checkpoint file " << filename);
+}
+
+void
+YansWifiCheckpoint::Restore (std::istream &is)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::string tag;
+  uint32_t version;
+  int64_t time;
+  uint32_t nChannels;
+  is >> tag >> version >> time >> nChannels;
+  NS_ABORT_MSG_IF (!is || tag != "yans-wifi-checkpoint", "Not a YansWifiCheckpoint file");
+  NS_ABORT_MSG_IF (version != 2, "Unsupported YansWifiCheckpoint version " << version);
+  NS_LOG_DEBUG ("restoring the state saved at " << NanoSeconds (time) << " at " << Simulator::Now ());
+  for (uint32_t k = 0; k < nChannels; k++)
+    {
+      uint32_t id;
+      is >> tag >> id;
+      NS_ABORT_MSG_IF (!is || tag != "id" || id >= ChannelList::GetNChannels (),
+                       "No channel for the checkpoint record " << k);
+      Ptr<YansWifiChannel> channel = DynamicCast<YansWifiChannel> (ChannelList::GetChannel (id));
+      NS_ABORT_MSG_IF (channel == 0, "Channel " << id << " is not a YansWifiChannel");
+      channel->RestoreState (is);
+    }
+}
+
+void
+YansWifiCheckpoint::Restore (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+  std::ifstream file (filename.c_str ());
+  NS_ABORT_MSG_IF (!file.is_open (), "Could not open checkpoint file " << filename);
+  Restore (file);
+}
+
+void
+YansWifiCheckpoint::SaveAt (Time at, std::string filename)
+{
+  void (*save) (std::string) = &YansWifiCheckpoint::Save;
+  Simulator::Schedule (at - Simulator::Now (), save, filename);
+}
+
+void
+YansWifiCheckpoint::RestoreAt (Time at, std::string filename)
+{
+  void (*restore) (std::string) = &YansWifiCheckpoint::Restore;
+  Simulator::Schedule (at - Simulator::Now (), restore, filename);
+}
+
+void
+YansWifiCheckpoint::ForkAt (Time at, uint32_t variants, Callback<void, uint32_t> configure,
+                            uint32_t maxParallel, std::string filename)
+{
+  NS_LOG_FUNCTION (at << variants << maxParallel << filename);
+  NS_ABORT_MSG_IF (variants == 0, "At least one variant is needed");
+  Simulator::Schedule (at - Simulator::Now (), &YansWifiCheckpoint::Fork,
+                       variants, configure, maxParallel, filename);
+}
+
+int32_t
+YansWifiCheckpoint::GetVariant (void)
+{
+  return g_variant;
+}
+
+void
+YansWifiCheckpoint::Fork (uint32_t variants, Callback<void, uint32_t> configure,
+                          uint32_t maxParallel, std::string filename)
+{
+  NS_LOG_FUNCTION (variants << maxParallel << filename);
+  if (!filename.empty ())
+    {
+      Save (filename);
+    }
+  //buffered output would otherwise be written once per process
+  std::cout.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+
+  uint32_t running = 0;
+  bool failed = false;
+  for (uint32_t k = 0; k < variants; k++)
+    {
+      if (maxParallel > 0 && running == maxParallel)
+        {
+          failed |= !WaitChild ();
+          running--;
+        }
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "Could not fork variant " << k);
+      if (pid == 0)
+        {
+          g_variant = k;
+          NS_LOG_INFO ("variant " << k << " starting at " << Simulator::Now ());
+          configure (k);
+          return;
+        }
+      running++;
+    }
+  while (running > 0)
+    {
+      failed |= !WaitChild ();
+      running--;
+    }
+  NS_LOG_INFO ("all " << variants << " variants done" << (failed ? ", some failed" : ""));
+  std::cout.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+  //the parent does not run the rest of the simulation nor the program
+  _exit (failed ? 1 : 0);
+}
+
+bool
+YansWifiCheckpoint::WaitChild (void)
+{
+  int status;
+  pid_t pid = wait (&status);
+  if (pid < 0)
+    {
+      return false;
+    }
+  bool ok = WIFEXITED (status) && WEXITSTATUS (status) == 0;
+  NS_LOG_DEBUG ("child " << pid << (ok ? " done" : " failed"));
+  return ok;
+}
+
+} //namespace ns3
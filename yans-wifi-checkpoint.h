@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#ifndef YANS_WIFI_CHECKPOINT_H
+#define YANS_WIFI_CHECKPOINT_H
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+#include <istream>
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * \brief Checkpoints of the YansWifiChannels and YansWifiPhys of a simulation
+ * \ingroup wifi
+ *
+ * Save writes the state of every YansWifiChannel of the ChannelList, and of
+ * the PHYs connected to it, to a text file; Restore reads it back into a
+ * simulation built the same way (see YansWifiChannel::SaveState and
+ * YansWifiPhy::RestoreState for what is part of the state). The PHYs only
+ * record the signals on the air if their RecordSignals attribute is set.
+ *
+ * ns-3 cannot serialize the upper layers (ARP caches, TCP sockets, rate
+ * control, queues), so a warm-up shared by several variant runs is
+ * forked instead: ForkAt runs the warm-up once and, at the given time,
+ * forks one child process per variant. Each child applies its variant
+ * through the callback and continues the simulation from the exact
+ * warmed-up state of the parent, while the parent waits for the children
+ * and exits with a non-zero status if any of them failed. The checkpoint
+ * file written at the fork can be used to check that a variant restored
+ * its channel state from it, or to restore the PHY and channel state of
+ * a rebuilt simulation.
+ *
+ * Background threads are not copied by fork: files and writer threads
+ * (e.g., YansWifiRxTrace, YansWifiAsyncPcapSink) have to be opened in
+ * the variant callback, not before the fork.
+ */
+class YansWifiCheckpoint
+{
+public:
+  /**
+   * Write the state of all the YansWifiChannels.
+   *
+   * \param os the output stream
+   */
+  static void Save (std::ostream &os);
+  /**
+   * \param filename the name of the checkpoint file
+   */
+  static void Save (std::string filename);
+  /**
+   * Restore the state of all the YansWifiChannels at the current time.
+   *
+   * \param is the input stream
+   */
+  static void Restore (std::istream &is);
+  /**
+   * \param filename the name of the checkpoint file
+   */
+  static void Restore (std::string filename);
+  /**
+   * Schedule Save at the given time.
+   *
+   * \param at the simulation time of the checkpoint
+   * \param filename the name of the checkpoint file
+   */
+  static void SaveAt (Time at, std::string filename);
+  /**
+   * Schedule Restore at the given time.
+   *
+   * \param at the simulation time of the restoration
+   * \param filename the name of the checkpoint file
+   */
+  static void RestoreAt (Time at, std::string filename);
+
+  /**
+   * Fork the simulation into variant runs at the given time.
+   *
+   * \param at the end of the warm-up
+   * \param variants the number of variant runs
+   * \param configure called in each child with the index of its variant,
+   *        before the simulation continues
+   * \param maxParallel the maximum number of children running at once, 0 for no limit
+   * \param filename if not empty, the checkpoint file written just before the fork
+   */
+  static void ForkAt (Time at, uint32_t variants, Callback<void, uint32_t> configure,
+                      uint32_t maxParallel = 0, std::string filename = "");
+  /**
+   * \return the index of the variant run by this process, -1 before the
+   *         fork and in the parent
+   */
+  static int32_t GetVariant (void);
+
+private:
+  /**
+   * Fork the children, or wait for them and exit in the parent.
+   *
+   * \param variants the number of variant runs
+   * \param configure the variant callback
+   * \param maxParallel the maximum number of children running at once
+   * \param filename the checkpoint file, or an empty string
+   */
+  static void Fork (uint32_t variants, Callback<void, uint32_t> configure,
+                    uint32_t maxParallel, std::string filename);
+  /**
+   * Wait for one child to end.
+   *
+   * \return true if it exited with a zero status
+   */
+  static bool WaitChild (void);
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_CHECKPOINT_H */
@@ -0,0 +1,756 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+/*
+ * Differential test of the optimizations of the wifi channel and PHY with
+ * adjacent channel interference: every scenario of a small library is run
+ * once in reference mode (all the optimizations off, default scheduler)
+ * and once in optimized mode (all the exact optimizations on, bucket
+ * scheduler, and the approximations given on the command line), each in
+ * its own child process. The receptions of both runs are traced with
+ * YansWifiRxTraceWriter and compared record by record: rx power, overlap
+ * factor, SNR and outcome, within the given tolerances. The wall-clock
+ * times of both runs are reported alongside. The exit status is 1 if any
+ * scenario fails.
+ *
+ * Copy this file to the scratch directory of ns-3.26 and run, e.g.,
+ *   ./waf --run "yans-wifi-diff-harness --nodes=40 --duration=2"
+ * The approximations (FadingCoherenceTime, NearRadius, LinkRefreshTolerance)
+ * are off by default, so that the comparison is exact; enable them with
+ * --coherenceTime, --nearRadius and --linkRefreshTolerance together with
+ * tolerances matching the expected error.
+ *
+ * The reference run still goes through the rewrites that have no switch
+ * (pooled events, precomputed overlap factors, shared packet copy, ...).
+ * To compare with the original model, both runs can also be checked
+ * against golden traces recorded from the baseline sources, using only
+ * the MonitorSnifferRx and PhyRxDrop trace sources of stock ns-3.26:
+ *  1. build this program against the baseline yans-wifi-channel and
+ *     yans-wifi-phy files (the first commit of the repository) with
+ *     CXXFLAGS="-DYANS_WIFI_BASELINE", and run it with the same options
+ *     and --recordGolden=1, which writes <prefix><scenario>.golden;
+ *  2. run the current build with --golden=<prefix>.
+ * The golden records are matched by time, receiver and outcome, and the
+ * signal and noise of the successful receptions are compared with
+ * --rxPowerTolerance and --snrTolerance.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#ifndef YANS_WIFI_BASELINE
+#include "ns3/yans-wifi-rx-trace.h"
+#endif
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * The options shared by all the scenarios.
+ */
+struct Options
+{
+  uint32_t nodes;           //!< number of nodes
+  double side;              //!< side of the square the nodes are placed in, in m
+  double duration;          //!< simulated time in s
+  double interval;          //!< interval between the packets of a sender in s
+  std::string policy;       //!< reception policy of the PHYs
+  double coherenceTime;     //!< FadingCoherenceTime of the optimized run in s
+  double nearRadius;        //!< NearRadius of the optimized run in m
+  double linkRefreshTolerance; //!< LinkRefreshTolerance of the optimized run in dB
+  bool linearPower;         //!< LinearPowerPipeline of the optimized run
+  std::string prefix;       //!< prefix of the trace files
+};
+
+/**
+ * \param options the options
+ * \return the header line of the golden traces, which has to be the same
+ *         for the golden trace and the runs compared with it
+ */
+std::string
+GetGoldenHeader (const struct Options &options)
+{
+  std::ostringstream header;
+  header << "# nodes " << options.nodes << " side " << options.side
+         << " duration " << options.duration << " interval " << options.interval;
+  return header.str ();
+}
+
+/**
+ * The channel configuration of a node.
+ */
+struct Channel
+{
+  uint32_t frequency;       //!< central frequency in MHz
+  uint32_t width;           //!< width in MHz
+};
+
+/**
+ * A scenario of the library.
+ */
+struct Scenario
+{
+  const char *name;                   //!< the name
+  const struct Channel *channels;     //!< channel configurations, assigned to the nodes round robin
+  uint32_t nChannels;                 //!< number of channel configurations
+  double sideFactor;                  //!< factor applied to the side of the square
+  bool sleep;                         //!< whether a third of the nodes toggle between sleep and awake
+};
+
+const struct Channel ADJACENT[] = {{5180, 20}, {5200, 20}};
+const struct Channel MIXED[] = {{5180, 20}, {5190, 40}, {5210, 80}, {5220, 20}};
+const struct Channel CO_CHANNEL[] = {{5180, 20}};
+
+const struct Scenario SCENARIOS[] = {
+  {"adjacent-20", ADJACENT, 2, 1.0, false},
+  {"mixed-width", MIXED, 4, 1.0, false},
+  {"co-channel", CO_CHANNEL, 1, 1.0, false},
+  {"sleep", ADJACENT, 2, 1.0, true},
+  {"sparse", MIXED, 4, 10.0, false}
+};
+
+/**
+ * A reception as seen through the trace sources of stock ns-3.26, which
+ * the baseline sources fire as well.
+ */
+struct GoldenRecord
+{
+  int64_t time;             //!< time of the trace in ns
+  uint32_t receiver;        //!< node id of the receiver
+  bool received;            //!< true for MonitorSnifferRx, false for PhyRxDrop
+  double signalDbm;         //!< signal power in dBm, 0 for drops
+  double noiseDbm;          //!< noise and interference power in dBm, 0 for drops
+};
+
+/**
+ * The result of a comparison with a golden trace.
+ */
+struct GoldenComparison
+{
+  uint64_t golden;          //!< number of golden records
+  uint64_t run;             //!< number of records of the run
+  uint64_t matched;         //!< number of records found in both
+  double maxSignalDb;       //!< largest signal difference in dB
+  double maxNoiseDb;        //!< largest noise difference in dB
+};
+
+std::ofstream *g_golden = 0;  //!< the golden trace being written, 0 if none
+
+/**
+ * Write a successful reception to the golden trace.
+ *
+ * \param node the node id of the receiver
+ * \param packet the packet
+ * \param channelFreqMhz the central frequency of the receiver
+ * \param channelNumber the channel number of the receiver
+ * \param rate the data rate in units of 500 kbps
+ * \param preamble the preamble
+ * \param txVector the TXVECTOR
+ * \param aMpdu the A-MPDU information
+ * \param signalNoise the signal and noise powers in dBm
+ */
+void
+GoldenRx (uint32_t node, Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber,
+          uint32_t rate, WifiPreamble preamble, WifiTxVector txVector, struct mpduInfo aMpdu,
+          struct signalNoiseDbm signalNoise)
+{
+  *g_golden << Simulator::Now ().GetNanoSeconds () << " " << node << " 1 "
+            << std::setprecision (17) << signalNoise.signal << " " << signalNoise.noise << "\n";
+}
+
+/**
+ * Write a dropped reception to the golden trace.
+ *
+ * \param node the node id of the receiver
+ * \param packet the packet
+ */
+void
+GoldenDrop (uint32_t node, Ptr<const Packet> packet)
+{
+  *g_golden << Simulator::Now ().GetNanoSeconds () << " " << node << " 0 0 0\n";
+}
+
+/**
+ * The result of a comparison.
+ */
+struct Comparison
+{
+  uint64_t reference;       //!< number of reference records
+  uint64_t optimized;       //!< number of optimized records
+  uint64_t matched;         //!< number of records found in both runs
+  double maxRxPowerDb;      //!< largest rx power difference in dB
+  double maxOverlapDb;      //!< largest overlap factor difference in dB
+  double maxSnrDb;          //!< largest SNR difference in dB
+  uint64_t outcomes;        //!< number of matched records with different outcomes
+};
+
+/**
+ * Toggle the sleep state of a PHY periodically.
+ *
+ * \param phy the PHY
+ * \param period the time between two toggles
+ */
+void
+ToggleSleep (Ptr<YansWifiPhy> phy, Time period)
+{
+  if (phy->IsStateSleep ())
+    {
+      phy->ResumeFromSleep ();
+    }
+  else
+    {
+      phy->SetSleepMode ();
+    }
+  Simulator::Schedule (period, &ToggleSleep, phy, period);
+}
+
+/**
+ * Build a scenario, run it and write its receptions to a trace file.
+ *
+ * \param scenario the scenario
+ * \param options the options
+ * \param optimized whether the optimizations are enabled
+ * \param traceFile the name of the trace file, none if empty
+ * \param goldenFile the name of the golden trace file, none if empty
+ *
+ * \return the wall-clock time of the simulation in ms
+ */
+int64_t
+RunScenario (const struct Scenario &scenario, const struct Options &options, bool optimized,
+             std::string traceFile, std::string goldenFile)
+{
+#ifndef YANS_WIFI_BASELINE
+  Config::SetDefault ("ns3::YansWifiChannel::SkipSleepingReceivers", BooleanValue (optimized));
+  Config::SetDefault ("ns3::YansWifiChannel::EnergyOnlyDelivery", BooleanValue (optimized));
+  Config::SetDefault ("ns3::YansWifiChannel::FadingCoherenceTime",
+                      TimeValue (Seconds (optimized ? options.coherenceTime : 0.0)));
+  Config::SetDefault ("ns3::YansWifiChannel::NearRadius", DoubleValue (optimized ? options.nearRadius : 0.0));
+  Config::SetDefault ("ns3::YansWifiChannel::LinkRefreshTolerance",
+                      DoubleValue (optimized ? options.linkRefreshTolerance : 0.0));
+  Config::SetDefault ("ns3::YansWifiChannel::LinkRefreshMaxAge",
+                      TimeValue (Seconds (optimized ? options.coherenceTime : 0.0)));
+  Config::SetDefault ("ns3::YansWifiChannel::LinearPowerPipeline",
+                      BooleanValue (optimized && options.linearPower));
+  Config::SetDefault ("ns3::YansWifiPhy::CoalesceCcaBusy", BooleanValue (optimized));
+  Config::SetDefault ("ns3::YansWifiPhy::ReceptionPolicy", StringValue (options.policy));
+  if (optimized)
+    {
+      GlobalValue::Bind ("SchedulerType", StringValue ("ns3::YansWifiBucketScheduler"));
+    }
+#endif
+
+  NodeContainer nodes;
+  nodes.Create (options.nodes);
+
+  //the same positions in both runs, whatever the random streams are used for
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  double side = options.side * scenario.sideFactor;
+  uint64_t state = 1;
+  for (uint32_t i = 0; i < options.nodes; i++)
+    {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      double x = (state >> 11) * (1.0 / 9007199254740992.0) * side;
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      double y = (state >> 11) * (1.0 / 9007199254740992.0) * side;
+      positions->Add (Vector (x, y, 0));
+    }
+  mobility.SetPositionAllocator (positions);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ac);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("VhtMcs5"),
+                                "ControlMode", StringValue ("VhtMcs0"));
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+  wifi.AssignStreams (devices, 1);
+
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      //pairs of nodes on the same channel configuration
+      const struct Channel &configuration = scenario.channels[(i / 2) % scenario.nChannels];
+      Ptr<YansWifiPhy> yansPhy = DynamicCast<YansWifiPhy> (DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ());
+      yansPhy->SetChannelWidth (configuration.width);
+      yansPhy->SetFrequency (configuration.frequency);
+      if (scenario.sleep && i % 3 == 2)
+        {
+          Simulator::Schedule (MilliSeconds (10 + i), &ToggleSleep, yansPhy, MilliSeconds (5));
+        }
+    }
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  ApplicationContainer applications;
+  for (uint32_t i = 0; i + 1 < options.nodes; i += 2)
+    {
+      UdpServerHelper server (9);
+      applications.Add (server.Install (nodes.Get (i + 1)));
+      UdpClientHelper client (interfaces.GetAddress (i + 1), 9);
+      client.SetAttribute ("MaxPackets", UintegerValue (0xffffffff));
+      client.SetAttribute ("Interval", TimeValue (Seconds (options.interval)));
+      client.SetAttribute ("PacketSize", UintegerValue (1000));
+      ApplicationContainer sender = client.Install (nodes.Get (i));
+      sender.Start (Seconds (1.0 + 0.001 * i));
+      applications.Add (sender);
+    }
+  applications.Stop (Seconds (1.0 + options.duration));
+
+#ifndef YANS_WIFI_BASELINE
+  Ptr<YansWifiRxTraceWriter> writer;
+  if (!traceFile.empty ())
+    {
+      writer = CreateObject<YansWifiRxTraceWriter> ();
+      writer->Open (traceFile);
+      writer->InstallAll ();
+    }
+#endif
+  std::ofstream golden;
+  if (!goldenFile.empty ())
+    {
+      golden.open (goldenFile.c_str ());
+      NS_ABORT_MSG_IF (!golden, "Cannot open " << goldenFile);
+      golden << GetGoldenHeader (options) << "\n";
+      g_golden = &golden;
+      for (uint32_t i = 0; i < devices.GetN (); i++)
+        {
+          Ptr<WifiPhy> wifiPhy = DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ();
+          uint32_t node = devices.Get (i)->GetNode ()->GetId ();
+          wifiPhy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeBoundCallback (&GoldenRx, node));
+          wifiPhy->TraceConnectWithoutContext ("PhyRxDrop", MakeBoundCallback (&GoldenDrop, node));
+        }
+    }
+
+  Simulator::Stop (Seconds (1.5 + options.duration));
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  int64_t ms = clock.End ();
+#ifndef YANS_WIFI_BASELINE
+  if (writer != 0)
+    {
+      writer->Close ();
+    }
+#endif
+  Simulator::Destroy ();
+  g_golden = 0;
+  return ms;
+}
+
+/**
+ * Run a scenario in a child process.
+ *
+ * \param scenario the scenario
+ * \param options the options
+ * \param optimized whether the optimizations are enabled
+ * \param traceFile the name of the trace file, none if empty
+ * \param goldenFile the name of the golden trace file, none if empty
+ *
+ * \return the wall-clock time of the simulation in ms, -1 if the child failed
+ */
+int64_t
+RunChild (const struct Scenario &scenario, const struct Options &options, bool optimized,
+          std::string traceFile, std::string goldenFile)
+{
+  int fds[2];
+  NS_ABORT_MSG_IF (pipe (fds) != 0, "Could not create a pipe");
+  pid_t pid = fork ();
+  NS_ABORT_MSG_IF (pid < 0, "Could not fork");
+  if (pid == 0)
+    {
+      close (fds[0]);
+      int64_t ms = RunScenario (scenario, options, optimized, traceFile, goldenFile);
+      ssize_t written = write (fds[1], &ms, sizeof (ms));
+      _exit (written == sizeof (ms) ? 0 : 1);
+    }
+  close (fds[1]);
+  int64_t ms = -1;
+  if (read (fds[0], &ms, sizeof (ms)) != sizeof (ms))
+    {
+      ms = -1;
+    }
+  close (fds[0]);
+  int status;
+  waitpid (pid, &status, 0);
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    {
+      return -1;
+    }
+  return ms;
+}
+
+#ifndef YANS_WIFI_BASELINE
+/**
+ * \param filename the name of a trace file
+ * \param records the records of the trace
+ */
+void
+ReadTrace (std::string filename, std::vector<struct YansWifiPhy::RxRecord> &records)
+{
+  YansWifiRxTraceReader reader (filename);
+  std::vector<struct YansWifiPhy::RxRecord> block;
+  while (reader.ReadBlock (block))
+    {
+      records.insert (records.end (), block.begin (), block.end ());
+    }
+}
+
+/**
+ * Compare the records of two traces, matched by end of reception, sender and receiver.
+ *
+ * \param referenceFile the reference trace
+ * \param optimizedFile the optimized trace
+ *
+ * \return the comparison
+ */
+struct Comparison
+Compare (std::string referenceFile, std::string optimizedFile)
+{
+  std::vector<struct YansWifiPhy::RxRecord> reference;
+  std::vector<struct YansWifiPhy::RxRecord> optimized;
+  ReadTrace (referenceFile, reference);
+  ReadTrace (optimizedFile, optimized);
+
+  typedef std::multimap<std::pair<int64_t, uint64_t>, uint32_t> RecordIndex;
+  RecordIndex index;
+  for (uint32_t i = 0; i < reference.size (); i++)
+    {
+      uint64_t link = (static_cast<uint64_t> (reference[i].sender) << 32) | reference[i].receiver;
+      index.insert (std::make_pair (std::make_pair (reference[i].time, link), i));
+    }
+
+  struct Comparison comparison = {reference.size (), optimized.size (), 0, 0.0, 0.0, 0.0, 0};
+  for (uint32_t i = 0; i < optimized.size (); i++)
+    {
+      const struct YansWifiPhy::RxRecord &o = optimized[i];
+      uint64_t link = (static_cast<uint64_t> (o.sender) << 32) | o.receiver;
+      RecordIndex::iterator it = index.find (std::make_pair (o.time, link));
+      if (it == index.end ())
+        {
+          continue;
+        }
+      const struct YansWifiPhy::RxRecord &r = reference[it->second];
+      index.erase (it);
+      comparison.matched++;
+      comparison.maxRxPowerDb = std::max (comparison.maxRxPowerDb, std::fabs (o.rxPowerDbm - r.rxPowerDbm));
+      comparison.maxOverlapDb = std::max (comparison.maxOverlapDb, std::fabs (o.overlapFactorDb - r.overlapFactorDb));
+      if (o.snr > 0 && r.snr > 0)
+        {
+          comparison.maxSnrDb = std::max (comparison.maxSnrDb, std::fabs (10 * std::log10 (o.snr / r.snr)));
+        }
+      else if (o.snr != r.snr)
+        {
+          comparison.maxSnrDb = HUGE_VAL;
+        }
+      if (o.outcome != r.outcome)
+        {
+          comparison.outcomes++;
+        }
+    }
+  return comparison;
+}
+
+/**
+ * \param filename the name of a golden trace file
+ * \param header the expected header line
+ * \param records the records of the trace
+ *
+ * \return false if the file cannot be read or was recorded with other options
+ */
+bool
+ReadGolden (std::string filename, std::string header, std::vector<struct GoldenRecord> &records)
+{
+  std::ifstream file (filename.c_str ());
+  std::string line;
+  if (!std::getline (file, line) || line != header)
+    {
+      return false;
+    }
+  struct GoldenRecord record;
+  while (file >> record.time >> record.receiver >> record.received >> record.signalDbm >> record.noiseDbm)
+    {
+      records.push_back (record);
+    }
+  return true;
+}
+
+/**
+ * Compare the records of a run with a golden trace, matched by time,
+ * receiver and outcome.
+ *
+ * \param goldenFile the golden trace
+ * \param runFile the golden-format trace of the run
+ * \param header the expected header line of both
+ * \param comparison the comparison
+ *
+ * \return false if one of the files cannot be read or was recorded with other options
+ */
+bool
+CompareGolden (std::string goldenFile, std::string runFile, std::string header, struct GoldenComparison &comparison)
+{
+  std::vector<struct GoldenRecord> golden;
+  std::vector<struct GoldenRecord> run;
+  if (!ReadGolden (goldenFile, header, golden) || !ReadGolden (runFile, header, run))
+    {
+      return false;
+    }
+
+  typedef std::multimap<std::pair<int64_t, uint64_t>, uint32_t> RecordIndex;
+  RecordIndex index;
+  for (uint32_t i = 0; i < golden.size (); i++)
+    {
+      uint64_t key = (static_cast<uint64_t> (golden[i].receiver) << 1) | golden[i].received;
+      index.insert (std::make_pair (std::make_pair (golden[i].time, key), i));
+    }
+
+  comparison.golden = golden.size ();
+  comparison.run = run.size ();
+  comparison.matched = 0;
+  comparison.maxSignalDb = 0.0;
+  comparison.maxNoiseDb = 0.0;
+  for (uint32_t i = 0; i < run.size (); i++)
+    {
+      const struct GoldenRecord &o = run[i];
+      uint64_t key = (static_cast<uint64_t> (o.receiver) << 1) | o.received;
+      RecordIndex::iterator it = index.find (std::make_pair (o.time, key));
+      if (it == index.end ())
+        {
+          continue;
+        }
+      const struct GoldenRecord &g = golden[it->second];
+      index.erase (it);
+      comparison.matched++;
+      comparison.maxSignalDb = std::max (comparison.maxSignalDb, std::fabs (o.signalDbm - g.signalDbm));
+      comparison.maxNoiseDb = std::max (comparison.maxNoiseDb, std::fabs (o.noiseDbm - g.noiseDbm));
+    }
+  return true;
+}
+
+/**
+ * Compare the golden-format trace of a run with the golden trace and print the result.
+ *
+ * \param name the name of the scenario
+ * \param run the name of the run, "reference" or "optimized"
+ * \param goldenFile the golden trace
+ * \param runFile the golden-format trace of the run
+ * \param options the options
+ * \param signalToleranceDb the largest signal difference in dB
+ * \param noiseToleranceDb the largest noise difference in dB
+ * \param missingTolerance the largest share of records found in only one of the traces
+ *
+ * \return whether the run matches the golden trace within the tolerances
+ */
+bool
+CheckGolden (std::string name, std::string run, std::string goldenFile, std::string runFile,
+             const struct Options &options, double signalToleranceDb, double noiseToleranceDb,
+             double missingTolerance)
+{
+  struct GoldenComparison c;
+  if (!CompareGolden (goldenFile, runFile, GetGoldenHeader (options), c))
+    {
+      std::cout << std::left << std::setw (14) << name << "  golden " << run
+                << ": cannot read " << goldenFile << " with these options  FAIL" << std::endl;
+      return false;
+    }
+  uint64_t unmatched = (c.golden - c.matched) + (c.run - c.matched);
+  uint64_t total = std::max<uint64_t> (1, std::max (c.golden, c.run));
+  bool ok = c.maxSignalDb <= signalToleranceDb
+    && c.maxNoiseDb <= noiseToleranceDb
+    && unmatched <= missingTolerance * total;
+  std::cout << std::left << std::setw (14) << name << "  golden " << run
+            << ": golden " << c.golden << " run " << c.run << " matched " << c.matched
+            << " signalDb " << std::setprecision (3) << c.maxSignalDb
+            << " noiseDb " << c.maxNoiseDb
+            << "  " << (ok ? "PASS" : "FAIL") << std::endl;
+  return ok;
+}
+#endif
+
+} //anonymous namespace
+
+int
+main (int argc, char *argv[])
+{
+  struct Options options;
+  options.nodes = 20;
+  options.side = 50;
+  options.duration = 1;
+  options.interval = 0.002;
+  options.policy = "Aci";
+  options.coherenceTime = 0;
+  options.nearRadius = 0;
+  options.linkRefreshTolerance = 0;
+  options.linearPower = true;
+  options.prefix = "yans-wifi-diff-";
+  std::string scenarios = "";
+  double rxPowerToleranceDb = 1e-9;
+  double overlapToleranceDb = 1e-9;
+  double snrToleranceDb = 1e-6;
+  double outcomeTolerance = 0;
+  double missingTolerance = 0;
+  bool recordGolden = false;
+  std::string golden = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes of each scenario", options.nodes);
+  cmd.AddValue ("side", "Side of the square the nodes are placed in, in m", options.side);
+  cmd.AddValue ("duration", "Duration of the traffic in s", options.duration);
+  cmd.AddValue ("interval", "Interval between the packets of each sender in s", options.interval);
+  cmd.AddValue ("policy", "Reception policy of the PHYs (CoChannel, Aci or Subchannel)", options.policy);
+  cmd.AddValue ("coherenceTime", "FadingCoherenceTime of the optimized run in s", options.coherenceTime);
+  cmd.AddValue ("nearRadius", "NearRadius of the optimized run in m", options.nearRadius);
+  cmd.AddValue ("linkRefreshTolerance", "LinkRefreshTolerance of the optimized run in dB, "
+                "with coherenceTime as LinkRefreshMaxAge",
+                options.linkRefreshTolerance);
+  cmd.AddValue ("linearPower", "LinearPowerPipeline of the optimized run", options.linearPower);
+  cmd.AddValue ("prefix", "Prefix of the trace files", options.prefix);
+  cmd.AddValue ("scenarios", "Comma-separated names of the scenarios to run, all if empty", scenarios);
+  cmd.AddValue ("rxPowerTolerance", "Largest rx power difference in dB", rxPowerToleranceDb);
+  cmd.AddValue ("overlapTolerance", "Largest overlap factor difference in dB", overlapToleranceDb);
+  cmd.AddValue ("snrTolerance", "Largest SNR difference in dB", snrToleranceDb);
+  cmd.AddValue ("outcomeTolerance", "Largest share of matched receptions with a different outcome", outcomeTolerance);
+  cmd.AddValue ("missingTolerance", "Largest share of receptions found in only one of the runs", missingTolerance);
+  cmd.AddValue ("recordGolden", "Only write the golden traces <prefix><scenario>.golden of the reference runs",
+                recordGolden);
+  cmd.AddValue ("golden", "Prefix of the golden traces to compare both runs with, none if empty", golden);
+  cmd.Parse (argc, argv);
+#ifdef YANS_WIFI_BASELINE
+  recordGolden = true;
+#endif
+
+  if (recordGolden)
+    {
+      bool recorded = true;
+      for (uint32_t s = 0; s < sizeof (SCENARIOS) / sizeof (SCENARIOS[0]); s++)
+        {
+          const struct Scenario &scenario = SCENARIOS[s];
+          if (!scenarios.empty () && ("," + scenarios + ",").find (std::string (",") + scenario.name + ",") == std::string::npos)
+            {
+              continue;
+            }
+          std::string goldenFile = options.prefix + scenario.name + ".golden";
+          int64_t ms = RunChild (scenario, options, false, "", goldenFile);
+          std::cout << std::left << std::setw (14) << scenario.name << "  "
+                    << (ms < 0 ? "run failed" : goldenFile) << std::endl;
+          recorded = recorded && ms >= 0;
+        }
+      return recorded ? 0 : 1;
+    }
+#ifndef YANS_WIFI_BASELINE
+
+  std::cout << std::left << std::setw (14) << "scenario"
+            << std::right << std::setw (10) << "reference"
+            << std::setw (10) << "optimized"
+            << std::setw (10) << "matched"
+            << std::setw (12) << "rxPowerDb"
+            << std::setw (12) << "overlapDb"
+            << std::setw (12) << "snrDb"
+            << std::setw (10) << "outcomes"
+            << std::setw (9) << "refMs"
+            << std::setw (9) << "optMs"
+            << std::setw (9) << "speedup"
+            << "  result" << std::endl;
+
+  bool passed = true;
+  for (uint32_t s = 0; s < sizeof (SCENARIOS) / sizeof (SCENARIOS[0]); s++)
+    {
+      const struct Scenario &scenario = SCENARIOS[s];
+      if (!scenarios.empty () && ("," + scenarios + ",").find (std::string (",") + scenario.name + ",") == std::string::npos)
+        {
+          continue;
+        }
+      std::string referenceFile = options.prefix + scenario.name + "-reference.ywrt";
+      std::string optimizedFile = options.prefix + scenario.name + "-optimized.ywrt";
+      std::string referenceGolden = golden.empty () ? "" : options.prefix + scenario.name + "-reference.golden";
+      std::string optimizedGolden = golden.empty () ? "" : options.prefix + scenario.name + "-optimized.golden";
+      int64_t referenceMs = RunChild (scenario, options, false, referenceFile, referenceGolden);
+      int64_t optimizedMs = RunChild (scenario, options, true, optimizedFile, optimizedGolden);
+      if (referenceMs < 0 || optimizedMs < 0)
+        {
+          std::cout << std::left << std::setw (14) << scenario.name << "  run failed" << std::endl;
+          passed = false;
+          continue;
+        }
+      struct Comparison c = Compare (referenceFile, optimizedFile);
+      uint64_t unmatched = (c.reference - c.matched) + (c.optimized - c.matched);
+      uint64_t total = std::max<uint64_t> (1, std::max (c.reference, c.optimized));
+      bool ok = c.maxRxPowerDb <= rxPowerToleranceDb
+        && c.maxOverlapDb <= overlapToleranceDb
+        && c.maxSnrDb <= snrToleranceDb
+        && c.outcomes <= outcomeTolerance * std::max<uint64_t> (1, c.matched)
+        && unmatched <= missingTolerance * total;
+      passed = passed && ok;
+      std::cout << std::left << std::setw (14) << scenario.name
+                << std::right << std::setw (10) << c.reference
+                << std::setw (10) << c.optimized
+                << std::setw (10) << c.matched
+                << std::setw (12) << std::setprecision (3) << c.maxRxPowerDb
+                << std::setw (12) << c.maxOverlapDb
+                << std::setw (12) << c.maxSnrDb
+                << std::setw (10) << c.outcomes
+                << std::setw (9) << referenceMs
+                << std::setw (9) << optimizedMs
+                << std::setw (9) << std::setprecision (3) << static_cast<double> (referenceMs) / std::max<int64_t> (1, optimizedMs)
+                << "  " << (ok ? "PASS" : "FAIL") << std::endl;
+      if (!golden.empty ())
+        {
+          std::string goldenFile = golden + scenario.name + ".golden";
+          bool referenceOk = CheckGolden (scenario.name, "reference", goldenFile, referenceGolden, options,
+                                          rxPowerToleranceDb, snrToleranceDb, missingTolerance);
+          bool optimizedOk = CheckGolden (scenario.name, "optimized", goldenFile, optimizedGolden, options,
+                                          rxPowerToleranceDb, snrToleranceDb, missingTolerance);
+          passed = passed && referenceOk && optimizedOk;
+        }
+    }
+  return passed ? 0 : 1;
+#endif
+}
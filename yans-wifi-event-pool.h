@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#ifndef YANS_WIFI_EVENT_POOL_H
+#define YANS_WIFI_EVENT_POOL_H
+
+#include <new>
+#include <cstddef>
+#include <stdint.h>
+#include "ns3/event-impl.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \brief Free list of fixed-size blocks for objects of type T
+ * \ingroup wifi
+ *
+ * Blocks are taken from the heap in chunks and are never given back:
+ * a released block goes to the front of the free list and is reused by
+ * the next allocation. There is one free list per type, shared by all
+ * the instances of the channel and PHY; it must only be used from the
+ * simulation thread.
+ *
+ * \tparam T the type of the pooled objects
+ */
+template <typename T>
+class YansWifiEventPool
+{
+public:
+  /**
+   * \param size the size of the object to allocate, at most sizeof (T)
+   *
+   * \return a block of memory for one object
+   */
+  static void * Allocate (std::size_t size)
+  {
+    NS_ASSERT (size <= sizeof (T));
+    FreeBlock *&head = GetFreeList ();
+    if (head == 0)
+      {
+        Grow ();
+      }
+    FreeBlock *block = head;
+    head = block->next;
+    GetCounters ().inUse++;
+    return block;
+  }
+  /**
+   * \param p a block returned by Allocate, or 0
+   */
+  static void Release (void *p)
+  {
+    if (p == 0)
+      {
+        return;
+      }
+    FreeBlock *&head = GetFreeList ();
+    FreeBlock *block = static_cast<FreeBlock *> (p);
+    block->next = head;
+    head = block;
+    GetCounters ().inUse--;
+  }
+  /**
+   * \return the number of blocks taken from the heap so far
+   */
+  static uint64_t GetCapacity (void)
+  {
+    return GetCounters ().capacity;
+  }
+  /**
+   * \return the number of blocks currently allocated
+   */
+  static uint64_t GetInUse (void)
+  {
+    return GetCounters ().inUse;
+  }
+
+private:
+  /**
+   * A block on the free list.
+   */
+  struct FreeBlock
+  {
+    FreeBlock *next;  //!< next free block
+  };
+  /**
+   * Pool counters.
+   */
+  struct Counters
+  {
+    uint64_t capacity;  //!< number of blocks taken from the heap
+    uint64_t inUse;     //!< number of blocks allocated
+  };
+
+  enum
+  {
+    CHUNK_BLOCKS = 256,  //!< number of blocks taken from the heap at once
+    ALIGNMENT = 16       //!< alignment of the blocks within a chunk
+  };
+
+  /**
+   * \return the head of the free list
+   */
+  static FreeBlock *& GetFreeList (void)
+  {
+    static FreeBlock *head = 0;
+    return head;
+  }
+  /**
+   * \return the pool counters
+   */
+  static Counters & GetCounters (void)
+  {
+    static Counters counters = {0, 0};
+    return counters;
+  }
+  /**
+   * Take a new chunk from the heap and put its blocks on the free list.
+   */
+  static void Grow (void)
+  {
+    std::size_t blockSize = sizeof (T) > sizeof (FreeBlock) ? sizeof (T) : sizeof (FreeBlock);
+    blockSize = (blockSize + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    char *chunk = static_cast<char *> (::operator new (blockSize * CHUNK_BLOCKS));
+    FreeBlock *&head = GetFreeList ();
+    for (uint32_t i = CHUNK_BLOCKS; i > 0; i--)
+      {
+        FreeBlock *block = reinterpret_cast<FreeBlock *> (chunk + (i - 1) * blockSize);
+        block->next = head;
+        head = block;
+      }
+    GetCounters ().capacity += CHUNK_BLOCKS;
+  }
+};
+
+/**
+ * \brief Base class of the events of the reception path, allocated from
+ * a YansWifiEventPool
+ * \ingroup wifi
+ *
+ * Simulator releases events with delete once they are invoked or
+ * cancelled, which returns them to the pool of their type.
+ *
+ * \tparam T the derived event type
+ */
+template <typename T>
+class YansWifiPooledEvent : public EventImpl
+{
+public:
+  /**
+   * \param size the size of the event
+   * \return a block from the pool
+   */
+  static void * operator new (std::size_t size)
+  {
+    return YansWifiEventPool<T>::Allocate (size);
+  }
+  /**
+   * \param p the block to return to the pool
+   */
+  static void operator delete (void *p)
+  {
+    YansWifiEventPool<T>::Release (p);
+  }
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_EVENT_POOL_H */
@@ -0,0 +1,443 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#include "yans-wifi-link-stats.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiLinkStats");
+
+NS_OBJECT_ENSURE_REGISTERED (YansWifiLinkStats);
+
+static const uint32_t LINK_STATS_VERSION = 2;
+
+void
+YansWifiLinkStats::Sketch::Merge (const struct Sketch &other)
+{
+  for (uint32_t k = 0; k < BINS; k++)
+    {
+      count[k] += other.count[k];
+    }
+}
+
+uint64_t
+YansWifiLinkStats::Sketch::GetTotal (void) const
+{
+  uint64_t total = 0;
+  for (uint32_t k = SINR_BINS + PER_BINS; k < BINS; k++)
+    {
+      total += count[k];
+    }
+  return total;
+}
+
+double
+YansWifiLinkStats::Sketch::GetSinrQuantileDb (double q) const
+{
+  uint64_t total = GetTotal ();
+  uint64_t cumulated = 0;
+  for (uint32_t k = 0; k < SINR_BINS; k++)
+    {
+      cumulated += count[k];
+      if (total > 0 && cumulated >= q * total)
+        {
+          //upper edge of the bin
+          return -10.0 + 0.5 * std::min (k, static_cast<uint32_t> (SINR_BINS - 2));
+        }
+    }
+  return 50.0;
+}
+
+double
+YansWifiLinkStats::Sketch::GetSuccessRate (void) const
+{
+  uint64_t total = GetTotal ();
+  return (total > 0) ? static_cast<double> (count[SINR_BINS + PER_BINS + YansWifiPhy::RX_OK]) / total : 0.0;
+}
+
+TypeId
+YansWifiLinkStats::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::YansWifiLinkStats")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<YansWifiLinkStats> ()
+    .AddAttribute ("MaxLinks",
+                   "The maximum number of (sender, receiver) links with a sketch of their own. "
+                   "The receptions of the other links are only added to their channel-pair class.",
+                   UintegerValue (10000),
+                   MakeUintegerAccessor (&YansWifiLinkStats::m_maxLinks),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("DumpInterval",
+                   "The interval at which the counters are appended to the dump file and reset. "
+                   "Zero dumps only when the sink is closed.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&YansWifiLinkStats::SetDumpInterval,
+                                     &YansWifiLinkStats::GetDumpInterval),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+YansWifiLinkStats::YansWifiLinkStats ()
+  : m_overflow (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+YansWifiLinkStats::~YansWifiLinkStats ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+YansWifiLinkStats::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+YansWifiLinkStats::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ABORT_MSG_IF (m_file.is_open (), "Link statistics file already open");
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary);
+  NS_ABORT_MSG_IF (!m_file.is_open (), "Could not open link statistics file " << filename);
+  m_file.write ("YWLS", 4);
+  m_file.write (reinterpret_cast<const char *> (&LINK_STATS_VERSION), sizeof (LINK_STATS_VERSION));
+}
+
+void
+YansWifiLinkStats::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_dumpEvent.Cancel ();
+  if (m_file.is_open ())
+    {
+      Dump ();
+      m_file.close ();
+    }
+}
+
+void
+YansWifiLinkStats::Install (Ptr<YansWifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  phy->TraceConnectWithoutContext ("RxOutcome", MakeCallback (&YansWifiLinkStats::Add, this));
+}
+
+void
+YansWifiLinkStats::InstallAll (void)
+{
+  NS_LOG_FUNCTION (this);
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::YansWifiPhy/RxOutcome",
+                                 MakeCallback (&YansWifiLinkStats::Add, this));
+}
+
+void
+YansWifiLinkStats::Clear (struct Sketch &sketch)
+{
+  std::memset (sketch.count, 0, sizeof (sketch.count));
+}
+
+uint64_t
+YansWifiLinkStats::GetClassKey (const struct ChannelPair &pair)
+{
+  return (static_cast<uint64_t> (static_cast<uint32_t> (pair.frequencyOffset)) << 32)
+         | (static_cast<uint64_t> (pair.senderWidth) << 16) | pair.receiverWidth;
+}
+
+struct YansWifiLinkStats::ChannelPair
+YansWifiLinkStats::GetClass (uint64_t key)
+{
+  struct ChannelPair pair;
+  pair.frequencyOffset = static_cast<int32_t> (static_cast<uint32_t> (key >> 32));
+  pair.senderWidth = static_cast<uint16_t> (key >> 16);
+  pair.receiverWidth = static_cast<uint16_t> (key);
+  return pair;
+}
+
+struct YansWifiLinkStats::Sketch *
+YansWifiLinkStats::Find (uint64_t key, std::map<uint64_t, uint32_t> &index,
+                         std::vector<struct Sketch> &sketches, uint32_t limit)
+{
+  std::map<uint64_t, uint32_t>::const_iterator it = index.find (key);
+  if (it != index.end ())
+    {
+      return &sketches[it->second];
+    }
+  if (sketches.size () >= limit)
+    {
+      return 0;
+    }
+  index[key] = sketches.size ();
+  sketches.push_back (Sketch ());
+  Clear (sketches.back ());
+  return &sketches.back ();
+}
+
+void
+YansWifiLinkStats::Add (const struct YansWifiPhy::RxRecord &record)
+{
+  uint32_t sinrBin = 0;
+  if (record.snr > 0)
+    {
+      double sinrDb = 10 * std::log10 (record.snr);
+      double bin = std::floor ((sinrDb + 10.0) / 0.5) + 1;
+      sinrBin = static_cast<uint32_t> (std::max (0.0, std::min (bin, static_cast<double> (SINR_BINS - 1))));
+    }
+  uint32_t perBin = static_cast<uint32_t> (std::max (0.0, std::min (std::floor (record.per / 0.05),
+                                                                      static_cast<double> (PER_BINS - 1))));
+  uint32_t outcomeBin = std::min (static_cast<uint32_t> (record.outcome), static_cast<uint32_t> (OUTCOME_BINS - 1));
+
+  struct ChannelPair pair;
+  pair.frequencyOffset = record.frequencyOffset;
+  pair.senderWidth = record.senderWidth;
+  pair.receiverWidth = record.receiverWidth;
+  struct Sketch *sketches[2];
+  sketches[0] = Find (GetClassKey (pair), m_classIndex, m_classes, 0xffffffff);
+  sketches[1] = Find ((static_cast<uint64_t> (record.sender) << 32) | record.receiver, m_linkIndex, m_links, m_maxLinks);
+  if (sketches[1] == 0)
+    {
+      m_overflow++;
+    }
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      if (sketches[k] != 0)
+        {
+          sketches[k]->count[sinrBin]++;
+          sketches[k]->count[SINR_BINS + perBin]++;
+          sketches[k]->count[SINR_BINS + PER_BINS + outcomeBin]++;
+        }
+    }
+}
+
+const struct YansWifiLinkStats::Sketch *
+YansWifiLinkStats::GetLinkSketch (uint32_t sender, uint32_t receiver) const
+{
+  std::map<uint64_t, uint32_t>::const_iterator it = m_linkIndex.find ((static_cast<uint64_t> (sender) << 32) | receiver);
+  return (it != m_linkIndex.end ()) ? &m_links[it->second] : 0;
+}
+
+const struct YansWifiLinkStats::Sketch *
+YansWifiLinkStats::GetClassSketch (const struct ChannelPair &pair) const
+{
+  std::map<uint64_t, uint32_t>::const_iterator it = m_classIndex.find (GetClassKey (pair));
+  return (it != m_classIndex.end ()) ? &m_classes[it->second] : 0;
+}
+
+uint64_t
+YansWifiLinkStats::GetOverflowCount (void) const
+{
+  return m_overflow;
+}
+
+void
+YansWifiLinkStats::WriteSketch (const struct Sketch &sketch)
+{
+  uint16_t n = 0;
+  for (uint32_t k = 0; k < BINS; k++)
+    {
+      n += (sketch.count[k] != 0);
+    }
+  m_file.write (reinterpret_cast<const char *> (&n), sizeof (n));
+  for (uint16_t k = 0; k < BINS; k++)
+    {
+      if (sketch.count[k] != 0)
+        {
+          m_file.write (reinterpret_cast<const char *> (&k), sizeof (k));
+          m_file.write (reinterpret_cast<const char *> (&sketch.count[k]), sizeof (sketch.count[k]));
+        }
+    }
+}
+
+void
+YansWifiLinkStats::Dump (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  int64_t time = Simulator::Now ().GetNanoSeconds ();
+  uint32_t nLinks = 0;
+  for (std::vector<struct Sketch>::const_iterator i = m_links.begin (); i != m_links.end (); i++)
+    {
+      nLinks += (i->GetTotal () != 0);
+    }
+  uint32_t nClasses = 0;
+  for (std::vector<struct Sketch>::const_iterator i = m_classes.begin (); i != m_classes.end (); i++)
+    {
+      nClasses += (i->GetTotal () != 0);
+    }
+  m_file.write (reinterpret_cast<const char *> (&time), sizeof (time));
+  m_file.write (reinterpret_cast<const char *> (&m_overflow), sizeof (m_overflow));
+  m_file.write (reinterpret_cast<const char *> (&nLinks), sizeof (nLinks));
+  m_file.write (reinterpret_cast<const char *> (&nClasses), sizeof (nClasses));
+  for (std::map<uint64_t, uint32_t>::const_iterator i = m_linkIndex.begin (); i != m_linkIndex.end (); i++)
+    {
+      struct Sketch &sketch = m_links[i->second];
+      if (sketch.GetTotal () != 0)
+        {
+          uint32_t sender = static_cast<uint32_t> (i->first >> 32);
+          uint32_t receiver = static_cast<uint32_t> (i->first);
+          m_file.write (reinterpret_cast<const char *> (&sender), sizeof (sender));
+          m_file.write (reinterpret_cast<const char *> (&receiver), sizeof (receiver));
+          WriteSketch (sketch);
+          Clear (sketch);
+        }
+    }
+  for (std::map<uint64_t, uint32_t>::const_iterator i = m_classIndex.begin (); i != m_classIndex.end (); i++)
+    {
+      struct Sketch &sketch = m_classes[i->second];
+      if (sketch.GetTotal () != 0)
+        {
+          struct ChannelPair pair = GetClass (i->first);
+          m_file.write (reinterpret_cast<const char *> (&pair.frequencyOffset), sizeof (pair.frequencyOffset));
+          m_file.write (reinterpret_cast<const char *> (&pair.senderWidth), sizeof (pair.senderWidth));
+          m_file.write (reinterpret_cast<const char *> (&pair.receiverWidth), sizeof (pair.receiverWidth));
+          WriteSketch (sketch);
+          Clear (sketch);
+        }
+    }
+  m_overflow = 0;
+  m_file.flush ();
+}
+
+void
+YansWifiLinkStats::PeriodicDump (void)
+{
+  Dump ();
+  m_dumpEvent = Simulator::Schedule (m_dumpInterval, &YansWifiLinkStats::PeriodicDump, this);
+}
+
+void
+YansWifiLinkStats::SetDumpInterval (Time interval)
+{
+  NS_LOG_FUNCTION (this << interval);
+  m_dumpInterval = interval;
+  m_dumpEvent.Cancel ();
+  if (interval.IsStrictlyPositive ())
+    {
+      m_dumpEvent = Simulator::Schedule (interval, &YansWifiLinkStats::PeriodicDump, this);
+    }
+}
+
+Time
+YansWifiLinkStats::GetDumpInterval (void) const
+{
+  return m_dumpInterval;
+}
+
+uint32_t
+YansWifiLinkStats::Load (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  NS_ABORT_MSG_IF (!file.is_open (), "Could not open link statistics file " << filename);
+  char magic[4];
+  uint32_t version;
+  file.read (magic, 4);
+  file.read (reinterpret_cast<char *> (&version), sizeof (version));
+  NS_ABORT_MSG_IF (!file || std::memcmp (magic, "YWLS", 4) != 0 || version != LINK_STATS_VERSION,
+                   filename << " is not a link statistics file");
+  uint32_t dumps = 0;
+  while (true)
+    {
+      int64_t time;
+      uint64_t overflow;
+      uint32_t counts[2];
+      file.read (reinterpret_cast<char *> (&time), sizeof (time));
+      if (!file)
+        {
+          break;
+        }
+      file.read (reinterpret_cast<char *> (&overflow), sizeof (overflow));
+      file.read (reinterpret_cast<char *> (counts), sizeof (counts));
+      m_overflow += overflow;
+      for (uint32_t kind = 0; kind < 2; kind++)
+        {
+          for (uint32_t n = 0; n < counts[kind]; n++)
+            {
+              uint64_t key;
+              if (kind == 0)
+                {
+                  uint32_t ends[2];
+                  file.read (reinterpret_cast<char *> (ends), sizeof (ends));
+                  key = (static_cast<uint64_t> (ends[0]) << 32) | ends[1];
+                }
+              else
+                {
+                  struct ChannelPair pair;
+                  file.read (reinterpret_cast<char *> (&pair.frequencyOffset), sizeof (pair.frequencyOffset));
+                  file.read (reinterpret_cast<char *> (&pair.senderWidth), sizeof (pair.senderWidth));
+                  file.read (reinterpret_cast<char *> (&pair.receiverWidth), sizeof (pair.receiverWidth));
+                  key = GetClassKey (pair);
+                }
+              struct Sketch sketch;
+              Clear (sketch);
+              uint16_t nBins;
+              file.read (reinterpret_cast<char *> (&nBins), sizeof (nBins));
+              for (uint16_t b = 0; b < nBins; b++)
+                {
+                  uint16_t bin;
+                  uint64_t count;
+                  file.read (reinterpret_cast<char *> (&bin), sizeof (bin));
+                  file.read (reinterpret_cast<char *> (&count), sizeof (count));
+                  NS_ABORT_MSG_IF (!file || bin >= BINS, "Truncated link statistics file " << filename);
+                  sketch.count[bin] = count;
+                }
+              struct Sketch *target = (kind == 0) ? Find (key, m_linkIndex, m_links, m_maxLinks)
+                : Find (key, m_classIndex, m_classes, 0xffffffff);
+              if (target != 0)
+                {
+                  target->Merge (sketch);
+                }
+              else
+                {
+                  m_overflow += sketch.GetTotal ();
+                }
+            }
+        }
+      NS_ABORT_MSG_IF (!file, "Truncated link statistics file " << filename);
+      dumps++;
+    }
+  return dumps;
+}
+
+} //namespace ns3
@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#ifndef YANS_WIFI_LINK_STATS_H
+#define YANS_WIFI_LINK_STATS_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include <fstream>
+#include <stdint.h>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "yans-wifi-phy.h"
+
+namespace ns3 {
+
+/**
+ * \brief Constant-memory SINR, PER and outcome distributions per link and per channel pair
+ * \ingroup wifi
+ *
+ * The sink is connected to the RxOutcome trace source of YansWifiPhys and
+ * adds every reception to a fixed-size histogram sketch of its (sender,
+ * receiver) link and of its channel-pair class, i.e., the frequency
+ * offset between receiver and sender and their channel widths. A sketch
+ * holds the SINR in 0.5 dB bins from -10 to 50 dB (with underflow and
+ * overflow bins), the PER in 0.05 bins and the count of each
+ * YansWifiPhy::RxOutcome. Sketches are merged by adding their counters,
+ * so the sketches of several dumps, PHYs or replications can be combined.
+ *
+ * At most MaxLinks links get a sketch of their own: the receptions of
+ * the other links are only added to their class and counted as overflow,
+ * so that the memory used is bounded whatever the size of the network
+ * and the simulated time.
+ *
+ * Every DumpInterval, and when the sink is closed, the counters
+ * accumulated since the previous dump are appended to the file and reset.
+ * Dump layout, in host byte order: the 4-byte magic "YWLS" and a uint32_t
+ * version, then for each dump an int64_t time (ns), a uint64_t overflow
+ * count, a uint32_t link count and a uint32_t class count, followed by
+ * the non-empty links (uint32_t sender, uint32_t receiver, sketch) and
+ * classes (int32_t frequency offset, uint16_t sender width, uint16_t
+ * receiver width, sketch). A sketch is a uint16_t number of non-zero
+ * bins followed by (uint16_t bin, uint64_t count) pairs, bins being
+ * numbered SINR first, then PER, then outcome. This is version 2 of the
+ * layout; version 1 had uint32_t counts.
+ */
+class YansWifiLinkStats : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  YansWifiLinkStats ();
+  virtual ~YansWifiLinkStats ();
+
+  enum
+  {
+    SINR_BINS = 122,     //!< SINR bins, the first and last ones being underflow and overflow
+    PER_BINS = 20,       //!< PER bins
+    OUTCOME_BINS = 3,    //!< one bin per YansWifiPhy::RxOutcome
+    BINS = SINR_BINS + PER_BINS + OUTCOME_BINS //!< number of counters of a sketch
+  };
+
+  /**
+   * A fixed-size histogram sketch.
+   */
+  struct Sketch
+  {
+    uint64_t count[BINS];   //!< the counters, SINR then PER then outcome bins
+
+    /**
+     * Add the counters of another sketch.
+     *
+     * \param other the sketch to merge into this one
+     */
+    void Merge (const struct Sketch &other);
+    /**
+     * \return the number of receptions in the sketch
+     */
+    uint64_t GetTotal (void) const;
+    /**
+     * \param q the quantile, between 0 and 1
+     *
+     * \return the SINR in dB below which the given fraction of the receptions
+     *         falls, at the resolution of the bins
+     */
+    double GetSinrQuantileDb (double q) const;
+    /**
+     * \return the fraction of RX_OK receptions
+     */
+    double GetSuccessRate (void) const;
+  };
+
+  /**
+   * A channel-pair class.
+   */
+  struct ChannelPair
+  {
+    int32_t frequencyOffset;  //!< central frequency of the receiver minus the one of the sender (MHz)
+    uint16_t senderWidth;     //!< channel width of the sender (MHz)
+    uint16_t receiverWidth;   //!< channel width of the receiver (MHz)
+  };
+
+  /**
+   * Create the dump file. Without a file, the sketches are only kept in memory.
+   *
+   * \param filename the name of the dump file
+   */
+  void Open (std::string filename);
+  /**
+   * Dump the pending counters and close the file. This is done
+   * automatically when the object is disposed.
+   */
+  void Close (void);
+
+  /**
+   * Add the receptions of the given PHY.
+   *
+   * \param phy the YansWifiPhy to observe
+   */
+  void Install (Ptr<YansWifiPhy> phy);
+  /**
+   * Add the receptions of all the YansWifiPhys of all the nodes.
+   */
+  void InstallAll (void);
+
+  /**
+   * Add a reception.
+   *
+   * \param record the link metrics of the reception
+   */
+  void Add (const struct YansWifiPhy::RxRecord &record);
+
+  /**
+   * \param sender the node id of the sender
+   * \param receiver the node id of the receiver
+   *
+   * \return the sketch of the link since the last dump, or 0 if the link has none
+   */
+  const struct Sketch * GetLinkSketch (uint32_t sender, uint32_t receiver) const;
+  /**
+   * \param pair the channel-pair class
+   *
+   * \return the sketch of the class since the last dump, or 0 if the class has none
+   */
+  const struct Sketch * GetClassSketch (const struct ChannelPair &pair) const;
+  /**
+   * \return the number of receptions of links without a sketch of their own
+   */
+  uint64_t GetOverflowCount (void) const;
+
+  /**
+   * Merge all the dumps of a file written by this class into the link and
+   * class sketches of this object, e.g., to combine replications.
+   *
+   * \param filename the name of the dump file
+   *
+   * \return the number of dumps read
+   */
+  uint32_t Load (std::string filename);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \param sketch the sketch to clear
+   */
+  static void Clear (struct Sketch &sketch);
+  /**
+   * \param pair the channel-pair class
+   *
+   * \return the key of the class
+   */
+  static uint64_t GetClassKey (const struct ChannelPair &pair);
+  /**
+   * \param key the key of a class
+   *
+   * \return the class
+   */
+  static struct ChannelPair GetClass (uint64_t key);
+  /**
+   * \param key the key of a link or class
+   * \param index the key to index map
+   * \param sketches the sketches
+   * \param limit the maximum number of sketches
+   *
+   * \return the sketch of the key, added if needed, or 0 if the limit is reached
+   */
+  static struct Sketch * Find (uint64_t key, std::map<uint64_t, uint32_t> &index,
+                               std::vector<struct Sketch> &sketches, uint32_t limit);
+  /**
+   * \param sketch the sketch to write
+   */
+  void WriteSketch (const struct Sketch &sketch);
+  /**
+   * Append the counters accumulated since the last dump to the file and reset them.
+   */
+  void Dump (void);
+  /**
+   * Dump and schedule the next periodic dump.
+   */
+  void PeriodicDump (void);
+  /**
+   * \param interval the dump interval, zero to dump only on Close
+   */
+  void SetDumpInterval (Time interval);
+  /**
+   * \return the dump interval
+   */
+  Time GetDumpInterval (void) const;
+
+  uint32_t m_maxLinks;                      //!< maximum number of links with a sketch of their own
+  Time m_dumpInterval;                      //!< interval between two dumps
+  EventId m_dumpEvent;                      //!< next periodic dump
+  std::ofstream m_file;                     //!< the dump file
+  std::map<uint64_t, uint32_t> m_linkIndex; //!< index of the sketch of each link, by sender and receiver
+  std::vector<struct Sketch> m_links;       //!< link sketches
+  std::map<uint64_t, uint32_t> m_classIndex; //!< index of the sketch of each class
+  std::vector<struct Sketch> m_classes;     //!< class sketches
+  uint64_t m_overflow;                      //!< receptions of links without a sketch since the last dump
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_LINK_STATS_H */
@@ -53,14 +53,29 @@
 
 #include "yans-wifi-phy.h"
 #include "yans-wifi-channel.h"
+#include "yans-wifi-profiler.h"
+#include "yans-wifi-event-pool.h"
+#include "yans-wifi-alloc-accounting.h"
 #include "wifi-phy-state-helper.h"
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/trace-source-accessor.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
 #include "ampdu-tag.h"
 #include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <string>
 
 namespace ns3 {
 
@@ -68,6 +83,76 @@ NS_LOG_COMPONENT_DEFINE ("YansWifiPhy");
 
 NS_OBJECT_ENSURE_REGISTERED (YansWifiPhy);
 
+/**
+ * Event of the end of the PLCP header of the packet being received,
+ * taken from a pool instead of the heap.
+ */
+class YansWifiPhy::StartReceivePacketEvent : public YansWifiPooledEvent<YansWifiPhy::StartReceivePacketEvent>
+{
+public:
+  StartReceivePacketEvent (YansWifiPhy *phy, Ptr<Packet> packet, const WifiTxVector &txVector,
+                           enum WifiPreamble preamble, enum mpduType mpdutype, Ptr<InterferenceHelper::Event> event)
+    : m_phy (phy),
+      m_packet (packet),
+      m_txVector (txVector),
+      m_preamble (preamble),
+      m_mpdutype (mpdutype),
+      m_event (event)
+  {
+  }
+
+private:
+  virtual void Notify (void)
+  {
+    m_phy->StartReceivePacket (m_packet, m_txVector, m_preamble, m_mpdutype, m_event);
+  }
+
+  YansWifiPhy *m_phy;                       //!< the receiving PHY
+  Ptr<Packet> m_packet;                     //!< the packet being received
+  WifiTxVector m_txVector;                  //!< the TXVECTOR of the packet
+  enum WifiPreamble m_preamble;             //!< the preamble of the packet
+  enum mpduType m_mpdutype;                 //!< the type of the MPDU
+  Ptr<InterferenceHelper::Event> m_event;   //!< the interference event of the packet
+};
+
+/**
+ * Event of the end of the packet being received, taken from a pool
+ * instead of the heap.
+ */
+class YansWifiPhy::EndReceiveEvent : public YansWifiPooledEvent<YansWifiPhy::EndReceiveEvent>
+{
+public:
+  EndReceiveEvent (YansWifiPhy *phy, Ptr<Packet> packet, enum WifiPreamble preamble,
+                   enum mpduType mpdutype, Ptr<InterferenceHelper::Event> event)
+    : m_phy (phy),
+      m_packet (packet),
+      m_preamble (preamble),
+      m_mpdutype (mpdutype),
+      m_event (event)
+  {
+  }
+
+private:
+  virtual void Notify (void)
+  {
+    m_phy->EndReceive (m_packet, m_preamble, m_mpdutype, m_event);
+  }
+
+  YansWifiPhy *m_phy;                       //!< the receiving PHY
+  Ptr<Packet> m_packet;                     //!< the packet being received
+  enum WifiPreamble m_preamble;             //!< the preamble of the packet
+  enum mpduType m_mpdutype;                 //!< the type of the MPDU
+  Ptr<InterferenceHelper::Event> m_event;   //!< the interference event of the packet
+};
+
+template <enum YansWifiPhy::DropReason reason>
+uint64_t
+YansWifiPhy::GetDropCountOf (void) const
+{
+  CountSkippedArrivals ();
+  return m_dropStatistics.count[reason];
+}
+
 TypeId
 YansWifiPhy::GetTypeId (void)
 {
@@ -75,13 +160,121 @@ YansWifiPhy::GetTypeId (void)
     .SetParent<WifiPhy> ()
     .SetGroupName ("Wifi")
     .AddConstructor<YansWifiPhy> ()
+    .AddAttribute ("DropsSwitching",
+                   "The number of packets dropped because the PHY was switching channel.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&YansWifiPhy::GetDropCountOf<DROP_SWITCHING>),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("DropsAlreadyRx",
+                   "The number of packets dropped because the PHY was already receiving.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&YansWifiPhy::GetDropCountOf<DROP_ALREADY_RX>),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("DropsAlreadyTx",
+                   "The number of packets dropped because the PHY was transmitting.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&YansWifiPhy::GetDropCountOf<DROP_ALREADY_TX>),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("DropsBelowEd",
+                   "The number of packets dropped because the rx power was below the energy detection threshold.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&YansWifiPhy::GetDropCountOf<DROP_BELOW_ED>),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("DropsPrimaryNotOverlapping",
+                   "The number of packets dropped because the primary channels of sender and receiver did not match.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&YansWifiPhy::GetDropCountOf<DROP_PRIMARY_NOT_OVERLAPPING>),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("DropsNoPlcp",
+                   "The number of MPDUs dropped because no PLCP preamble/header had been received.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&YansWifiPhy::GetDropCountOf<DROP_NO_PLCP>),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("DropsSleep",
+                   "The number of packets dropped because the PHY was in sleep mode.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&YansWifiPhy::GetDropCountOf<DROP_SLEEP>),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("DropSampleInterval",
+                   "The interval at which the DropStatistics trace source is fired. "
+                   "Zero disables the periodic sampling.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&YansWifiPhy::SetDropSampleInterval,
+                                     &YansWifiPhy::GetDropSampleInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("ReceptionPolicy",
+                   "The reception logic for the packets delivered by YansWifiChannel: "
+                   "co-channel only as in stock ns-3.26, adjacent channel interference with "
+                   "the primary channel check, or the latter with per-20 MHz subchannel tracking: "
+                   "CCA mode 1 on the primary 20 MHz subchannel and per-subchannel SINR for decoding.",
+                   EnumValue (YansWifiPhy::RECEPTION_ACI),
+                   MakeEnumAccessor (&YansWifiPhy::SetReceptionPolicy,
+                                     &YansWifiPhy::GetReceptionPolicy),
+                   MakeEnumChecker (YansWifiPhy::RECEPTION_CO_CHANNEL, "CoChannel",
+                                    YansWifiPhy::RECEPTION_ACI, "Aci",
+                                    YansWifiPhy::RECEPTION_SUBCHANNEL, "Subchannel"))
+    .AddAttribute ("CoalesceCcaBusy",
+                   "If true, the PHY listeners are only notified of a CCA busy period when it ends "
+                   "later than the one already announced, instead of once per arriving signal. "
+                   "Notifications during channel switching are never coalesced.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&YansWifiPhy::m_coalesceCcaBusy),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RecordSignals",
+                   "If true, the signals added to the interference tracker are also recorded "
+                   "so that SaveState can write the signals still on the air.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiPhy::m_recordSignals),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SecondaryCcaThreshold",
+                   "The power in dBm above which a secondary 20 MHz subchannel is reported busy "
+                   "by IsSubchannelCcaBusy.",
+                   DoubleValue (-62.0),
+                   MakeDoubleAccessor (&YansWifiPhy::SetSecondaryCcaThreshold,
+                                       &YansWifiPhy::GetSecondaryCcaThreshold),
+                   MakeDoubleChecker<double> ())
+    .AddTraceSource ("DropStatistics",
+                     "Periodic samples of the per-reason drop counters and rx power histograms.",
+                     MakeTraceSourceAccessor (&YansWifiPhy::m_dropStatisticsTrace),
+                     "ns3::YansWifiPhy::DropStatisticsTracedCallback")
+    .AddTraceSource ("RxOutcome",
+                     "The sender, receiver, rx power, overlap factor, SNR, PER and outcome "
+                     "of every reception the PHY synchronized on.",
+                     MakeTraceSourceAccessor (&YansWifiPhy::m_rxOutcomeTrace),
+                     "ns3::YansWifiPhy::RxOutcomeTracedCallback")
   ;
   return tid;
 }
 
 YansWifiPhy::YansWifiPhy ()
+  : m_coalesceCcaBusy (true),
+    m_recordSignals (false),
+    m_nodeId (0xffffffff),
+    m_rxSenderId (0xffffffff),
+    m_rxPowerDbm (0.0),
+    m_rxOverlapFactorDb (0.0),
+    m_rxChannelFrequency (0),
+    m_rxChannelWidth (0)
 {
   NS_LOG_FUNCTION (this);
+  m_rxSubchannelSignal.nSubchannels = 0;
+  m_subchannelNoiseFigure = 0;
+  m_secondaryCcaThresholdW = DbmToW (-62.0);
+  //converted on first use, as the attributes of WifiPhy are not set yet
+  m_rxGainDb = std::numeric_limits<double>::quiet_NaN ();
+  m_rxGainW = 1.0;
+  m_ccaThresholdDbm = std::numeric_limits<double>::quiet_NaN ();
+  m_ccaThresholdW = 0.0;
+  SetReceptionPolicy (RECEPTION_ACI);
+  ResetDropStatistics ();
+  m_skippedPlcpReset = false;
 }
 
 YansWifiPhy::~YansWifiPhy ()
@@ -93,7 +286,10 @@ void
 YansWifiPhy::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_dropSampleEvent.Cancel ();
   m_channel = 0;
+  std::vector<InterferenceHelper> ().swap (m_subchannelInterference);
+  m_subchannelErrorRateModel = 0;
 }
 
 bool
@@ -138,6 +334,9 @@ switchChannel:
   NS_LOG_DEBUG ("switching channel " << GetChannelNumber () << " -> " << nch);
   m_state->SwitchToChannelSwitching (GetChannelSwitchDelay ());
   m_interference.EraseEvents ();
+  ClearSubchannelSignals ();
+  m_energySignals.clear ();
+  m_ccaBusyAnnouncedEnd = Seconds (0);
   /*
    * Needed here to be able to correctly sensed the medium for the first
    * time after the switching. The actual switching is not performed until
@@ -190,6 +389,9 @@ switchFrequency:
   NS_LOG_DEBUG ("switching frequency " << GetFrequency () << " -> " << frequency);
   m_state->SwitchToChannelSwitching (GetChannelSwitchDelay ());
   m_interference.EraseEvents ();
+  ClearSubchannelSignals ();
+  m_energySignals.clear ();
+  m_ccaBusyAnnouncedEnd = Seconds (0);
   /*
    * Needed here to be able to correctly sensed the medium for the first
    * time after the switching. The actual switching is not performed until
@@ -235,6 +437,11 @@ YansWifiPhy::SetSleepMode (void)
     case YansWifiPhy::IDLE:
       NS_LOG_DEBUG ("setting sleep mode");
       m_state->SwitchToSleep ();
+      m_ccaBusyAnnouncedEnd = Seconds (0);
+      if (m_channel != 0)
+        {
+          m_channel->NotifySleep (this);
+        }
       break;
     case YansWifiPhy::SLEEP:
       NS_LOG_DEBUG ("already in sleep mode");
@@ -263,8 +470,13 @@ YansWifiPhy::ResumeFromSleep (void)
     case YansWifiPhy::SLEEP:
       {
         NS_LOG_DEBUG ("resuming from sleep mode");
-        Time delayUntilCcaEnd = m_interference.GetEnergyDuration (DbmToW (GetCcaMode1Threshold ()));
+        if (m_channel != 0)
+          {
+            m_channel->NotifyWakeup (this);
+          }
+        Time delayUntilCcaEnd = GetDelayUntilCcaEnd ();
         m_state->SwitchFromSleep (delayUntilCcaEnd);
+        m_ccaBusyAnnouncedEnd = Simulator::Now () + delayUntilCcaEnd;
         break;
       }
     default:
@@ -276,175 +488,557 @@ YansWifiPhy::ResumeFromSleep (void)
 }
 
 void
-YansWifiPhy::SetReceiveOkCallback (RxOkCallback callback)
+YansWifiPhy::NotifyReceptionSkipped (enum DropReason reason, double rxPowerDbm, Time arrival)
 {
-  m_state->SetReceiveOkCallback (callback);
+  NS_LOG_FUNCTION (this << reason << rxPowerDbm << arrival);
+  if (arrival <= Simulator::Now ())
+    {
+      CountDrop (reason, rxPowerDbm + GetRxGain ());
+      m_plcpSuccess = false;
+    }
+  else
+    {
+      //a delivered packet would only be dropped when its first bit arrives
+      m_skippedArrivals.insert (std::make_pair (arrival, std::make_pair (reason, rxPowerDbm + GetRxGain ())));
+    }
 }
 
 void
-YansWifiPhy::SetReceiveErrorCallback (RxErrorCallback callback)
+YansWifiPhy::CancelSkippedReceptions (enum DropReason reason)
 {
-  m_state->SetReceiveErrorCallback (callback);
+  NS_LOG_FUNCTION (this << reason);
+  CountSkippedArrivals ();
+  std::multimap<Time, std::pair<enum DropReason, double> >::iterator it = m_skippedArrivals.begin ();
+  while (it != m_skippedArrivals.end ())
+    {
+      if (it->second.first == reason)
+        {
+          m_skippedArrivals.erase (it++);
+        }
+      else
+        {
+          it++;
+        }
+    }
 }
 
 void
-YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
-                                            double rxPowerDbm,
-                                            WifiTxVector txVector,
-                                            enum WifiPreamble preamble,
-                                            enum mpduType mpdutype,
-                                            Time rxDuration)
+YansWifiPhy::CountSkippedArrivals (void) const
 {
-  //This function should be later split to check separately whether plcp preamble and plcp header can be successfully received.
-  //Note: plcp preamble reception is not yet modeled.
-  NS_LOG_FUNCTION (this << packet << rxPowerDbm << txVector.GetMode () << preamble << (uint32_t)mpdutype);
-  AmpduTag ampduTag;
-  rxPowerDbm += GetRxGain ();
-  double rxPowerW = DbmToW (rxPowerDbm);
-  Time endRx = Simulator::Now () + rxDuration;
-  Time preambleAndHeaderDuration = CalculatePlcpPreambleAndHeaderDuration (txVector, preamble);
-
-  Ptr<InterferenceHelper::Event> event;
-  event = m_interference.Add (packet->GetSize (),
-                              txVector,
-                              preamble,
-                              rxDuration,
-                              rxPowerW);
+  Time now = Simulator::Now ();
+  while (!m_skippedArrivals.empty () && m_skippedArrivals.begin ()->first <= now)
+    {
+      CountDrop (m_skippedArrivals.begin ()->second.first, m_skippedArrivals.begin ()->second.second);
+      m_skippedPlcpReset = true;
+      m_skippedArrivals.erase (m_skippedArrivals.begin ());
+    }
+}
 
-  switch (m_state->GetState ())
+void
+YansWifiPhy::ApplyPlcpResets (void)
+{
+  CountSkippedArrivals ();
+  if (m_skippedPlcpReset)
     {
-    case YansWifiPhy::SWITCHING:
-      NS_LOG_DEBUG ("drop packet because of channel switching");
-      NotifyRxDrop (packet);
       m_plcpSuccess = false;
-      /*
-       * Packets received on the upcoming channel are added to the event list
-       * during the switching state. This way the medium can be correctly sensed
-       * when the device listens to the channel for the first time after the
-       * switching e.g. after channel switching, the channel may be sensed as
-       * busy due to other devices' tramissions started before the end of
-       * the switching.
-       */
-      if (endRx > Simulator::Now () + m_state->GetDelayUntilIdle ())
+      m_skippedPlcpReset = false;
+    }
+}
+
+void
+YansWifiPhy::CountDrop (enum DropReason reason, double rxPowerDbm) const
+{
+  int32_t bin = static_cast<int32_t> (std::floor ((rxPowerDbm + 120.0) / 5.0));
+  bin = std::max (0, std::min (bin, static_cast<int32_t> (DROP_HISTOGRAM_BINS) - 1));
+  m_dropStatistics.count[reason]++;
+  m_dropStatistics.histogram[reason][bin]++;
+}
+
+uint64_t
+YansWifiPhy::GetDropCount (enum DropReason reason) const
+{
+  return m_dropStatistics.count[reason];
+}
+
+const struct YansWifiPhy::DropStatistics &
+YansWifiPhy::GetDropStatistics (void) const
+{
+  CountSkippedArrivals ();
+  return m_dropStatistics;
+}
+
+void
+YansWifiPhy::ResetDropStatistics (void)
+{
+  std::memset (&m_dropStatistics, 0, sizeof (m_dropStatistics));
+}
+
+void
+YansWifiPhy::SetDropSampleInterval (Time interval)
+{
+  NS_LOG_FUNCTION (this << interval);
+  m_dropSampleInterval = interval;
+  m_dropSampleEvent.Cancel ();
+  if (interval.IsStrictlyPositive ())
+    {
+      m_dropSampleEvent = Simulator::Schedule (interval, &YansWifiPhy::SampleDropStatistics, this);
+    }
+}
+
+Time
+YansWifiPhy::GetDropSampleInterval (void) const
+{
+  return m_dropSampleInterval;
+}
+
+void
+YansWifiPhy::SampleDropStatistics (void)
+{
+  CountSkippedArrivals ();
+  m_dropStatisticsTrace (this, m_dropStatistics);
+  m_dropSampleEvent = Simulator::Schedule (m_dropSampleInterval, &YansWifiPhy::SampleDropStatistics, this);
+}
+
+void
+YansWifiPhy::AddInterference (uint32_t size,
+                              const struct Parameters &parameters,
+                              Time duration)
+{
+  NS_LOG_FUNCTION (this << size << parameters.rxPowerDbm << parameters.preamble << duration);
+  YANS_WIFI_ALLOC_STAGE (INTERFERENCE_EVENT);
+  double powerW = GetRxPowerW (parameters);
+  m_interference.Add (size, parameters.txVector, parameters.preamble, duration, powerW);
+  if (m_recordSignals)
+    {
+      RecordEnergySignal (size, parameters.preamble, duration, powerW);
+    }
+  if (m_receptionPolicy == RECEPTION_SUBCHANNEL)
+    {
+      AddSubchannelSignal (size, parameters, duration, powerW, 0);
+    }
+}
+
+void
+YansWifiPhy::MaybeCcaBusy (void)
+{
+  Time delayUntilCcaEnd = GetDelayUntilCcaEnd ();
+  if (delayUntilCcaEnd.IsZero ())
+    {
+      return;
+    }
+  if (m_coalesceCcaBusy && !IsStateSwitching ())
+    {
+      //the listeners only need to hear about a later end of the busy period
+      Time end = Simulator::Now () + delayUntilCcaEnd;
+      if (end <= m_ccaBusyAnnouncedEnd)
         {
-          //that packet will be noise _after_ the completion of the
-          //channel switching.
-          goto maybeCcaBusy;
+          return;
         }
-      break;
-    case YansWifiPhy::RX:
-      NS_LOG_DEBUG ("drop packet because already in Rx (power=" <<
-                    rxPowerW << "W)");
-      NotifyRxDrop (packet);
-      if (endRx > Simulator::Now () + m_state->GetDelayUntilIdle ())
+      m_ccaBusyAnnouncedEnd = end;
+    }
+  m_state->SwitchMaybeToCcaBusy (delayUntilCcaEnd);
+}
+
+void
+YansWifiPhy::RecordEnergySignal (uint32_t size, enum WifiPreamble preamble, Time duration, double powerW)
+{
+  Time now = Simulator::Now ();
+  uint32_t kept = 0;
+  for (uint32_t i = 0; i < m_energySignals.size (); i++)
+    {
+      if (m_energySignals[i].end > now)
         {
-          //that packet will be noise _after_ the reception of the
-          //currently-received packet.
-          goto maybeCcaBusy;
+          m_energySignals[kept++] = m_energySignals[i];
         }
-      break;
-    case YansWifiPhy::TX:
-      NS_LOG_DEBUG ("drop packet because already in Tx (power=" <<
-                    rxPowerW << "W)");
-      NotifyRxDrop (packet);
-      if (endRx > Simulator::Now () + m_state->GetDelayUntilIdle ())
+    }
+  m_energySignals.resize (kept);
+  struct EnergySignal signal;
+  signal.end = now + duration;
+  signal.powerW = powerW;
+  signal.size = size;
+  signal.preamble = preamble;
+  m_energySignals.push_back (signal);
+}
+
+void
+YansWifiPhy::SaveState (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  uint32_t nSignals = 0;
+  for (std::vector<struct EnergySignal>::const_iterator i = m_energySignals.begin (); i != m_energySignals.end (); i++)
+    {
+      if (i->end > now)
         {
-          //that packet will be noise _after_ the transmission of the
-          //currently-transmitted packet.
-          goto maybeCcaBusy;
+          nSignals++;
         }
-      break;
-    case YansWifiPhy::CCA_BUSY:
-    case YansWifiPhy::IDLE:
-      if (rxPowerW > GetEdThresholdW ()) //checked here, no need to check in the payload reception (current implementation assumes constant rx power over the packet duration)
+    }
+  //the skipped receptions that already arrived count, the later ones are restored by the channel
+  CountSkippedArrivals ();
+  bool plcpSuccess = m_plcpSuccess && !m_skippedPlcpReset;
+  //times are relative to the time of the snapshot, -1 for no pending event
+  os << "phy " << static_cast<uint32_t> (m_state->GetState ())
+     << " " << m_state->GetDelayUntilIdle ().GetNanoSeconds ()
+     << " " << static_cast<uint32_t> (m_mpdusNum)
+     << " " << plcpSuccess
+     << " " << (m_endPlcpRxEvent.IsRunning () ? Simulator::GetDelayLeft (m_endPlcpRxEvent).GetNanoSeconds () : -1)
+     << " " << (m_endRxEvent.IsRunning () ? Simulator::GetDelayLeft (m_endRxEvent).GetNanoSeconds () : -1)
+     << " " << nSignals << "\n";
+  std::streamsize precision = os.precision (17);
+  for (std::vector<struct EnergySignal>::const_iterator i = m_energySignals.begin (); i != m_energySignals.end (); i++)
+    {
+      if (i->end > now)
         {
-          if (preamble == WIFI_PREAMBLE_NONE && (m_mpdusNum == 0 || m_plcpSuccess == false))
-            {
-              m_plcpSuccess = false;
-              m_mpdusNum = 0;
-              NS_LOG_DEBUG ("drop packet because no PLCP preamble/header has been received");
-              NotifyRxDrop (packet);
-              goto maybeCcaBusy;
-            }
-          else if (preamble != WIFI_PREAMBLE_NONE && packet->PeekPacketTag (ampduTag) && m_mpdusNum == 0)
-            {
-              //received the first MPDU in an MPDU
-              m_mpdusNum = ampduTag.GetRemainingNbOfMpdus ();
-              m_rxMpduReferenceNumber++;
-            }
-          else if (preamble == WIFI_PREAMBLE_NONE && packet->PeekPacketTag (ampduTag) && m_mpdusNum > 0)
-            {
-              //received the other MPDUs that are part of the A-MPDU
-              if (ampduTag.GetRemainingNbOfMpdus () < (m_mpdusNum - 1))
-                {
-                  NS_LOG_DEBUG ("Missing MPDU from the A-MPDU " << m_mpdusNum - ampduTag.GetRemainingNbOfMpdus ());
-                  m_mpdusNum = ampduTag.GetRemainingNbOfMpdus ();
-                }
-              else
-                {
-                  m_mpdusNum--;
-                }
-            }
-          else if (preamble != WIFI_PREAMBLE_NONE && packet->PeekPacketTag (ampduTag) && m_mpdusNum > 0)
-            {
-              NS_LOG_DEBUG ("New A-MPDU started while " << m_mpdusNum << " MPDUs from previous are lost");
-              m_mpdusNum = ampduTag.GetRemainingNbOfMpdus ();
-            }
-          else if (preamble != WIFI_PREAMBLE_NONE && m_mpdusNum > 0 )
+          os << (i->end - now).GetNanoSeconds () << " " << i->powerW << " " << i->size
+             << " " << static_cast<uint32_t> (i->preamble) << "\n";
+        }
+    }
+  uint32_t nSubchannelSignals = 0;
+  for (std::vector<struct SubchannelSignal>::const_iterator i = m_subchannelSignals.begin (); i != m_subchannelSignals.end (); i++)
+    {
+      if (i->end > now)
+        {
+          nSubchannelSignals++;
+        }
+    }
+  os << "subchannels " << nSubchannelSignals << "\n";
+  for (std::vector<struct SubchannelSignal>::const_iterator i = m_subchannelSignals.begin (); i != m_subchannelSignals.end (); i++)
+    {
+      if (i->end > now)
+        {
+          os << (i->end - now).GetNanoSeconds () << " " << i->nSubchannels;
+          for (uint32_t k = 0; k < i->nSubchannels; k++)
             {
-              NS_LOG_DEBUG ("Didn't receive the last MPDUs from an A-MPDU " << m_mpdusNum);
-              m_mpdusNum = 0;
+              os << " " << i->powerW[k];
             }
+          os << "\n";
+        }
+    }
+  os.precision (precision);
+}
 
-          NS_LOG_DEBUG ("sync to signal (power=" << rxPowerW << "W)");
-          //sync to signal
-          m_state->SwitchToRx (rxDuration);
-          NS_ASSERT (m_endPlcpRxEvent.IsExpired ());
-          NotifyRxBegin (packet);
-          m_interference.NotifyRxStart ();
+void
+YansWifiPhy::RestoreState (std::istream &is)
+{
+  NS_LOG_FUNCTION (this);
+  std::string tag;
+  uint32_t state;
+  int64_t delayUntilIdle;
+  uint32_t mpdusNum;
+  bool plcpSuccess;
+  int64_t endPlcpRx;
+  int64_t endRx;
+  uint32_t nSignals;
+  is >> tag >> state >> delayUntilIdle >> mpdusNum >> plcpSuccess >> endPlcpRx >> endRx >> nSignals;
+  NS_ABORT_MSG_IF (!is || tag != "phy", "Malformed YansWifiPhy state record");
+  NS_ABORT_MSG_IF (!IsStateIdle () && !IsStateCcaBusy (), "YansWifiPhy state can only be restored into an idle PHY");
+  m_mpdusNum = mpdusNum;
+  m_plcpSuccess = plcpSuccess;
+  m_skippedArrivals.clear ();
+  m_skippedPlcpReset = false;
+  if (endRx >= 0)
+    {
+      //the frame being received is lost: only its energy is restored below
+      NS_LOG_DEBUG ("reception ending in " << endRx << "ns not restored");
+      m_plcpSuccess = false;
+    }
+  for (uint32_t k = 0; k < nSignals; k++)
+    {
+      int64_t remaining;
+      double powerW;
+      uint32_t size;
+      uint32_t preamble;
+      is >> remaining >> powerW >> size >> preamble;
+      NS_ABORT_MSG_IF (!is, "Malformed YansWifiPhy signal record");
+      m_interference.Add (size, WifiTxVector (), static_cast<enum WifiPreamble> (preamble),
+                          NanoSeconds (remaining), powerW);
+      if (m_recordSignals)
+        {
+          RecordEnergySignal (size, static_cast<enum WifiPreamble> (preamble), NanoSeconds (remaining), powerW);
+        }
+    }
+  uint32_t nSubchannelSignals;
+  is >> tag >> nSubchannelSignals;
+  NS_ABORT_MSG_IF (!is || tag != "subchannels", "Malformed YansWifiPhy subchannel record");
+  for (uint32_t k = 0; k < nSubchannelSignals; k++)
+    {
+      int64_t remaining;
+      struct SubchannelSignal signal;
+      is >> remaining >> signal.nSubchannels;
+      NS_ABORT_MSG_IF (!is || signal.nSubchannels == 0 || signal.nSubchannels > Parameters::MAX_SUBCHANNELS,
+                       "Malformed YansWifiPhy subchannel record");
+      for (uint32_t j = 0; j < signal.nSubchannels; j++)
+        {
+          is >> signal.powerW[j];
+        }
+      NS_ABORT_MSG_IF (!is, "Malformed YansWifiPhy subchannel record");
+      signal.end = Simulator::Now () + NanoSeconds (remaining);
+      if (m_receptionPolicy == RECEPTION_SUBCHANNEL)
+        {
+          //interference only: the packet of the signal is not saved
+          TrackSubchannelSignal (0, WifiTxVector (), WIFI_PREAMBLE_NONE, signal, 0);
+        }
+    }
+  if (state == YansWifiPhy::SLEEP)
+    {
+      SetSleepMode ();
+      return;
+    }
+  MaybeCcaBusy ();
+}
 
-          if (preamble != WIFI_PREAMBLE_NONE)
-            {
-              NS_ASSERT (m_endPlcpRxEvent.IsExpired ());
-              m_endPlcpRxEvent = Simulator::Schedule (preambleAndHeaderDuration, &YansWifiPhy::StartReceivePacket, this,
-                                                      packet, txVector, preamble, mpdutype, event);
-            }
+struct YansWifiPhy::SubchannelSignal
+YansWifiPhy::AddSubchannelSignal (uint32_t size, const struct Parameters &parameters, Time duration,
+                                  double powerW, Ptr<InterferenceHelper::Event> *events)
+{
+  struct SubchannelSignal signal;
+  signal.end = Simulator::Now () + duration;
+  signal.nSubchannels = parameters.nSubchannels;
+  if (signal.nSubchannels == 0)
+    {
+      signal.nSubchannels = 1;
+      signal.powerW[0] = powerW;
+    }
+  else if (parameters.rxPowerW > 0)
+    {
+      double rxGainW = GetRxGainW ();
+      for (uint32_t k = 0; k < signal.nSubchannels; k++)
+        {
+          signal.powerW[k] = parameters.subchannelRxPowerW[k] * rxGainW;
+        }
+    }
+  else
+    {
+      double rxGain = GetRxGain ();
+      for (uint32_t k = 0; k < signal.nSubchannels; k++)
+        {
+          signal.powerW[k] = DbmToW (parameters.subchannelRxPowerDbm[k] + rxGain);
+        }
+    }
 
-          NS_ASSERT (m_endRxEvent.IsExpired ());
-          m_endRxEvent = Simulator::Schedule (rxDuration, &YansWifiPhy::EndReceive, this,
-                                              packet, preamble, mpdutype, event);
+  //each subchannel carries its share of the bits: its noise is the one of 20 MHz
+  WifiTxVector txVector = parameters.txVector;
+  if (parameters.nSubchannels > 0)
+    {
+      txVector.SetChannelWidth (std::min<uint32_t> (20, txVector.GetChannelWidth ()));
+    }
+  ConfigureSubchannelInterference ();
+  TrackSubchannelSignal (size, txVector, parameters.preamble, signal, events);
+  return signal;
+}
+
+void
+YansWifiPhy::TrackSubchannelSignal (uint32_t size, const WifiTxVector &txVector, enum WifiPreamble preamble,
+                                    const struct SubchannelSignal &signal, Ptr<InterferenceHelper::Event> *events)
+{
+  Time now = Simulator::Now ();
+  for (uint32_t k = 0; k < signal.nSubchannels; k++)
+    {
+      Ptr<InterferenceHelper::Event> event = m_subchannelInterference[k].Add (size, txVector, preamble,
+                                                                            signal.end - now, signal.powerW[k]);
+      if (events != 0)
+        {
+          events[k] = event;
         }
-      else
+    }
+
+
+  uint32_t kept = 0;
+  for (uint32_t i = 0; i < m_subchannelSignals.size (); i++)
+    {
+      if (m_subchannelSignals[i].end > now)
         {
-          NS_LOG_DEBUG ("drop packet because signal power too Small (" <<
-                        rxPowerW << "<" << GetEdThresholdW () << ")");
-          NotifyRxDrop (packet);
-          m_plcpSuccess = false;
-          goto maybeCcaBusy;
+          m_subchannelSignals[kept++] = m_subchannelSignals[i];
         }
-      break;
-    case YansWifiPhy::SLEEP:
-      NS_LOG_DEBUG ("drop packet because in sleep mode");
-      NotifyRxDrop (packet);
-      m_plcpSuccess = false;
-      break;
     }
+  m_subchannelSignals.resize (kept);
+  m_subchannelSignals.push_back (signal);
+}
 
-  return;
+void
+YansWifiPhy::ClearSubchannelSignals (void)
+{
+  m_subchannelSignals.clear ();
+  m_rxSubchannelSignal.nSubchannels = 0;
+  for (uint32_t k = 0; k < m_subchannelInterference.size (); k++)
+    {
+      m_subchannelInterference[k].EraseEvents ();
+    }
+  for (uint32_t k = 0; k < Parameters::MAX_SUBCHANNELS; k++)
+    {
+      m_rxSubchannelEvents[k] = 0;
+    }
+}
 
-maybeCcaBusy:
-  //We are here because we have received the first bit of a packet and we are
-  //not going to be able to synchronize on it
-  //In this model, CCA becomes busy when the aggregation of all signals as
-  //tracked by the InterferenceHelper class is higher than the CcaBusyThreshold
+void
+YansWifiPhy::ConfigureSubchannelInterference (void)
+{
+  double noiseFigure = m_interference.GetNoiseFigure ();
+  Ptr<ErrorRateModel> errorRateModel = m_interference.GetErrorRateModel ();
+  if (noiseFigure == m_subchannelNoiseFigure && errorRateModel == m_subchannelErrorRateModel)
+    {
+      return;
+    }
+  m_subchannelNoiseFigure = noiseFigure;
+  m_subchannelErrorRateModel = errorRateModel;
+  for (uint32_t k = 0; k < m_subchannelInterference.size (); k++)
+    {
+      m_subchannelInterference[k].SetNoiseFigure (noiseFigure);
+      m_subchannelInterference[k].SetErrorRateModel (errorRateModel);
+    }
+}
 
-  Time delayUntilCcaEnd = m_interference.GetEnergyDuration (DbmToW (GetCcaMode1Threshold ()));
-  if (!delayUntilCcaEnd.IsZero ())
+void
+YansWifiPhy::NotifySubchannelRxStart (void)
+{
+  for (uint32_t k = 0; k < m_subchannelInterference.size (); k++)
     {
-      m_state->SwitchMaybeToCcaBusy (delayUntilCcaEnd);
+      m_subchannelInterference[k].NotifyRxStart ();
     }
 }
 
+void
+YansWifiPhy::NotifySubchannelRxEnd (void)
+{
+  if (m_receptionPolicy != RECEPTION_SUBCHANNEL)
+    {
+      return;
+    }
+  for (uint32_t k = 0; k < m_subchannelInterference.size (); k++)
+    {
+      m_subchannelInterference[k].NotifyRxEnd ();
+    }
+}
+
+Time
+YansWifiPhy::GetDelayUntilCcaEnd (void)
+{
+  if (m_receptionPolicy == RECEPTION_SUBCHANNEL)
+    {
+      return m_subchannelInterference[0].GetEnergyDuration (GetCcaMode1ThresholdW ());
+    }
+  return m_interference.GetEnergyDuration (GetCcaMode1ThresholdW ());
+}
+
+double
+YansWifiPhy::GetSubchannelPayloadPer (void)
+{
+  //the sender shares the lower edge of the primary channel, see IsPrimaryOverlapping
+  uint32_t nCovered = std::max<uint32_t> (1, m_rxChannelWidth / 20);
+  nCovered = std::min (nCovered, m_rxSubchannelSignal.nSubchannels);
+  double psr = 1.0;
+  for (uint32_t k = 0; k < nCovered; k++)
+    {
+      psr *= 1 - m_subchannelInterference[k].CalculatePlcpPayloadSnrPer (m_rxSubchannelEvents[k]).per;
+    }
+  return 1 - psr;
+}
+
+double
+YansWifiPhy::GetSubchannelPowerW (uint32_t k) const
+{
+  Time now = Simulator::Now ();
+  double powerW = 0.0;
+  for (std::vector<struct SubchannelSignal>::const_iterator i = m_subchannelSignals.begin ();
+       i != m_subchannelSignals.end (); i++)
+    {
+      if (i->end > now && k < i->nSubchannels)
+        {
+          powerW += i->powerW[k];
+        }
+    }
+  return powerW;
+}
+
+double
+YansWifiPhy::GetSubchannelNoiseW (void) const
+{
+  //same thermal noise as InterferenceHelper::CalculateSnr, over 20 MHz
+  static const double boltzmann = 1.3803e-23;
+  double width = std::min<uint32_t> (20, GetChannelWidth ()) * 1e6;
+  return boltzmann * 290.0 * width * m_interference.GetNoiseFigure ();
+}
+
+uint32_t
+YansWifiPhy::GetNSubchannels (void) const
+{
+  return std::max<uint32_t> (1, std::min<uint32_t> (Parameters::MAX_SUBCHANNELS, GetChannelWidth () / 20));
+}
+
+double
+YansWifiPhy::GetSubchannelPowerDbm (uint32_t k) const
+{
+  NS_ASSERT (k < GetNSubchannels ());
+  return WToDbm (GetSubchannelPowerW (k) + GetSubchannelNoiseW ());
+}
+
+bool
+YansWifiPhy::IsSubchannelCcaBusy (uint32_t k) const
+{
+  NS_ASSERT (k < GetNSubchannels ());
+  double thresholdW = (k == 0) ? GetCcaMode1ThresholdW () : m_secondaryCcaThresholdW;
+  return GetSubchannelPowerW (k) > thresholdW;
+}
+
+double
+YansWifiPhy::GetSubchannelSinr (uint32_t k) const
+{
+  NS_ASSERT (k < GetNSubchannels ());
+  if (!IsStateRx () || k >= m_rxSubchannelSignal.nSubchannels || m_rxSubchannelSignal.end <= Simulator::Now ())
+    {
+      return 0.0;
+    }
+  return m_subchannelInterference[k].CalculatePlcpPayloadSnrPer (m_rxSubchannelEvents[k]).snr;
+}
+
+void
+YansWifiPhy::SetSecondaryCcaThreshold (double threshold)
+{
+  NS_LOG_FUNCTION (this << threshold);
+  m_secondaryCcaThresholdW = DbmToW (threshold);
+}
+
+double
+YansWifiPhy::GetSecondaryCcaThreshold (void) const
+{
+  return WToDbm (m_secondaryCcaThresholdW);
+}
+
+void
+YansWifiPhy::SetReceiveOkCallback (RxOkCallback callback)
+{
+  m_state->SetReceiveOkCallback (callback);
+}
+
+void
+YansWifiPhy::SetReceiveErrorCallback (RxErrorCallback callback)
+{
+  m_state->SetReceiveErrorCallback (callback);
+}
+
+void
+YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
+                                            double rxPowerDbm,
+                                            WifiTxVector txVector,
+                                            enum WifiPreamble preamble,
+                                            enum mpduType mpdutype,
+                                            Time rxDuration)
+{
+  struct Parameters parameters;
+  parameters.rxPowerDbm = rxPowerDbm;
+  parameters.type = mpdutype;
+  parameters.duration = rxDuration;
+  parameters.txVector = txVector;
+  parameters.preamble = preamble;
+  parameters.channelFrequency = GetFrequency ();
+  parameters.channelWidth = GetChannelWidth ();
+  parameters.senderId = 0xffffffff;
+  parameters.overlapFactorDb = 0.0;
+  parameters.nSubchannels = 0;
+  parameters.rxPowerW = 0.0;
+  StartReceive<CoChannelReception> (packet, parameters);
+}
+
 //-----------ADDED CODE by Andra/Laurent
 void
 YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
@@ -456,26 +1050,218 @@ YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
                                             uint32_t channelFrequency,
                                             uint32_t channelWidth)
 {
+  struct Parameters parameters;
+  parameters.rxPowerDbm = rxPowerDbm;
+  parameters.type = mpdutype;
+  parameters.duration = rxDuration;
+  parameters.txVector = txVector;
+  parameters.preamble = preamble;
+  parameters.channelFrequency = channelFrequency;
+  parameters.channelWidth = channelWidth;
+  parameters.senderId = 0xffffffff;
+  parameters.overlapFactorDb = 0.0;
+  parameters.nSubchannels = 0;
+  parameters.rxPowerW = 0.0;
+  StartReceive<AciReception> (packet, parameters);
+}
+
+void
+YansWifiPhy::StartReceivePreambleAndHeader (Ptr<const Packet> packet, struct Parameters parameters)
+{
+  (this->*m_startReceive) (packet, parameters);
+}
+
+enum YansWifiPhy::ReceptionPolicy
+YansWifiPhy::GetReceptionPolicy (void) const
+{
+  return m_receptionPolicy;
+}
+
+void
+YansWifiPhy::SetReceptionPolicy (enum ReceptionPolicy policy)
+{
+  NS_LOG_FUNCTION (this << policy);
+  m_receptionPolicy = policy;
+  switch (policy)
+    {
+    case RECEPTION_CO_CHANNEL:
+      m_startReceive = &YansWifiPhy::StartReceive<CoChannelReception>;
+      break;
+    case RECEPTION_ACI:
+      m_startReceive = &YansWifiPhy::StartReceive<AciReception>;
+      break;
+    case RECEPTION_SUBCHANNEL:
+      m_startReceive = &YansWifiPhy::StartReceive<SubchannelReception>;
+      break;
+    default:
+      NS_FATAL_ERROR ("Unknown reception policy " << policy);
+      break;
+    }
+  ClearSubchannelSignals ();
+  //only the subchannel policy tracks the signals per subchannel
+  if (policy == RECEPTION_SUBCHANNEL)
+    {
+      m_subchannelInterference.resize (Parameters::MAX_SUBCHANNELS);
+      m_subchannelNoiseFigure = 0;
+      m_subchannelErrorRateModel = 0;
+      ConfigureSubchannelInterference ();
+    }
+  else
+    {
+      std::vector<InterferenceHelper> ().swap (m_subchannelInterference);
+    }
+}
+
+bool
+YansWifiPhy::IsPrimaryOverlapping (uint32_t channelFrequency, uint32_t channelWidth) const
+{
+  return (GetFrequency()-GetChannelWidth()/2 == channelFrequency-channelWidth/2) && (GetChannelWidth()>=channelWidth);
+}
+
+double
+YansWifiPhy::GetRxGainW (void) const
+{
+  double rxGain = GetRxGain ();
+  if (rxGain != m_rxGainDb)
+    {
+      m_rxGainDb = rxGain;
+      m_rxGainW = DbToRatio (rxGain);
+    }
+  return m_rxGainW;
+}
+
+double
+YansWifiPhy::GetCcaMode1ThresholdW (void) const
+{
+  double threshold = GetCcaMode1Threshold ();
+  if (threshold != m_ccaThresholdDbm)
+    {
+      m_ccaThresholdDbm = threshold;
+      m_ccaThresholdW = DbmToW (threshold);
+    }
+  return m_ccaThresholdW;
+}
+
+double
+YansWifiPhy::GetRxPowerW (const struct Parameters &parameters) const
+{
+  if (parameters.rxPowerW > 0)
+    {
+      return parameters.rxPowerW * GetRxGainW ();
+    }
+  return DbmToW (parameters.rxPowerDbm + GetRxGain ());
+}
+
+bool
+YansWifiPhy::CanSync (uint32_t channelFrequency, uint32_t channelWidth) const
+{
+  return m_receptionPolicy == RECEPTION_CO_CHANNEL || IsPrimaryOverlapping (channelFrequency, channelWidth);
+}
+
+void
+YansWifiPhy::StartReceiveEnergy (uint32_t size, const struct Parameters &parameters)
+{
+  YANS_WIFI_PROFILE_SCOPE (START_RECEIVE_PREAMBLE);
+  NS_LOG_FUNCTION (this << size << parameters.rxPowerDbm << parameters.preamble);
+  NS_ASSERT (m_receptionPolicy != RECEPTION_CO_CHANNEL);
+  ApplyPlcpResets ();
+  double rxPowerDbm = parameters.rxPowerDbm + GetRxGain ();
+  double rxPowerW = GetRxPowerW (parameters);
+  Time endRx = Simulator::Now () + parameters.duration;
+  {
+    YANS_WIFI_ALLOC_STAGE (INTERFERENCE_EVENT);
+    m_interference.Add (size, parameters.txVector, parameters.preamble, parameters.duration, rxPowerW);
+  }
+  if (m_recordSignals)
+    {
+      RecordEnergySignal (size, parameters.preamble, parameters.duration, rxPowerW);
+    }
+  if (m_receptionPolicy == RECEPTION_SUBCHANNEL)
+    {
+      AddSubchannelSignal (size, parameters, parameters.duration, rxPowerW, 0);
+    }
+
+  //same drop accounting as StartReceive for a signal it cannot sync on
+  bool ccaUpdate = endRx > Simulator::Now () + m_state->GetDelayUntilIdle ();
+  switch (m_state->GetState ())
+    {
+    case YansWifiPhy::SWITCHING:
+      CountDrop (DROP_SWITCHING, rxPowerDbm);
+      m_plcpSuccess = false;
+      break;
+    case YansWifiPhy::RX:
+      CountDrop (DROP_ALREADY_RX, rxPowerDbm);
+      break;
+    case YansWifiPhy::TX:
+      CountDrop (DROP_ALREADY_TX, rxPowerDbm);
+      break;
+    case YansWifiPhy::CCA_BUSY:
+    case YansWifiPhy::IDLE:
+      CountDrop ((rxPowerW > GetEdThresholdW ()) ? DROP_PRIMARY_NOT_OVERLAPPING : DROP_BELOW_ED, rxPowerDbm);
+      m_plcpSuccess = false;
+      ccaUpdate = true;
+      break;
+    case YansWifiPhy::SLEEP:
+      CountDrop (DROP_SLEEP, rxPowerDbm);
+      m_plcpSuccess = false;
+      ccaUpdate = false;
+      break;
+    }
+  if (ccaUpdate)
+    {
+      MaybeCcaBusy ();
+    }
+}
+
+template <class Policy>
+void
+YansWifiPhy::StartReceive (Ptr<const Packet> packet, const struct Parameters &parameters)
+{
+  double rxPowerDbm = parameters.rxPowerDbm;
+  const WifiTxVector &txVector = parameters.txVector;
+  enum WifiPreamble preamble = parameters.preamble;
+  enum mpduType mpdutype = parameters.type;
+  Time rxDuration = parameters.duration;
+  uint32_t channelFrequency = parameters.channelFrequency;
+  uint32_t channelWidth = parameters.channelWidth;
+
+  YANS_WIFI_PROFILE_SCOPE (START_RECEIVE_PREAMBLE);
   //This function should be later split to check separately whether plcp preamble and plcp header can be successfully received.
   //Note: plcp preamble reception is not yet modeled.
   NS_LOG_FUNCTION (this << packet << rxPowerDbm << txVector.GetMode () << preamble << (uint32_t)mpdutype);
+  ApplyPlcpResets ();
   AmpduTag ampduTag;
   rxPowerDbm += GetRxGain ();
-  double rxPowerW = DbmToW (rxPowerDbm);
+  double rxPowerW = GetRxPowerW (parameters);
   Time endRx = Simulator::Now () + rxDuration;
   Time preambleAndHeaderDuration = CalculatePlcpPreambleAndHeaderDuration (txVector, preamble);
 
   Ptr<InterferenceHelper::Event> event;
-  event = m_interference.Add (packet->GetSize (),
-                              txVector,
-                              preamble,
-                              rxDuration,
-                              rxPowerW);
+  {
+    YANS_WIFI_ALLOC_STAGE (INTERFERENCE_EVENT);
+    event = m_interference.Add (packet->GetSize (),
+                                txVector,
+                                preamble,
+                                rxDuration,
+                                rxPowerW);
+  }
+  if (m_recordSignals)
+    {
+      RecordEnergySignal (packet->GetSize (), preamble, rxDuration, rxPowerW);
+    }
+  struct SubchannelSignal subchannelSignal;
+  subchannelSignal.nSubchannels = 0;
+  Ptr<InterferenceHelper::Event> subchannelEvents[Parameters::MAX_SUBCHANNELS];
+  if (Policy::TRACK_SUBCHANNELS)
+    {
+      subchannelSignal = AddSubchannelSignal (packet->GetSize (), parameters, rxDuration, rxPowerW, subchannelEvents);
+    }
 
   switch (m_state->GetState ())
     {
     case YansWifiPhy::SWITCHING:
       NS_LOG_DEBUG ("drop packet because of channel switching");
+      CountDrop (DROP_SWITCHING, rxPowerDbm);
       NotifyRxDrop (packet);
       m_plcpSuccess = false;
       /*
@@ -496,6 +1282,7 @@ YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
     case YansWifiPhy::RX:
       NS_LOG_DEBUG ("drop packet because already in Rx (power=" <<
                     rxPowerW << "W)");
+      CountDrop (DROP_ALREADY_RX, rxPowerDbm);
       NotifyRxDrop (packet);
       if (endRx > Simulator::Now () + m_state->GetDelayUntilIdle ())
         {
@@ -507,6 +1294,7 @@ YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
     case YansWifiPhy::TX:
       NS_LOG_DEBUG ("drop packet because already in Tx (power=" <<
                     rxPowerW << "W)");
+      CountDrop (DROP_ALREADY_TX, rxPowerDbm);
       NotifyRxDrop (packet);
       if (endRx > Simulator::Now () + m_state->GetDelayUntilIdle ())
         {
@@ -517,7 +1305,7 @@ YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
       break;
     case YansWifiPhy::CCA_BUSY:
     case YansWifiPhy::IDLE:
-      if ((rxPowerW > GetEdThresholdW ()) && (GetFrequency()-GetChannelWidth()/2 == channelFrequency-channelWidth/2) && (GetChannelWidth()>=channelWidth)) //checked here, no need to check in the payload reception (current implementation assumes constant rx power over the packet duration)
+      if ((rxPowerW > GetEdThresholdW ()) && (!Policy::CHECK_PRIMARY || IsPrimaryOverlapping (channelFrequency, channelWidth))) //checked here, no need to check in the payload reception (current implementation assumes constant rx power over the packet duration)
       // CHANGE made by Andra to start preamble reception only if the primary channels of the transmission and receiver overlap 
         {
           if (preamble == WIFI_PREAMBLE_NONE && (m_mpdusNum == 0 || m_plcpSuccess == false))
@@ -525,6 +1313,7 @@ YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
               m_plcpSuccess = false;
               m_mpdusNum = 0;
               NS_LOG_DEBUG ("drop packet because no PLCP preamble/header has been received");
+              CountDrop (DROP_NO_PLCP, rxPowerDbm);
               NotifyRxDrop (packet);
               goto maybeCcaBusy;
             }
@@ -559,27 +1348,51 @@ YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
             }
 
           NS_LOG_DEBUG ("sync to signal (power=" << rxPowerW << "W)");
+          m_rxSenderId = parameters.senderId;
+          m_rxPowerDbm = rxPowerDbm;
+          m_rxOverlapFactorDb = parameters.overlapFactorDb;
+          m_rxChannelFrequency = channelFrequency;
+          m_rxChannelWidth = channelWidth;
+          m_rxSubchannelSignal = subchannelSignal;
           //sync to signal
           m_state->SwitchToRx (rxDuration);
+          //the listeners forget the CCA busy period when the reception starts
+          m_ccaBusyAnnouncedEnd = Seconds (0);
           NS_ASSERT (m_endPlcpRxEvent.IsExpired ());
           NotifyRxBegin (packet);
           m_interference.NotifyRxStart ();
+          if (Policy::TRACK_SUBCHANNELS)
+            {
+              for (uint32_t k = 0; k < subchannelSignal.nSubchannels; k++)
+                {
+                  m_rxSubchannelEvents[k] = subchannelEvents[k];
+                }
+              NotifySubchannelRxStart ();
+            }
 
+          //the packet is shared with the other receivers until here
+          Ptr<Packet> rxPacket;
+          {
+            YANS_WIFI_ALLOC_STAGE (PACKET_COPY);
+            rxPacket = packet->Copy ();
+          }
+          YANS_WIFI_ALLOC_STAGE (PHY_SCHEDULE);
           if (preamble != WIFI_PREAMBLE_NONE)
             {
               NS_ASSERT (m_endPlcpRxEvent.IsExpired ());
-              m_endPlcpRxEvent = Simulator::Schedule (preambleAndHeaderDuration, &YansWifiPhy::StartReceivePacket, this,
-                                                      packet, txVector, preamble, mpdutype, event);
+              m_endPlcpRxEvent = Simulator::Schedule (preambleAndHeaderDuration,
+                                                      Ptr<EventImpl> (new StartReceivePacketEvent (this, rxPacket, txVector, preamble, mpdutype, event), false));
             }
 
           NS_ASSERT (m_endRxEvent.IsExpired ());
-          m_endRxEvent = Simulator::Schedule (rxDuration, &YansWifiPhy::EndReceive, this,
-                                              packet, preamble, mpdutype, event);
+          m_endRxEvent = Simulator::Schedule (rxDuration,
+                                              Ptr<EventImpl> (new EndReceiveEvent (this, rxPacket, preamble, mpdutype, event), false));
         }
       else
         {
           NS_LOG_DEBUG ("drop packet because signal power too Small or primary channels not overlapping (" <<
                         rxPowerW << "<" << GetEdThresholdW () << ")");
+          CountDrop ((Policy::CHECK_PRIMARY && rxPowerW > GetEdThresholdW ()) ? DROP_PRIMARY_NOT_OVERLAPPING : DROP_BELOW_ED, rxPowerDbm);
           NotifyRxDrop (packet);
           m_plcpSuccess = false;
           goto maybeCcaBusy;
@@ -587,6 +1400,7 @@ YansWifiPhy::StartReceivePreambleAndHeader (Ptr<Packet> packet,
       break;
     case YansWifiPhy::SLEEP:
       NS_LOG_DEBUG ("drop packet because in sleep mode");
+      CountDrop (DROP_SLEEP, rxPowerDbm);
       NotifyRxDrop (packet);
       m_plcpSuccess = false;
       break;
@@ -600,11 +1414,7 @@ maybeCcaBusy:
   //In this model, CCA becomes busy when the aggregation of all signals as
   //tracked by the InterferenceHelper class is higher than the CcaBusyThreshold
 
-  Time delayUntilCcaEnd = m_interference.GetEnergyDuration (DbmToW (GetCcaMode1Threshold ()));
-  if (!delayUntilCcaEnd.IsZero ())
-    {
-      m_state->SwitchMaybeToCcaBusy (delayUntilCcaEnd);
-    }
+  MaybeCcaBusy ();
 }
 
 //---------END change by Andra
@@ -616,13 +1426,20 @@ YansWifiPhy::StartReceivePacket (Ptr<Packet> packet,
                                  enum mpduType mpdutype,
                                  Ptr<InterferenceHelper::Event> event)
 {
+  YANS_WIFI_PROFILE_SCOPE (START_RECEIVE_PACKET);
   NS_LOG_FUNCTION (this << packet << txVector.GetMode () << preamble << (uint32_t)mpdutype);
   NS_ASSERT (IsStateRx ());
   NS_ASSERT (m_endPlcpRxEvent.IsExpired ());
+  ApplyPlcpResets ();
   WifiMode txMode = txVector.GetMode ();
 
   struct InterferenceHelper::SnrPer snrPer;
   snrPer = m_interference.CalculatePlcpHeaderSnrPer (event);
+  if (m_receptionPolicy == RECEPTION_SUBCHANNEL && m_rxSubchannelSignal.nSubchannels > 0)
+    {
+      //the PLCP header is decoded on the primary 20 MHz subchannel
+      snrPer = m_subchannelInterference[0].CalculatePlcpHeaderSnrPer (m_rxSubchannelEvents[0]);
+    }
 
   NS_LOG_DEBUG ("snr(dB)=" << RatioToDb (snrPer.snr) << ", per=" << snrPer.per);
 
@@ -683,6 +1500,7 @@ YansWifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, WifiPr
       m_endPlcpRxEvent.Cancel ();
       m_endRxEvent.Cancel ();
       m_interference.NotifyRxEnd ();
+      NotifySubchannelRxEnd ();
     }
   NotifyTxBegin (packet);
   uint32_t dataRate500KbpsUnits;
@@ -704,6 +1522,8 @@ YansWifiPhy::SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, WifiPr
   aMpdu.mpduRefNumber = m_txMpduReferenceNumber;
   NotifyMonitorSniffTx (packet, (uint16_t)GetFrequency (), GetChannelNumber (), dataRate500KbpsUnits, preamble, txVector, aMpdu);
   m_state->SwitchToTx (txDuration, packet, GetPowerDbm (txVector.GetTxPowerLevel ()), txVector, preamble);
+  //the listeners forget the CCA busy period when the transmission starts
+  m_ccaBusyAnnouncedEnd = Seconds (0);
   m_channel->Send (this, packet, GetPowerDbm (txVector.GetTxPowerLevel ()) + GetTxGain (), txVector, preamble, mpdutype, txDuration);
 }
 
@@ -722,13 +1542,21 @@ YansWifiPhy::UnregisterListener (WifiPhyListener *listener)
 void
 YansWifiPhy::EndReceive (Ptr<Packet> packet, enum WifiPreamble preamble, enum mpduType mpdutype, Ptr<InterferenceHelper::Event> event)
 {
+  YANS_WIFI_PROFILE_SCOPE (END_RECEIVE);
   NS_LOG_FUNCTION (this << packet << event);
   NS_ASSERT (IsStateRx ());
   NS_ASSERT (event->GetEndTime () == Simulator::Now ());
+  ApplyPlcpResets ();
 
   struct InterferenceHelper::SnrPer snrPer;
   snrPer = m_interference.CalculatePlcpPayloadSnrPer (event);
+  if (m_receptionPolicy == RECEPTION_SUBCHANNEL && m_rxSubchannelSignal.nSubchannels > 0)
+    {
+      snrPer.per = GetSubchannelPayloadPer ();
+    }
   m_interference.NotifyRxEnd ();
+  NotifySubchannelRxEnd ();
+  bool rxOk = false;
 
   if (m_plcpSuccess == true)
     {
@@ -737,6 +1565,7 @@ YansWifiPhy::EndReceive (Ptr<Packet> packet, enum WifiPreamble preamble, enum mp
 
       if (m_random->GetValue () > snrPer.per)
         {
+          rxOk = true;
           NotifyRxEnd (packet);
           uint32_t dataRate500KbpsUnits;
           if ((event->GetPayloadMode ().GetModulationClass () == WIFI_MOD_CLASS_HT) || (event->GetPayloadMode ().GetModulationClass () == WIFI_MOD_CLASS_VHT))
@@ -768,10 +1597,38 @@ YansWifiPhy::EndReceive (Ptr<Packet> packet, enum WifiPreamble preamble, enum mp
       m_state->SwitchFromRxEndError (packet, snrPer.snr);
     }
 
+  struct RxRecord record;
+  record.time = Simulator::Now ().GetNanoSeconds ();
+  record.sender = m_rxSenderId;
+  record.receiver = GetNodeId ();
+  record.rxPowerDbm = m_rxPowerDbm;
+  record.overlapFactorDb = m_rxOverlapFactorDb;
+  record.snr = snrPer.snr;
+  record.per = snrPer.per;
+  record.outcome = (m_plcpSuccess == false) ? RX_PLCP_ERROR : (rxOk ? RX_OK : RX_PAYLOAD_ERROR);
+  record.frequencyOffset = static_cast<int32_t> (GetFrequency ()) - static_cast<int32_t> (m_rxChannelFrequency);
+  record.senderWidth = m_rxChannelWidth;
+  record.receiverWidth = GetChannelWidth ();
+  m_rxOutcomeTrace (record);
+
   if (preamble == WIFI_PREAMBLE_NONE && mpdutype == LAST_MPDU_IN_AGGREGATE)
     {
       m_plcpSuccess = false;
     }
 }
 
+uint32_t
+YansWifiPhy::GetNodeId (void)
+{
+  if (m_nodeId == 0xffffffff)
+    {
+      Ptr<Object> device = GetDevice ();
+      if (device != 0)
+        {
+          m_nodeId = device->GetObject<NetDevice> ()->GetNode ()->GetId ();
+        }
+    }
+  return m_nodeId;
+}
+
 } //namespace ns3
@@ -55,12 +55,42 @@
 #ifndef YANS_WIFI_PHY_H
 #define YANS_WIFI_PHY_H
 
+#include <vector>
+#include <map>
+#include <ostream>
+#include <istream>
 #include "wifi-phy.h"
 
 namespace ns3 {
 
 class YansWifiChannel;
 
+/**
+ * The parameters of a packet arriving at a YansWifiPhy.
+ */
+struct Parameters
+{
+  double rxPowerDbm;
+  enum mpduType type;
+  Time duration;
+  WifiTxVector txVector;
+  WifiPreamble preamble;
+  uint32_t channelFrequency; //----------change
+  uint32_t channelWidth; //-------------change
+  uint32_t senderId;         //!< node id of the sender, 0xffffffff if unknown
+  double overlapFactorDb;    //!< overlap factor already included in rxPowerDbm
+
+  enum
+  {
+    MAX_SUBCHANNELS = 8      //!< maximum number of 20 MHz subchannels (160 MHz channel)
+  };
+  uint32_t nSubchannels;     //!< number of valid entries of subchannelRxPowerDbm, 0 if not computed
+  double subchannelRxPowerDbm[MAX_SUBCHANNELS]; //!< rx power in each 20 MHz subchannel of the receiver, lowest first
+
+  double rxPowerW;           //!< rxPowerDbm in W, 0 if not computed (see YansWifiChannel::LinearPowerPipeline)
+  double subchannelRxPowerW[MAX_SUBCHANNELS]; //!< subchannelRxPowerDbm in W, valid if rxPowerW is not 0
+};
+
 /**
  * \brief 802.11 PHY layer model
  * \ingroup wifi
@@ -79,6 +109,92 @@ class YansWifiChannel;
 class YansWifiPhy : public WifiPhy
 {
 public:
+  /**
+   * The reception logic used for the packets delivered by the channel.
+   */
+  enum ReceptionPolicy
+  {
+    RECEPTION_CO_CHANNEL = 0,  //!< stock ns-3.26: only packets on the same channel number, no primary channel check
+    RECEPTION_ACI,             //!< adjacent channel interference with the primary channel check
+    RECEPTION_SUBCHANNEL       //!< RECEPTION_ACI with per-20 MHz subchannel CCA and decoding
+  };
+
+  /**
+   * The reasons for which a packet arriving at the PHY is not received.
+   */
+  enum DropReason
+  {
+    DROP_SWITCHING = 0,           //!< the PHY is switching channel
+    DROP_ALREADY_RX,              //!< the PHY is already receiving another packet
+    DROP_ALREADY_TX,              //!< the PHY is transmitting
+    DROP_BELOW_ED,                //!< the rx power is below the energy detection threshold
+    DROP_PRIMARY_NOT_OVERLAPPING, //!< the primary channels of sender and receiver do not match
+    DROP_NO_PLCP,                 //!< no PLCP preamble/header was received for this MPDU
+    DROP_SLEEP,                   //!< the PHY is in sleep mode
+    DROP_REASON_COUNT             //!< number of drop reasons
+  };
+
+  /**
+   * The rx power histograms have 5 dB wide bins starting at -120 dBm.
+   * Powers outside [-120, 0) dBm are counted in the first or last bin.
+   */
+  enum
+  {
+    DROP_HISTOGRAM_BINS = 24
+  };
+
+  /**
+   * Per-reason drop counters and rx power histograms of a PHY.
+   */
+  struct DropStatistics
+  {
+    uint64_t count[DROP_REASON_COUNT];                          //!< number of drops per reason
+    uint64_t histogram[DROP_REASON_COUNT][DROP_HISTOGRAM_BINS]; //!< rx power (dBm) histogram per reason
+  };
+
+  /**
+   * TracedCallback signature for the periodic drop statistics samples.
+   *
+   * \param phy the PHY the statistics belong to
+   * \param statistics the drop statistics accumulated since the start of the simulation
+   */
+  typedef void (* DropStatisticsTracedCallback)(Ptr<const YansWifiPhy> phy, const struct DropStatistics &statistics);
+
+  /**
+   * The outcome of a reception the PHY synchronized on.
+   */
+  enum RxOutcome
+  {
+    RX_OK = 0,          //!< the packet was received successfully
+    RX_PAYLOAD_ERROR,   //!< the PLCP header was received but the payload was not
+    RX_PLCP_ERROR       //!< the PLCP preamble/header was not received or used an unsupported mode
+  };
+
+  /**
+   * The link metrics of a reception the PHY synchronized on.
+   */
+  struct RxRecord
+  {
+    int64_t time;            //!< end of the reception (ns)
+    uint32_t sender;         //!< node id of the sender, 0xffffffff if unknown
+    uint32_t receiver;       //!< node id of the receiver, 0xffffffff if unknown
+    double rxPowerDbm;       //!< receive power including the rx gain (dBm)
+    double overlapFactorDb;  //!< overlap factor of sender and receiver channels (dB)
+    double snr;              //!< payload SNR (linear)
+    double per;              //!< payload packet error rate
+    uint8_t outcome;         //!< the outcome, see RxOutcome
+    int32_t frequencyOffset; //!< central frequency of the receiver minus the one of the sender (MHz)
+    uint16_t senderWidth;    //!< channel width of the sender (MHz)
+    uint16_t receiverWidth;  //!< channel width of the receiver (MHz)
+  };
+
+  /**
+   * TracedCallback signature for reception outcomes.
+   *
+   * \param record the link metrics of the reception
+   */
+  typedef void (* RxOutcomeTracedCallback)(const struct RxRecord &record);
+
   static TypeId GetTypeId (void);
 
   YansWifiPhy ();
@@ -129,6 +245,26 @@ public:
                                       uint32_t channelFrequency,
                                       uint32_t channelWidth);
   //////////// END addition
+  /**
+   * Starting receiving the plcp of a packet (i.e. the first bit of the preamble has arrived).
+   * This is the variant used by YansWifiChannel, which also carries the
+   * sender and the overlap factor of the link for the reception traces.
+   *
+   * The packet may be shared with the other receivers: it is only copied
+   * if this PHY syncs to it.
+   *
+   * The packet is handled by the reception logic selected by the
+   * ReceptionPolicy attribute.
+   *
+   * \param packet the arriving packet
+   * \param parameters the reception parameters
+   */
+  void StartReceivePreambleAndHeader (Ptr<const Packet> packet,
+                                      struct Parameters parameters);
+  /**
+   * \return the reception policy of this PHY
+   */
+  enum ReceptionPolicy GetReceptionPolicy (void) const;
   /**
    * Starting receiving the payload of a packet (i.e. the first bit of the packet has arrived).
    *
@@ -144,6 +280,140 @@ public:
                            enum mpduType mpdutype,
                            Ptr<InterferenceHelper::Event> event);
 
+  /**
+   * Account for a reception that the channel did not deliver because this
+   * PHY was in SLEEP state or was switching channel for the whole duration
+   * of the signal. It has the same effect on the PLCP reception state as a
+   * packet dropped in StartReceivePreambleAndHeader, without the trace:
+   * once the first bit has arrived, the drop is counted and the PLCP
+   * success flag is reset. Until then, CancelSkippedReceptions can undo it.
+   *
+   * \param reason DROP_SLEEP or DROP_SWITCHING
+   * \param rxPowerDbm the receive power in dBm (without the rx gain)
+   * \param arrival the arrival time of the first bit
+   */
+  void NotifyReceptionSkipped (enum DropReason reason, double rxPowerDbm, Time arrival);
+  /**
+   * Forget the skipped receptions of the given reason whose first bit has
+   * not arrived yet, because the channel delivers them after all (e.g.,
+   * this PHY woke up before their arrival): they are neither counted as
+   * dropped nor reset the PLCP success flag.
+   *
+   * \param reason the drop reason given to NotifyReceptionSkipped
+   */
+  void CancelSkippedReceptions (enum DropReason reason);
+  /**
+   * Add a signal that this PHY cannot synchronize on to the interference
+   * tracker, starting now and lasting for the given duration. This is used
+   * by the channel for signals still on the air when this PHY wakes up.
+   *
+   * \param size the size of the packet in bytes
+   * \param parameters the reception parameters of the signal
+   * \param duration the remaining duration of the signal
+   */
+  void AddInterference (uint32_t size,
+                        const struct Parameters &parameters,
+                        Time duration);
+
+  /**
+   * \param channelFrequency the central frequency of the sender in MHz
+   * \param channelWidth the channel width of the sender in MHz
+   *
+   * \return whether this PHY could synchronize on a signal of the given
+   *         channel with its current channel and reception policy: the
+   *         primary channels must match and this PHY must be at least as
+   *         wide as the sender, unless the policy is RECEPTION_CO_CHANNEL
+   */
+  bool CanSync (uint32_t channelFrequency, uint32_t channelWidth) const;
+  /**
+   * The first bit of a signal this PHY cannot synchronize on (see CanSync)
+   * has arrived. The signal is added to the interference tracker, the CCA
+   * state and the drop counters are updated and m_plcpSuccess is reset
+   * exactly as StartReceivePreambleAndHeader would, but without a packet:
+   * no tag is read and the PhyRxDrop trace is not fired.
+   *
+   * CanSync is evaluated by the channel at send time and not again here,
+   * see the EnergyOnlyDelivery attribute of YansWifiChannel.
+   *
+   * \param size the size of the packet in bytes
+   * \param parameters the reception parameters
+   */
+  void StartReceiveEnergy (uint32_t size, const struct Parameters &parameters);
+
+  /**
+   * \return the number of 20 MHz subchannels of the current channel
+   *         (1 for channels of 20 MHz or less)
+   */
+  uint32_t GetNSubchannels (void) const;
+  /**
+   * \param k the subchannel, 0 being the lowest one, which is the primary channel
+   *
+   * \return the total power currently measured in the subchannel, in dBm:
+   *         the signals on the air plus the thermal noise of the subchannel,
+   *         so that an idle subchannel reads the noise floor
+   *
+   * The subchannel powers of the signals are only tracked with the
+   * Subchannel reception policy.
+   */
+  double GetSubchannelPowerDbm (uint32_t k) const;
+  /**
+   * \param k the subchannel, 0 being the lowest one, which is the primary channel
+   *
+   * \return whether the power in the subchannel is above CcaMode1Threshold
+   *         for the primary channel, or above SecondaryCcaThreshold for the
+   *         secondary subchannels
+   */
+  bool IsSubchannelCcaBusy (uint32_t k) const;
+  /**
+   * \param k the subchannel, 0 being the lowest one, which is the primary channel
+   *
+   * \return the SINR (linear) of the signal being received in the
+   *         subchannel at the start of the reception, as computed by the
+   *         InterferenceHelper of the subchannel, or 0 if the PHY is not
+   *         receiving
+   */
+  double GetSubchannelSinr (uint32_t k) const;
+
+  /**
+   * \param reason the drop reason
+   *
+   * \return the number of packets dropped for the given reason
+   */
+  uint64_t GetDropCount (enum DropReason reason) const;
+  /**
+   * \return the per-reason drop counters and rx power histograms
+   */
+  const struct DropStatistics & GetDropStatistics (void) const;
+  /**
+   * Reset all drop counters and rx power histograms to zero.
+   */
+  void ResetDropStatistics (void);
+
+  /**
+   * Write the reception state of the PHY as one text record: the PHY
+   * state and the time left in it, the A-MPDU reception counters, the
+   * time left until the pending end of PLCP header and end of reception
+   * events, the signals still on the air (only recorded if the
+   * RecordSignals attribute is set) and, with the Subchannel reception
+   * policy, their power in each subchannel.
+   *
+   * \param os the output stream
+   */
+  void SaveState (std::ostream &os) const;
+  /**
+   * Restore a record written by SaveState into this PHY, which must be
+   * idle or CCA busy, at the current simulation time. The signals on the
+   * air are added to the interference tracker, and to the subchannel
+   * trackers with the Subchannel reception policy, for their remaining
+   * duration and the PHY goes to CCA busy or sleep accordingly. A frame
+   * being received when the state was saved cannot be resumed (its
+   * packet is not saved): its energy is restored as interference and
+   * the reception counts as failed.
+   *
+   * \param is the input stream
+   */
+  void RestoreState (std::istream &is);
+
   virtual void SetReceiveOkCallback (WifiPhy::RxOkCallback callback);
   virtual void SetReceiveErrorCallback (WifiPhy::RxErrorCallback callback);
   virtual void SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, enum WifiPreamble preamble);
@@ -171,7 +441,289 @@ private:
    */
   void EndReceive (Ptr<Packet> packet, enum WifiPreamble preamble, enum mpduType mpdutype, Ptr<InterferenceHelper::Event> event);
 
+  class StartReceivePacketEvent;
+  class EndReceiveEvent;
+  friend class StartReceivePacketEvent;
+  friend class EndReceiveEvent;
+
+  /**
+   * Reception policy of the stock ns-3.26 YansWifiPhy.
+   */
+  struct CoChannelReception
+  {
+    enum
+    {
+      CHECK_PRIMARY = 0,      //!< whether the primary channels of sender and receiver must match
+      TRACK_SUBCHANNELS = 0   //!< whether the subchannel powers are tracked
+    };
+  };
+  /**
+   * Reception policy with adjacent channel interference.
+   */
+  struct AciReception
+  {
+    enum
+    {
+      CHECK_PRIMARY = 1,      //!< whether the primary channels of sender and receiver must match
+      TRACK_SUBCHANNELS = 0   //!< whether the subchannel powers are tracked
+    };
+  };
+  /**
+   * Reception policy with adjacent channel interference and subchannel powers.
+   */
+  struct SubchannelReception
+  {
+    enum
+    {
+      CHECK_PRIMARY = 1,      //!< whether the primary channels of sender and receiver must match
+      TRACK_SUBCHANNELS = 1   //!< whether the subchannel powers are tracked
+    };
+  };
+
+  /**
+   * Starting receiving the plcp of a packet (i.e. the first bit of the
+   * preamble has arrived). All the StartReceivePreambleAndHeader variants
+   * end up here; the policy is resolved at compile time so that each
+   * variant has its own branch-free copy of the reception logic.
+   *
+   * \tparam Policy CoChannelReception, AciReception or SubchannelReception
+   * \param packet the arriving packet, possibly shared with other receivers
+   * \param parameters the reception parameters
+   */
+  template <class Policy>
+  void StartReceive (Ptr<const Packet> packet, const struct Parameters &parameters);
+  /**
+   * \param channelFrequency the central frequency of the sender in MHz
+   * \param channelWidth the channel width of the sender in MHz
+   *
+   * \return whether the primary channel of this PHY matches the one of the
+   *         sender and this PHY is at least as wide as the sender
+   */
+  bool IsPrimaryOverlapping (uint32_t channelFrequency, uint32_t channelWidth) const;
+  /**
+   * \return the rx gain as a linear factor, converted again only when the RxGain attribute changes
+   */
+  double GetRxGainW (void) const;
+  /**
+   * \return the CCA mode 1 threshold in W, converted again only when the CcaMode1Threshold attribute changes
+   */
+  double GetCcaMode1ThresholdW (void) const;
+  /**
+   * \param parameters the reception parameters
+   *
+   * \return the rx power including the rx gain in W, from the linear power
+   *         of the parameters if the channel computed it
+   */
+  double GetRxPowerW (const struct Parameters &parameters) const;
+  /**
+   * \param policy the reception policy used for the packets delivered by the channel
+   */
+  void SetReceptionPolicy (enum ReceptionPolicy policy);
+
+  /**
+   * Reset the PLCP success flag for the skipped receptions that arrived
+   * by now. Called before the flag is read or written.
+   */
+  void ApplyPlcpResets (void);
+  /**
+   * Count the skipped receptions that arrived by now as dropped, and
+   * remember that the PLCP success flag has to be reset.
+   */
+  void CountSkippedArrivals (void) const;
+  /**
+   * Count a dropped packet.
+   *
+   * \param reason the drop reason
+   * \param rxPowerDbm the receive power in dBm
+   */
+  void CountDrop (enum DropReason reason, double rxPowerDbm) const;
+  /**
+   * \tparam reason the drop reason
+   *
+   * \return the number of packets dropped for the given reason
+   */
+  template <enum DropReason reason>
+  uint64_t GetDropCountOf (void) const;
+  /**
+   * Set the interval at which the DropStatistics trace source is fired.
+   *
+   * \param interval the sampling interval, zero to disable sampling
+   */
+  void SetDropSampleInterval (Time interval);
+  /**
+   * \return the interval at which the DropStatistics trace source is fired
+   */
+  Time GetDropSampleInterval (void) const;
+  /**
+   * Fire the DropStatistics trace source and schedule the next sample.
+   */
+  void SampleDropStatistics (void);
+
   Ptr<YansWifiChannel> m_channel;        //!< YansWifiChannel that this YansWifiPhy is connected to
+  enum ReceptionPolicy m_receptionPolicy; //!< Reception policy for the packets delivered by the channel
+  void (YansWifiPhy::*m_startReceive) (Ptr<const Packet>, const struct Parameters &); //!< StartReceive instance of m_receptionPolicy
+  mutable struct DropStatistics m_dropStatistics; //!< Per-reason drop counters and rx power histograms
+  Time m_dropSampleInterval;             //!< Interval between two DropStatistics samples
+  EventId m_dropSampleEvent;             //!< Next DropStatistics sample
+  mutable std::multimap<Time, std::pair<enum DropReason, double> > m_skippedArrivals; //!< Skipped receptions still to arrive: drop reason and rx power (dBm) by arrival time
+  mutable bool m_skippedPlcpReset;      //!< Whether a skipped reception arrived since the PLCP success flag was last updated
+
+  /**
+   * Periodic samples of the drop statistics.
+   */
+  TracedCallback<Ptr<const YansWifiPhy>, const struct DropStatistics &> m_dropStatisticsTrace;
+
+  /**
+   * \return the node id of this PHY, 0xffffffff if it has no device yet
+   */
+  uint32_t GetNodeId (void);
+
+  /**
+   * A signal on the air, split into the 20 MHz subchannels of this PHY.
+   */
+  struct SubchannelSignal
+  {
+    Time end;                                       //!< end of the signal
+    uint32_t nSubchannels;                          //!< number of valid entries of powerW
+    double powerW[Parameters::MAX_SUBCHANNELS];     //!< power in each subchannel, with the rx gain
+  };
+
+  /**
+   * Track the subchannel powers of a new signal and add it to the
+   * InterferenceHelper of each subchannel. A signal for which the channel
+   * did not compute the subchannel powers is counted on the primary
+   * subchannel with its whole power. The signals that are over are forgotten.
+   *
+   * \param size the size of the packet in bytes
+   * \param parameters the reception parameters of the signal
+   * \param duration the duration of the signal
+   * \param powerW the rx power of the whole signal with the rx gain in W
+   * \param events if not 0, receives the InterferenceHelper event of each subchannel
+   *
+   * \return the tracked signal
+   */
+  struct SubchannelSignal AddSubchannelSignal (uint32_t size, const struct Parameters &parameters, Time duration,
+                                               double powerW, Ptr<InterferenceHelper::Event> *events);
+  /**
+   * Add a signal to the InterferenceHelper of each of its subchannels and
+   * to the tracked signals, and forget the signals that are over.
+   *
+   * \param size the size of the packet in bytes
+   * \param txVector the TxVector of the signal in each subchannel
+   * \param preamble the preamble of the packet
+   * \param signal the signal
+   * \param events if not 0, receives the InterferenceHelper event of each subchannel
+   */
+  void TrackSubchannelSignal (uint32_t size, const WifiTxVector &txVector, enum WifiPreamble preamble,
+                              const struct SubchannelSignal &signal, Ptr<InterferenceHelper::Event> *events);
+  /**
+   * \return the time until CCA mode 1 turns idle: on the primary 20 MHz
+   *         subchannel with the Subchannel reception policy, as 802.11ac
+   *         does, and on the whole channel otherwise
+   */
+  Time GetDelayUntilCcaEnd (void);
+  /**
+   * \return the thermal noise of a 20 MHz subchannel (or of the whole
+   *         channel if narrower) times the noise figure, in W
+   */
+  double GetSubchannelNoiseW (void) const;
+  /**
+   * \return the PER of the payload of the reception being synchronized on:
+   *         each subchannel covered by the sender carries its share of the
+   *         bits at its own SINR, and the payload is received if all of
+   *         them are
+   */
+  double GetSubchannelPayloadPer (void);
+  /**
+   * Forget the subchannel signals and the events of the InterferenceHelper
+   * of each subchannel.
+   */
+  void ClearSubchannelSignals (void);
+  /**
+   * Give the InterferenceHelper of each subchannel the noise figure and
+   * the error rate model of the PHY, if they changed since the last call.
+   * The setters of WifiPhy are not virtual, hence the check.
+   */
+  void ConfigureSubchannelInterference (void);
+  /**
+   * Notify the InterferenceHelper of each subchannel that a reception starts.
+   */
+  void NotifySubchannelRxStart (void);
+  /**
+   * Notify the InterferenceHelper of each subchannel that a reception ends.
+   */
+  void NotifySubchannelRxEnd (void);
+  /**
+   * \param k the subchannel
+   *
+   * \return the total power of the signals currently on the air in subchannel k, in W
+   */
+  double GetSubchannelPowerW (uint32_t k) const;
+  /**
+   * \param threshold the secondary channel CCA threshold in dBm
+   */
+  void SetSecondaryCcaThreshold (double threshold);
+  /**
+   * \return the secondary channel CCA threshold in dBm
+   */
+  double GetSecondaryCcaThreshold (void) const;
+
+  /**
+   * A signal added to the interference tracker, recorded for SaveState.
+   */
+  struct EnergySignal
+  {
+    Time end;                    //!< end of the signal
+    double powerW;               //!< rx power with the rx gain in W
+    uint32_t size;               //!< size of the packet in bytes
+    enum WifiPreamble preamble;  //!< preamble of the packet
+  };
+
+  /**
+   * Record a signal added to the interference tracker, if RecordSignals
+   * is set, and forget the signals that are over.
+   *
+   * \param size the size of the packet in bytes
+   * \param preamble the preamble of the packet
+   * \param duration the duration of the signal
+   * \param powerW the rx power with the rx gain in W
+   */
+  void RecordEnergySignal (uint32_t size, enum WifiPreamble preamble, Time duration, double powerW);
+
+  /**
+   * Notify the listeners that CCA is busy until the aggregated energy
+   * drops below the CCA mode 1 threshold (see GetDelayUntilCcaEnd),
+   * unless this was already announced (see the CoalesceCcaBusy attribute).
+   */
+  void MaybeCcaBusy (void);
+
+  bool m_coalesceCcaBusy;                //!< Whether CCA busy notifications are coalesced
+  Time m_ccaBusyAnnouncedEnd;            //!< End of the CCA busy period last announced to the listeners, reset on TX, RX, sleep and channel switch
+  bool m_recordSignals;                  //!< Whether the signals on the air are recorded for SaveState
+  std::vector<struct EnergySignal> m_energySignals; //!< Signals on the air, if m_recordSignals
+  std::vector<struct SubchannelSignal> m_subchannelSignals; //!< Signals on the air, per subchannel
+  struct SubchannelSignal m_rxSubchannelSignal;  //!< Subchannel powers of the reception being synchronized on
+  mutable std::vector<InterferenceHelper> m_subchannelInterference; //!< Interference in each subchannel, empty unless RECEPTION_SUBCHANNEL
+  double m_subchannelNoiseFigure;        //!< Noise figure given to m_subchannelInterference
+  Ptr<ErrorRateModel> m_subchannelErrorRateModel; //!< Error rate model given to m_subchannelInterference
+  Ptr<InterferenceHelper::Event> m_rxSubchannelEvents[Parameters::MAX_SUBCHANNELS]; //!< Subchannel events of the reception being synchronized on
+  double m_secondaryCcaThresholdW;       //!< CCA threshold of the secondary subchannels in W
+  mutable double m_rxGainDb;             //!< RxGain when m_rxGainW was computed
+  mutable double m_rxGainW;              //!< RxGain as a linear factor
+  mutable double m_ccaThresholdDbm;      //!< CcaMode1Threshold when m_ccaThresholdW was computed
+  mutable double m_ccaThresholdW;        //!< CcaMode1Threshold in W
+
+  uint32_t m_nodeId;                     //!< Cached node id of this PHY
+  uint32_t m_rxSenderId;                 //!< Sender of the reception being synchronized on
+  double m_rxPowerDbm;                   //!< Rx power of the reception being synchronized on
+  double m_rxOverlapFactorDb;            //!< Overlap factor of the reception being synchronized on
+  uint32_t m_rxChannelFrequency;         //!< Central frequency of the sender of the reception being synchronized on
+  uint32_t m_rxChannelWidth;             //!< Channel width of the sender of the reception being synchronized on
+
+  /**
+   * The link metrics of every reception the PHY synchronized on.
+   */
+  TracedCallback<const struct RxRecord &> m_rxOutcomeTrace;
 };
 
 } //namespace ns3
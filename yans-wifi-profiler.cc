@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#include "yans-wifi-profiler.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <cstring>
+#include <time.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiProfiler");
+
+namespace {
+
+/**
+ * A timed call kept for the Chrome trace.
+ */
+struct TraceEvent
+{
+  uint64_t start;     //!< wall time at the start of the call (ns)
+  uint64_t duration;  //!< wall time spent in the call (ns)
+  uint32_t context;   //!< simulation context of the call
+  uint8_t section;    //!< section of the call
+};
+
+/**
+ * The state of the profiler.
+ */
+struct ProfilerState
+{
+  uint64_t calls[YansWifiProfiler::SECTION_COUNT];                                  //!< call counts
+  uint64_t time[YansWifiProfiler::SECTION_COUNT];                                   //!< total wall time (ns)
+  uint64_t histogram[YansWifiProfiler::SECTION_COUNT][YansWifiProfiler::HISTOGRAM_BINS]; //!< wall time histograms
+  std::vector<TraceEvent> events;  //!< recorded calls for the Chrome trace
+  uint32_t maxEvents;              //!< maximum number of recorded calls
+  bool tracing;                    //!< whether calls are recorded
+  std::string filename;            //!< name of the Chrome trace file
+  uint64_t origin;                 //!< wall time when tracing was enabled (ns)
+};
+
+ProfilerState &
+GetState (void)
+{
+  static ProfilerState state;
+  static bool initialized = false;
+  if (!initialized)
+    {
+      std::memset (state.calls, 0, sizeof (state.calls));
+      std::memset (state.time, 0, sizeof (state.time));
+      std::memset (state.histogram, 0, sizeof (state.histogram));
+      state.maxEvents = 0;
+      state.tracing = false;
+      state.origin = 0;
+      initialized = true;
+    }
+  return state;
+}
+
+} //anonymous namespace
+
+YansWifiProfiler::Scope::Scope (enum Section section)
+  : m_section (section),
+    m_start (GetWallTime ())
+{
+}
+
+YansWifiProfiler::Scope::~Scope ()
+{
+  Record (m_section, m_start, GetWallTime ());
+}
+
+uint64_t
+YansWifiProfiler::GetWallTime (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t> (ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void
+YansWifiProfiler::Record (enum Section section, uint64_t start, uint64_t end)
+{
+  ProfilerState &state = GetState ();
+  uint64_t duration = end - start;
+  uint32_t bin = 0;
+  while (bin < HISTOGRAM_BINS - 1 && (duration >> bin) != 0)
+    {
+      bin++;
+    }
+  state.calls[section]++;
+  state.time[section] += duration;
+  state.histogram[section][bin]++;
+  if (state.tracing && state.events.size () < state.maxEvents)
+    {
+      TraceEvent event;
+      event.start = start - state.origin;
+      event.duration = duration;
+      event.context = Simulator::GetContext ();
+      event.section = section;
+      state.events.push_back (event);
+    }
+}
+
+const char *
+YansWifiProfiler::GetName (enum Section section)
+{
+  switch (section)
+    {
+    case CHANNEL_SEND:
+      return "YansWifiChannel::Send";
+    case OVERLAP_FACTOR:
+      return "overlapFactor";
+    case CHANNEL_RECEIVE:
+      return "YansWifiChannel::Receive";
+    case START_RECEIVE_PREAMBLE:
+      return "YansWifiPhy::StartReceivePreambleAndHeader";
+    case START_RECEIVE_PACKET:
+      return "YansWifiPhy::StartReceivePacket";
+    case END_RECEIVE:
+      return "YansWifiPhy::EndReceive";
+    default:
+      return "unknown";
+    }
+}
+
+uint64_t
+YansWifiProfiler::GetCallCount (enum Section section)
+{
+  return GetState ().calls[section];
+}
+
+uint64_t
+YansWifiProfiler::GetTotalTime (enum Section section)
+{
+  return GetState ().time[section];
+}
+
+uint64_t
+YansWifiProfiler::GetHistogramCount (enum Section section, uint32_t bin)
+{
+  NS_ASSERT (bin < HISTOGRAM_BINS);
+  return GetState ().histogram[section][bin];
+}
+
+void
+YansWifiProfiler::Reset (void)
+{
+  ProfilerState &state = GetState ();
+  std::memset (state.calls, 0, sizeof (state.calls));
+  std::memset (state.time, 0, sizeof (state.time));
+  std::memset (state.histogram, 0, sizeof (state.histogram));
+  state.events.clear ();
+}
+
+void
+YansWifiProfiler::Print (std::ostream &os)
+{
+  ProfilerState &state = GetState ();
+  for (uint32_t i = 0; i < SECTION_COUNT; i++)
+    {
+      os << GetName (static_cast<enum Section> (i))
+         << " calls=" << state.calls[i]
+         << " total(ms)=" << state.time[i] / 1e6
+         << " mean(ns)=" << (state.calls[i] > 0 ? state.time[i] / state.calls[i] : 0)
+         << std::endl;
+    }
+}
+
+void
+YansWifiProfiler::EnableChromeTrace (std::string filename, uint32_t maxEvents)
+{
+  NS_LOG_FUNCTION (filename << maxEvents);
+  ProfilerState &state = GetState ();
+  if (!state.tracing)
+    {
+      Simulator::ScheduleDestroy (&YansWifiProfiler::WriteChromeTrace);
+    }
+  state.filename = filename;
+  state.maxEvents = maxEvents;
+  state.events.clear ();
+  state.events.reserve (maxEvents);
+  state.origin = GetWallTime ();
+  state.tracing = true;
+}
+
+void
+YansWifiProfiler::WriteChromeTrace (void)
+{
+  ProfilerState &state = GetState ();
+  if (!state.tracing)
+    {
+      return;
+    }
+  state.tracing = false;
+  std::ofstream os (state.filename.c_str ());
+  NS_ABORT_MSG_IF (!os.is_open (), "Could not open Chrome trace file " << state.filename);
+  NS_LOG_DEBUG ("writing " << state.events.size () << " events to " << state.filename);
+  //complete events, time stamps and durations in microseconds
+  os << "{\"traceEvents\":[";
+  for (std::vector<TraceEvent>::const_iterator i = state.events.begin (); i != state.events.end (); i++)
+    {
+      if (i != state.events.begin ())
+        {
+          os << ",";
+        }
+      os << "\n{\"name\":\"" << GetName (static_cast<enum Section> (i->section)) << "\""
+         << ",\"ph\":\"X\",\"pid\":0"
+         << ",\"tid\":" << i->context
+         << ",\"ts\":" << i->start / 1000 << "." << std::setw (3) << std::setfill ('0') << i->start % 1000
+         << ",\"dur\":" << i->duration / 1000 << "." << std::setw (3) << std::setfill ('0') << i->duration % 1000
+         << "}";
+    }
+  os << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+  state.events.clear ();
+}
+
+} //namespace ns3
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#ifndef YANS_WIFI_PROFILER_H
+#define YANS_WIFI_PROFILER_H
+
+#include <stdint.h>
+#include <string>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \brief Scoped wall-clock timers for the hot paths of YansWifiChannel and YansWifiPhy
+ * \ingroup wifi
+ *
+ * Each instrumented section aggregates a call count, the total wall time
+ * and a histogram of the wall time per call with power-of-two nanosecond
+ * bins. Optionally, every call is also recorded as a complete event
+ * that can be written in the Chrome trace / Perfetto JSON format, with
+ * the simulation context (node id) as thread id.
+ *
+ * The timers are only compiled in when the wifi module is built with
+ * YANS_WIFI_PROFILING defined, e.g.,
+ * CXXFLAGS="-DYANS_WIFI_PROFILING" ./waf configure. Otherwise
+ * YANS_WIFI_PROFILE_SCOPE expands to nothing and all the counters stay at zero.
+ */
+class YansWifiProfiler
+{
+public:
+  /**
+   * The instrumented sections.
+   */
+  enum Section
+  {
+    CHANNEL_SEND = 0,        //!< YansWifiChannel::Send
+    OVERLAP_FACTOR,          //!< overlap factor computation of YansWifiChannel
+    CHANNEL_RECEIVE,         //!< YansWifiChannel::Receive
+    START_RECEIVE_PREAMBLE,  //!< YansWifiPhy::StartReceivePreambleAndHeader
+    START_RECEIVE_PACKET,    //!< YansWifiPhy::StartReceivePacket
+    END_RECEIVE,             //!< YansWifiPhy::EndReceive
+    SECTION_COUNT            //!< number of sections
+  };
+
+  /**
+   * Number of bins of the wall time histograms. Bin i counts the calls
+   * that took between 2^(i-1) and 2^i nanoseconds.
+   */
+  enum
+  {
+    HISTOGRAM_BINS = 40
+  };
+
+  /**
+   * Time the enclosing C++ scope and account it to a section.
+   */
+  class Scope
+  {
+  public:
+    /**
+     * \param section the section the scope belongs to
+     */
+    Scope (enum Section section);
+    ~Scope ();
+  private:
+    enum Section m_section; //!< the section the scope belongs to
+    uint64_t m_start;       //!< wall time at the start of the scope (ns)
+  };
+
+  /**
+   * \param section the section
+   * \return the name of the section
+   */
+  static const char * GetName (enum Section section);
+  /**
+   * \param section the section
+   * \return the number of calls of the section
+   */
+  static uint64_t GetCallCount (enum Section section);
+  /**
+   * \param section the section
+   * \return the total wall time spent in the section (ns)
+   */
+  static uint64_t GetTotalTime (enum Section section);
+  /**
+   * \param section the section
+   * \param bin the histogram bin, smaller than HISTOGRAM_BINS
+   * \return the number of calls of the section falling in the given bin
+   */
+  static uint64_t GetHistogramCount (enum Section section, uint32_t bin);
+  /**
+   * Reset all counters and discard the recorded trace events.
+   */
+  static void Reset (void);
+  /**
+   * Print the call counts, total and mean wall times of all sections.
+   *
+   * \param os the output stream
+   */
+  static void Print (std::ostream &os);
+
+  /**
+   * Start recording every timed call for the Chrome trace. The trace is
+   * written to the given file when Simulator::Destroy is called, or
+   * earlier with WriteChromeTrace.
+   *
+   * \param filename the name of the JSON file to write
+   * \param maxEvents the maximum number of events kept in memory; later
+   *        calls are still counted but not recorded
+   */
+  static void EnableChromeTrace (std::string filename, uint32_t maxEvents);
+  /**
+   * Write the recorded calls to the file given to EnableChromeTrace and
+   * stop recording.
+   */
+  static void WriteChromeTrace (void);
+
+  /**
+   * \return a monotonic wall-clock time stamp in nanoseconds
+   */
+  static uint64_t GetWallTime (void);
+
+private:
+  /**
+   * Account one call to a section.
+   *
+   * \param section the section
+   * \param start the wall time at the start of the call (ns)
+   * \param end the wall time at the end of the call (ns)
+   */
+  static void Record (enum Section section, uint64_t start, uint64_t end);
+};
+
+} //namespace ns3
+
+#ifdef YANS_WIFI_PROFILING
+#define YANS_WIFI_PROFILE_SCOPE(section) \
+  ns3::YansWifiProfiler::Scope yansWifiProfilerScope (ns3::YansWifiProfiler::section)
+#else
+#define YANS_WIFI_PROFILE_SCOPE(section)
+#endif
+
+#endif /* YANS_WIFI_PROFILER_H */
@@ -0,0 +1,322 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+
+#include "yans-wifi-progress-reporter.h"
+#include "yans-wifi-channel.h"
+#include "yans-wifi-bucket-scheduler.h"
+#include "ns3/simulator.h"
+#include "ns3/channel-list.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdio>
+#include <algorithm>
+#include <time.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiProgressReporter");
+
+NS_OBJECT_ENSURE_REGISTERED (YansWifiProgressReporter);
+
+TypeId
+YansWifiProgressReporter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::YansWifiProgressReporter")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<YansWifiProgressReporter> ()
+    .AddAttribute ("WallInterval",
+                   "The wall-clock time in s between two reports.",
+                   DoubleValue (10.0),
+                   MakeDoubleAccessor (&YansWifiProgressReporter::m_wallInterval),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("CheckInterval",
+                   "The simulated time between two checks of the wall clock. A report is late by "
+                   "at most the wall-clock time it takes to simulate this interval.",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&YansWifiProgressReporter::m_checkInterval),
+                   MakeTimeChecker (NanoSeconds (1)))
+  ;
+  return tid;
+}
+
+YansWifiProgressReporter::YansWifiProgressReporter ()
+  : m_wallInterval (10.0),
+    m_running (false),
+    m_wallStart (0.0),
+    m_lastUid (0),
+    m_knownChannels (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+YansWifiProgressReporter::~YansWifiProgressReporter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+YansWifiProgressReporter::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Stop ();
+  Object::DoDispose ();
+}
+
+void
+YansWifiProgressReporter::Start (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ABORT_MSG_IF (m_running, "Progress reporter already started");
+  if (!filename.empty ())
+    {
+      m_file.open (filename.c_str (), std::ios::out);
+      NS_ABORT_MSG_IF (!m_file.is_open (), "Could not open progress report file " << filename);
+    }
+  m_running = true;
+  m_wallStart = GetWallClock ();
+  m_checkEvent = Simulator::Schedule (m_checkInterval, &YansWifiProgressReporter::Check, this);
+  m_lastUid = m_checkEvent.GetUid ();
+  UpdateChannels ();
+  m_last = TakeSample ();
+  Simulator::ScheduleDestroy (&YansWifiProgressReporter::Stop, this);
+}
+
+void
+YansWifiProgressReporter::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_running)
+    {
+      return;
+    }
+  m_checkEvent.Cancel ();
+  Report ();
+  m_running = false;
+  m_channels.clear ();
+  m_knownChannels = 0;
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+}
+
+double
+YansWifiProgressReporter::GetWallClock (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+uint64_t
+YansWifiProgressReporter::GetResidentSetSize (void)
+{
+  //second field of statm: resident pages
+  FILE *statm = std::fopen ("/proc/self/statm", "r");
+  if (statm == 0)
+    {
+      return 0;
+    }
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  int read = std::fscanf (statm, "%lu %lu", &size, &resident);
+  std::fclose (statm);
+  if (read != 2)
+    {
+      return 0;
+    }
+  return static_cast<uint64_t> (resident) * sysconf (_SC_PAGESIZE);
+}
+
+uint64_t
+YansWifiProgressReporter::GetDelta (uint64_t now, uint64_t last)
+{
+  return (now > last) ? now - last : 0;
+}
+
+void
+YansWifiProgressReporter::UpdateChannels (void)
+{
+  //the ChannelList only grows while the simulation runs
+  for (uint32_t i = m_knownChannels; i < ChannelList::GetNChannels (); i++)
+    {
+      Ptr<YansWifiChannel> channel = DynamicCast<YansWifiChannel> (ChannelList::GetChannel (i));
+      if (channel != 0)
+        {
+          m_channels.push_back (channel);
+        }
+    }
+  m_knownChannels = std::max (m_knownChannels, ChannelList::GetNChannels ());
+}
+
+struct YansWifiProgressReporter::Sample
+YansWifiProgressReporter::TakeSample (void) const
+{
+  struct Sample sample;
+  sample.wallS = GetWallClock () - m_wallStart;
+  sample.simS = Simulator::Now ().GetSeconds ();
+  const YansWifiBucketScheduler *scheduler = YansWifiBucketScheduler::GetCurrent ();
+  if (scheduler != 0)
+    {
+      sample.events = scheduler->GetNRemoved ();
+      sample.queue = scheduler->GetSize ();
+    }
+  else
+    {
+      //uids are given in scheduling order
+      sample.events = m_lastUid;
+      sample.queue = -1;
+    }
+  sample.sends = 0;
+  sample.receivers = 0;
+  sample.overlapLookups = 0;
+  sample.overlapComputed = 0;
+  sample.linkLookups = 0;
+  sample.linkHits = 0;
+  for (std::vector<Ptr<YansWifiChannel> >::const_iterator it = m_channels.begin (); it != m_channels.end (); it++)
+    {
+      const struct YansWifiChannel::FanOutStatistics &stats = (*it)->GetFanOutStatistics ();
+      sample.sends += stats.sends;
+      sample.receivers += stats.receivers;
+      sample.overlapLookups += stats.overlapLookups;
+      sample.overlapComputed += stats.overlapComputed;
+      sample.linkLookups += stats.linkLookups;
+      sample.linkHits += stats.linkHits;
+    }
+  sample.rssBytes = GetResidentSetSize ();
+  return sample;
+}
+
+void
+YansWifiProgressReporter::Check (void)
+{
+  m_checkEvent = Simulator::Schedule (m_checkInterval, &YansWifiProgressReporter::Check, this);
+  m_lastUid = m_checkEvent.GetUid ();
+  if (GetWallClock () - m_wallStart - m_last.wallS >= m_wallInterval)
+    {
+      UpdateChannels ();
+      Report ();
+    }
+}
+
+void
+YansWifiProgressReporter::Report (void)
+{
+  struct Sample sample = TakeSample ();
+  double wall = std::max (sample.wallS - m_last.wallS, 1e-9);
+  double simRate = (sample.simS - m_last.simS) / wall;
+  //clamped, in case a counter went back (e.g., a scheduler replaced with Simulator::SetScheduler)
+  double eventRate = GetDelta (sample.events, m_last.events) / wall;
+  uint64_t sends = GetDelta (sample.sends, m_last.sends);
+  double sendRate = sends / wall;
+  double receiversPerSend = (sends > 0) ? static_cast<double> (GetDelta (sample.receivers, m_last.receivers)) / sends : 0.0;
+  //the hit rates are negative when there was no lookup
+  uint64_t overlapLookups = GetDelta (sample.overlapLookups, m_last.overlapLookups);
+  uint64_t overlapComputed = GetDelta (sample.overlapComputed, m_last.overlapComputed);
+  double overlapHitRate = -1.0;
+  if (overlapLookups > 0)
+    {
+      overlapHitRate = (overlapComputed < overlapLookups) ?
+        1.0 - static_cast<double> (overlapComputed) / overlapLookups : 0.0;
+    }
+  uint64_t linkLookups = GetDelta (sample.linkLookups, m_last.linkLookups);
+  double linkHitRate = (linkLookups > 0) ?
+    std::min (1.0, static_cast<double> (GetDelta (sample.linkHits, m_last.linkHits)) / linkLookups) : -1.0;
+  m_last = sample;
+
+  std::ostringstream line;
+  if (m_file.is_open ())
+    {
+      line << std::setprecision (6)
+           << "{\"wall\":" << sample.wallS
+           << ",\"sim\":" << sample.simS
+           << ",\"simPerWall\":" << simRate
+           << ",\"eventsPerSecond\":" << eventRate
+           << ",\"eventsExact\":" << ((sample.queue >= 0) ? "true" : "false")
+           << ",\"sendsPerSecond\":" << sendRate
+           << ",\"receiversPerSend\":" << receiversPerSend;
+      line << ",\"overlapHitRate\":";
+      if (overlapHitRate >= 0)
+        {
+          line << overlapHitRate;
+        }
+      else
+        {
+          line << "null";
+        }
+      line << ",\"linkHitRate\":";
+      if (linkHitRate >= 0)
+        {
+          line << linkHitRate;
+        }
+      else
+        {
+          line << "null";
+        }
+      line << ",\"queue\":";
+      if (sample.queue >= 0)
+        {
+          line << sample.queue;
+        }
+      else
+        {
+          line << "null";
+        }
+      line << ",\"rss\":" << sample.rssBytes << "}";
+      m_file << line.str () << std::endl;
+      return;
+    }
+  line << std::fixed << std::setprecision (1)
+       << "progress: wall " << sample.wallS << " s, sim " << std::setprecision (6) << sample.simS << " s"
+       << std::setprecision (3) << " (" << simRate << " sim s/s), "
+       << std::setprecision (0) << eventRate << ((sample.queue >= 0) ? " events/s, " : " events scheduled/s, ")
+       << sendRate << " sends/s, " << std::setprecision (1) << receiversPerSend << " rx/send";
+  if (overlapHitRate >= 0)
+    {
+      line << ", overlap hits " << overlapHitRate * 100 << "%";
+    }
+  if (linkHitRate >= 0)
+    {
+      line << ", link hits " << linkHitRate * 100 << "%";
+    }
+  if (sample.queue >= 0)
+    {
+      line << ", queue " << sample.queue;
+    }
+  line << ", rss " << sample.rssBytes / 1048576.0 << " MB";
+  std::cerr << line.str () << std::endl;
+}
+
+} //namespace ns3
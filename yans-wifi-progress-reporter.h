@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+
+#ifndef YANS_WIFI_PROGRESS_REPORTER_H
+#define YANS_WIFI_PROGRESS_REPORTER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+
+namespace ns3 {
+
+class YansWifiChannel;
+
+/**
+ * \brief Periodic report of the throughput of a running simulation
+ * \ingroup wifi
+ *
+ * Once started, the reporter checks the wall clock every CheckInterval of
+ * simulated time and, every WallInterval of wall-clock time, reports the
+ * rates since the previous report: simulated seconds and events run per
+ * wall-clock second, YansWifiChannel::Send calls per second, receivers
+ * visited per call, the shares of the overlap factors and of the link
+ * losses read from the channel caches, the number of events in the
+ * scheduler queue and the resident set size of the process. The channel
+ * counters are summed over all the YansWifiChannels of the ChannelList.
+ * The reporter keeps a reference to these channels until it stops, so
+ * that the last report, written while the simulator is destroyed, still
+ * reads their counters once the ChannelList has been emptied.
+ *
+ * The events run and the queue depth are only known exactly with the
+ * YansWifiBucketScheduler. With the other schedulers, the events run are
+ * estimated from the number of events scheduled and the queue depth is
+ * not reported.
+ *
+ * Reports are written to stderr, or as one JSON object per line to a file.
+ * The reporter schedules one event per CheckInterval, so a simulation
+ * using it has to be ended with Simulator::Stop.
+ */
+class YansWifiProgressReporter : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  YansWifiProgressReporter ();
+  virtual ~YansWifiProgressReporter ();
+
+  /**
+   * Start reporting. The reporter has to be kept alive until it is
+   * stopped or the simulator is destroyed.
+   *
+   * \param filename the name of the JSON lines file, empty to write to stderr
+   */
+  void Start (std::string filename = "");
+  /**
+   * Write a last report and stop. This is done automatically when the
+   * simulator is destroyed.
+   */
+  void Stop (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * Counters read at each report.
+   */
+  struct Sample
+  {
+    double wallS;              //!< wall-clock time since Start in s
+    double simS;               //!< simulated time in s
+    uint64_t events;           //!< events run, or scheduled if the scheduler does not tell
+    int64_t queue;             //!< events in the scheduler queue, -1 if unknown
+    uint64_t sends;            //!< calls to YansWifiChannel::Send
+    uint64_t receivers;        //!< receivers visited by YansWifiChannel::Send
+    uint64_t overlapLookups;   //!< overlap factors read from the channel tables
+    uint64_t overlapComputed;  //!< overlap factors computed for new configurations
+    uint64_t linkLookups;      //!< links looked up in the link loss caches
+    uint64_t linkHits;         //!< links whose cached loss was reused
+    uint64_t rssBytes;         //!< resident set size of the process
+  };
+
+  /**
+   * \return the monotonic wall-clock time in s
+   */
+  static double GetWallClock (void);
+  /**
+   * \return the resident set size of the process in bytes, 0 if unknown
+   */
+  static uint64_t GetResidentSetSize (void);
+  /**
+   * \param now a counter
+   * \param last the same counter at the previous report
+   *
+   * \return the increase of the counter, 0 if it decreased
+   */
+  static uint64_t GetDelta (uint64_t now, uint64_t last);
+  /**
+   * Add the YansWifiChannels appended to the ChannelList since the last call.
+   */
+  void UpdateChannels (void);
+  /**
+   * \return the current counters
+   */
+  struct Sample TakeSample (void) const;
+  /**
+   * Check the wall clock, report if WallInterval elapsed and schedule the next check.
+   */
+  void Check (void);
+  /**
+   * Write the rates since the previous report.
+   */
+  void Report (void);
+
+  double m_wallInterval;       //!< wall-clock time between two reports in s
+  Time m_checkInterval;        //!< simulated time between two checks of the wall clock
+  bool m_running;              //!< whether the reporter is started
+  double m_wallStart;          //!< wall-clock time of Start in s
+  EventId m_checkEvent;        //!< next check
+  uint64_t m_lastUid;          //!< uid of the last check event
+  struct Sample m_last;        //!< counters at the previous report
+  std::vector<Ptr<YansWifiChannel> > m_channels; //!< the YansWifiChannels whose counters are read
+  uint32_t m_knownChannels;    //!< number of channels of the ChannelList already looked at
+  std::ofstream m_file;        //!< the JSON lines file, closed to write to stderr
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_PROGRESS_REPORTER_H */
@@ -0,0 +1,455 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#include "yans-wifi-replication-runner.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiReplicationRunner");
+
+NS_OBJECT_ENSURE_REGISTERED (YansWifiReplicationRunner);
+
+namespace {
+
+/**
+ * Write a whole buffer to a file descriptor.
+ *
+ * \return true on success
+ */
+bool
+WriteAll (int fd, const void *buffer, size_t size)
+{
+  const char *p = static_cast<const char *> (buffer);
+  while (size > 0)
+    {
+      ssize_t n = write (fd, p, size);
+      if (n <= 0)
+        {
+          return false;
+        }
+      p += n;
+      size -= n;
+    }
+  return true;
+}
+
+/**
+ * Continued fraction of the regularized incomplete beta function
+ * (modified Lentz's method).
+ */
+double
+BetaContinuedFraction (double a, double b, double x)
+{
+  const double tiny = 1e-300;
+  double c = 1.0;
+  double d = 1.0 - (a + b) * x / (a + 1.0);
+  d = 1.0 / (std::abs (d) < tiny ? tiny : d);
+  double h = d;
+  for (uint32_t m = 1; m <= 300; m++)
+    {
+      double aa = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+      d = 1.0 + aa * d;
+      d = 1.0 / (std::abs (d) < tiny ? tiny : d);
+      c = 1.0 + aa / c;
+      c = std::abs (c) < tiny ? tiny : c;
+      h *= d * c;
+      aa = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+      d = 1.0 + aa * d;
+      d = 1.0 / (std::abs (d) < tiny ? tiny : d);
+      c = 1.0 + aa / c;
+      c = std::abs (c) < tiny ? tiny : c;
+      double delta = d * c;
+      h *= delta;
+      if (std::abs (delta - 1.0) < 1e-12)
+        {
+          break;
+        }
+    }
+  return h;
+}
+
+/**
+ * \return the regularized incomplete beta function I_x(a, b)
+ */
+double
+IncompleteBeta (double a, double b, double x)
+{
+  if (x <= 0.0)
+    {
+      return 0.0;
+    }
+  if (x >= 1.0)
+    {
+      return 1.0;
+    }
+  double front = std::exp (lgamma (a + b) - lgamma (a) - lgamma (b) + a * std::log (x) + b * std::log (1.0 - x));
+  if (x < (a + 1.0) / (a + b + 2.0))
+    {
+      return front * BetaContinuedFraction (a, b, x) / a;
+    }
+  return 1.0 - front * BetaContinuedFraction (b, a, 1.0 - x) / b;
+}
+
+} //anonymous namespace
+
+TypeId
+YansWifiReplicationRunner::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::YansWifiReplicationRunner")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<YansWifiReplicationRunner> ()
+    .AddAttribute ("MaxReplications",
+                   "The maximum number of replications.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&YansWifiReplicationRunner::m_maxReplications),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MinReplications",
+                   "The number of replications done before the precision is checked.",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&YansWifiReplicationRunner::m_minReplications),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("Parallel",
+                   "The maximum number of replications running at once. Zero uses the number of online cores.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&YansWifiReplicationRunner::m_parallel),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("FirstRun",
+                   "The RngSeedManager run number of the first replication; replication i uses FirstRun + i.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&YansWifiReplicationRunner::m_firstRun),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ConfidenceLevel",
+                   "The confidence level of the intervals of the means.",
+                   DoubleValue (0.95),
+                   MakeDoubleAccessor (&YansWifiReplicationRunner::m_confidenceLevel),
+                   MakeDoubleChecker<double> (0.5, 0.9999))
+    .AddAttribute ("RelativePrecision",
+                   "No new replication is started once the half-width of the confidence interval of "
+                   "every metric is at most this fraction of its mean. Zero runs MaxReplications.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiReplicationRunner::m_relativePrecision),
+                   MakeDoubleChecker<double> (0.0))
+  ;
+  return tid;
+}
+
+YansWifiReplicationRunner::YansWifiReplicationRunner ()
+  : m_done (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+YansWifiReplicationRunner::~YansWifiReplicationRunner ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+YansWifiReplicationRunner::SetReplication (ReplicationCallback replication)
+{
+  m_replication = replication;
+}
+
+void
+YansWifiReplicationRunner::SetMetricNames (std::vector<std::string> names)
+{
+  m_names = names;
+}
+
+uint32_t
+YansWifiReplicationRunner::Run (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ABORT_MSG_IF (m_replication.IsNull (), "No replication callback set");
+  NS_ABORT_MSG_IF (!m_children.empty (), "Replications already running");
+  std::ofstream file (filename.c_str ());
+  NS_ABORT_MSG_IF (!file.is_open (), "Could not open result file " << filename);
+  m_done = 0;
+  m_accumulators.clear ();
+
+  uint32_t parallel = m_parallel;
+  if (parallel == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      parallel = (cores > 0) ? static_cast<uint32_t> (cores) : 1;
+    }
+  uint32_t started = 0;
+  while (true)
+    {
+      while (m_children.size () < parallel && started < m_maxReplications && !IsPrecise ())
+        {
+          Start (started++);
+        }
+      if (m_children.empty ())
+        {
+          break;
+        }
+      Collect (file);
+    }
+
+  file << "mean,";
+  for (uint32_t k = 0; k < m_accumulators.size (); k++)
+    {
+      file << "," << GetMean (k);
+    }
+  file << "\nhalfwidth,";
+  for (uint32_t k = 0; k < m_accumulators.size (); k++)
+    {
+      file << "," << GetHalfWidth (k);
+    }
+  file << "\n# " << m_done << " replications, confidence level " << m_confidenceLevel
+       << (m_done < m_maxReplications ? ", target precision reached" : "") << "\n";
+  file.close ();
+  NS_LOG_INFO (m_done << " replications done");
+  return m_done;
+}
+
+void
+YansWifiReplicationRunner::Start (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  int fds[2];
+  NS_ABORT_MSG_IF (pipe (fds) != 0, "Could not create the pipe of replication " << index);
+  //buffered output would otherwise be written once per process
+  std::cout.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+  pid_t pid = fork ();
+  NS_ABORT_MSG_IF (pid < 0, "Could not fork replication " << index);
+  if (pid == 0)
+    {
+      close (fds[0]);
+      RngSeedManager::SetRun (m_firstRun + index);
+      std::vector<double> metrics = m_replication (index);
+      uint32_t n = metrics.size ();
+      bool ok = WriteAll (fds[1], &n, sizeof (n))
+        && (n == 0 || WriteAll (fds[1], &metrics[0], n * sizeof (double)));
+      close (fds[1]);
+      std::cout.flush ();
+      std::clog.flush ();
+      std::fflush (0);
+      _exit (ok ? 0 : 1);
+    }
+  close (fds[1]);
+  struct Child &child = m_children[pid];
+  child.index = index;
+  child.fd = fds[0];
+}
+
+void
+YansWifiReplicationRunner::Collect (std::ostream &os)
+{
+  NS_ABORT_MSG_IF (m_children.empty (), "No replication to wait for");
+  //all the pipes are drained: a child blocked on a full pipe never exits
+  std::vector<struct pollfd> fds;
+  std::vector<int> pids;
+  for (std::map<int, struct Child>::const_iterator i = m_children.begin (); i != m_children.end (); i++)
+    {
+      struct pollfd fd;
+      fd.fd = i->second.fd;
+      fd.events = POLLIN;
+      fd.revents = 0;
+      fds.push_back (fd);
+      pids.push_back (i->first);
+    }
+  while (true)
+    {
+      if (poll (&fds[0], fds.size (), -1) < 0)
+        {
+          NS_ABORT_MSG_IF (errno != EINTR, "Could not poll the replication pipes");
+          continue;
+        }
+      for (uint32_t k = 0; k < fds.size (); k++)
+        {
+          if (fds[k].revents == 0)
+            {
+              continue;
+            }
+          char buffer[4096];
+          ssize_t n = read (fds[k].fd, buffer, sizeof (buffer));
+          if (n > 0)
+            {
+              m_children[pids[k]].data.append (buffer, n);
+            }
+          else if (n == 0 || errno != EINTR)
+            {
+              //end of file, or a broken pipe reported as a failure by Finish
+              Finish (pids[k], os);
+              return;
+            }
+        }
+    }
+}
+
+void
+YansWifiReplicationRunner::Finish (int pid, std::ostream &os)
+{
+  std::map<int, struct Child>::iterator child = m_children.find (pid);
+  NS_ABORT_MSG_IF (child == m_children.end (), "Unknown child process " << pid);
+  uint32_t index = child->second.index;
+  std::string data = child->second.data;
+  close (child->second.fd);
+  m_children.erase (child);
+  int status;
+  while (waitpid (pid, &status, 0) < 0)
+    {
+      NS_ABORT_MSG_IF (errno != EINTR, "Could not wait for replication " << index);
+    }
+
+  uint32_t n = 0;
+  std::vector<double> metrics;
+  bool ok = data.size () >= sizeof (n);
+  if (ok)
+    {
+      std::copy (data.data (), data.data () + sizeof (n), reinterpret_cast<char *> (&n));
+      ok = data.size () == sizeof (n) + n * sizeof (double);
+    }
+  if (ok && n > 0)
+    {
+      metrics.resize (n);
+      std::copy (data.data () + sizeof (n), data.data () + data.size (), reinterpret_cast<char *> (&metrics[0]));
+    }
+  NS_ABORT_MSG_IF (!ok || !WIFEXITED (status) || WEXITSTATUS (status) != 0,
+                   "Replication " << index << " failed");
+
+  if (m_done == 0)
+    {
+      m_accumulators.resize (n);
+      os << "replication,run";
+      for (uint32_t k = 0; k < n; k++)
+        {
+          if (k < m_names.size ())
+            {
+              os << "," << m_names[k];
+            }
+          else
+            {
+              os << ",metric" << k;
+            }
+        }
+      os << "\n";
+    }
+  NS_ABORT_MSG_IF (n != m_accumulators.size (), "Replication " << index << " returned " << n
+                   << " metrics instead of " << m_accumulators.size ());
+  m_done++;
+  os << index << "," << m_firstRun + index;
+  for (uint32_t k = 0; k < n; k++)
+    {
+      struct Accumulator &accumulator = m_accumulators[k];
+      double delta = metrics[k] - accumulator.mean;
+      accumulator.mean += delta / m_done;
+      accumulator.m2 += delta * (metrics[k] - accumulator.mean);
+      os << "," << metrics[k];
+    }
+  os << std::endl;
+  NS_LOG_DEBUG ("replication " << index << " done, " << m_done << " in total");
+}
+
+bool
+YansWifiReplicationRunner::IsPrecise (void) const
+{
+  if (m_relativePrecision <= 0.0 || m_done < m_minReplications)
+    {
+      return false;
+    }
+  for (uint32_t k = 0; k < m_accumulators.size (); k++)
+    {
+      if (GetHalfWidth (k) > m_relativePrecision * std::abs (m_accumulators[k].mean))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+uint32_t
+YansWifiReplicationRunner::GetNReplications (void) const
+{
+  return m_done;
+}
+
+double
+YansWifiReplicationRunner::GetMean (uint32_t metric) const
+{
+  NS_ASSERT (metric < m_accumulators.size ());
+  return m_accumulators[metric].mean;
+}
+
+double
+YansWifiReplicationRunner::GetHalfWidth (uint32_t metric) const
+{
+  NS_ASSERT (metric < m_accumulators.size ());
+  if (m_done < 2)
+    {
+      return 0.0;
+    }
+  double variance = m_accumulators[metric].m2 / (m_done - 1);
+  return GetStudentQuantile (m_confidenceLevel, m_done - 1) * std::sqrt (variance / m_done);
+}
+
+double
+YansWifiReplicationRunner::GetStudentQuantile (double probability, uint32_t degrees)
+{
+  NS_ASSERT (probability > 0.0 && probability < 1.0 && degrees > 0);
+  //P(|T| <= t) = 1 - I_{v/(v+t^2)}(v/2, 1/2), increasing in t: bisection
+  double v = degrees;
+  double low = 0.0;
+  double high = 1e6;
+  for (uint32_t i = 0; i < 200 && high - low > 1e-10 * high; i++)
+    {
+      double t = (low + high) / 2;
+      double p = 1.0 - IncompleteBeta (v / 2, 0.5, v / (v + t * t));
+      if (p < probability)
+        {
+          low = t;
+        }
+      else
+        {
+          high = t;
+        }
+    }
+  return (low + high) / 2;
+}
+
+} //namespace ns3
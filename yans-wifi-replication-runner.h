@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#ifndef YANS_WIFI_REPLICATION_RUNNER_H
+#define YANS_WIFI_REPLICATION_RUNNER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+#include "ns3/object.h"
+#include "ns3/callback.h"
+
+namespace ns3 {
+
+/**
+ * \brief Runs independent replications of a simulation in parallel processes
+ * \ingroup wifi
+ *
+ * The replication callback builds the scenario, runs it, destroys the
+ * simulator and returns the metrics of the replication. Each replication
+ * is run in a child process forked by Run, with its own run number
+ * (FirstRun + replication index) set in RngSeedManager, so that all the
+ * replications draw from independent substreams. Within a replication,
+ * one call to YansWifiChannel::AssignStreams gives non-overlapping
+ * streams to the loss models, the delay model and the PHYs of a channel.
+ *
+ * The metrics of each replication are sent back to the parent through a
+ * pipe and written to one CSV file as soon as the replication ends,
+ * followed by the mean and the half-width of the confidence interval of
+ * each metric. Once MinReplications are done, no new replication is
+ * started when the half-width of every metric is at most
+ * RelativePrecision times its mean.
+ *
+ * Threads cannot be used instead of processes, as the ns-3 simulator is
+ * a singleton.
+ */
+class YansWifiReplicationRunner : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  YansWifiReplicationRunner ();
+  virtual ~YansWifiReplicationRunner ();
+
+  /**
+   * The replication callback: gets the replication index and returns the metrics.
+   */
+  typedef Callback<std::vector<double>, uint32_t> ReplicationCallback;
+
+  /**
+   * \param replication the replication callback
+   */
+  void SetReplication (ReplicationCallback replication);
+  /**
+   * \param names the names of the metrics, used as CSV column names
+   */
+  void SetMetricNames (std::vector<std::string> names);
+
+  /**
+   * Run the replications and write the aggregated results.
+   *
+   * \param filename the name of the CSV file
+   *
+   * \return the number of replications done
+   */
+  uint32_t Run (std::string filename);
+
+  /**
+   * \return the number of replications done by the last Run
+   */
+  uint32_t GetNReplications (void) const;
+  /**
+   * \param metric the index of the metric
+   *
+   * \return the mean of the metric over the replications done
+   */
+  double GetMean (uint32_t metric) const;
+  /**
+   * \param metric the index of the metric
+   *
+   * \return the half-width of the confidence interval of the mean
+   */
+  double GetHalfWidth (uint32_t metric) const;
+
+  /**
+   * \param probability the two-sided confidence level, e.g., 0.95
+   * \param degrees the degrees of freedom
+   *
+   * \return the quantile of the Student t distribution for the confidence level
+   */
+  static double GetStudentQuantile (double probability, uint32_t degrees);
+
+private:
+  /**
+   * Running mean and variance of a metric (Welford).
+   */
+  struct Accumulator
+  {
+    double mean;   //!< mean of the samples
+    double m2;     //!< sum of the squared deviations from the mean
+  };
+
+  /**
+   * A running child.
+   */
+  struct Child
+  {
+    uint32_t index;    //!< replication index
+    int fd;            //!< read end of the pipe
+    std::string data;  //!< bytes read from the pipe so far
+  };
+
+  /**
+   * Fork a child running one replication.
+   *
+   * \param index the replication index
+   */
+  void Start (uint32_t index);
+  /**
+   * Read the pipes of all the running children until one of them is
+   * closed, then finish that child.
+   *
+   * \param os the CSV file
+   */
+  void Collect (std::ostream &os);
+  /**
+   * Reap a child whose pipe is closed and add its metrics to the results.
+   *
+   * \param pid the process id of the child
+   * \param os the CSV file
+   */
+  void Finish (int pid, std::ostream &os);
+  /**
+   * \return true if the target precision is reached for all the metrics
+   */
+  bool IsPrecise (void) const;
+
+  ReplicationCallback m_replication;     //!< the replication callback
+  std::vector<std::string> m_names;      //!< the names of the metrics
+  uint32_t m_maxReplications;            //!< maximum number of replications
+  uint32_t m_minReplications;            //!< number of replications before the precision is checked
+  uint32_t m_parallel;                   //!< maximum number of children at once, 0 for the number of cores
+  uint32_t m_firstRun;                   //!< run number of the first replication
+  double m_confidenceLevel;              //!< confidence level of the intervals
+  double m_relativePrecision;            //!< target half-width relative to the mean, 0 to run all replications
+  uint32_t m_done;                       //!< number of replications done
+  std::vector<struct Accumulator> m_accumulators; //!< running statistics of each metric
+  std::map<int, struct Child> m_children; //!< running children, by pid
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_REPLICATION_RUNNER_H */
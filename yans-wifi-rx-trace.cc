@@ -0,0 +1,431 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#include "yans-wifi-rx-trace.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/config.h"
+#include "ns3/callback.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiRxTrace");
+
+NS_OBJECT_ENSURE_REGISTERED (YansWifiRxTraceWriter);
+
+namespace {
+
+const char g_magic[4] = {'Y', 'W', 'R', 'T'};
+const uint32_t g_version = 1;
+
+/**
+ * Write a column of a block.
+ *
+ * \param os the output stream
+ * \param column the column
+ * \param n the number of values to write
+ */
+template <typename T>
+void
+WriteColumn (std::ostream &os, const std::vector<T> &column, uint32_t n)
+{
+  if (n > 0)
+    {
+      os.write (reinterpret_cast<const char *> (&column[0]), n * sizeof (T));
+    }
+}
+
+/**
+ * Read a column of a block.
+ *
+ * \param is the input stream
+ * \param column the column
+ * \param n the number of values to read
+ * \return false if the stream ended before
+ */
+template <typename T>
+bool
+ReadColumn (std::istream &is, std::vector<T> &column, uint32_t n)
+{
+  column.resize (n);
+  if (n > 0)
+    {
+      is.read (reinterpret_cast<char *> (&column[0]), n * sizeof (T));
+    }
+  return bool (is);
+}
+
+} //anonymous namespace
+
+TypeId
+YansWifiRxTraceWriter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::YansWifiRxTraceWriter")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<YansWifiRxTraceWriter> ()
+    .AddAttribute ("BlockSize",
+                   "The number of records buffered before a block is handed over to the writer thread.",
+                   UintegerValue (8192),
+                   MakeUintegerAccessor (&YansWifiRxTraceWriter::m_blockSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxPendingBlocks",
+                   "The maximum number of blocks queued for the writer thread. "
+                   "The simulation waits for the writer when this limit is reached.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&YansWifiRxTraceWriter::m_maxPendingBlocks),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+YansWifiRxTraceWriter::YansWifiRxTraceWriter ()
+  : m_current (0),
+    m_stopping (false),
+    m_records (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+YansWifiRxTraceWriter::~YansWifiRxTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  for (std::vector<Block *>::iterator i = m_free.begin (); i != m_free.end (); i++)
+    {
+      delete *i;
+    }
+  m_free.clear ();
+}
+
+void
+YansWifiRxTraceWriter::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+void
+YansWifiRxTraceWriter::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  NS_ABORT_MSG_IF (m_thread != 0, "Trace already open");
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_IF (!m_file.is_open (), "Could not open rx trace file " << filename);
+  m_file.write (g_magic, 4);
+  m_file.write (reinterpret_cast<const char *> (&g_version), sizeof (g_version));
+  m_stopping = false;
+  m_current = GetFreeBlock ();
+  m_thread = Create<SystemThread> (MakeCallback (&YansWifiRxTraceWriter::WriterLoop, this));
+  m_thread->Start ();
+}
+
+void
+YansWifiRxTraceWriter::Close (void)
+{
+  if (m_thread == 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  {
+    CriticalSection cs (m_mutex);
+    if (m_current->size > 0)
+      {
+        m_pending.push_back (m_current);
+      }
+    else
+      {
+        m_free.push_back (m_current);
+      }
+    m_current = 0;
+    m_stopping = true;
+  }
+  m_dataReady.SetCondition (true);
+  m_dataReady.Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+  m_file.close ();
+}
+
+void
+YansWifiRxTraceWriter::Install (Ptr<YansWifiPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  phy->TraceConnectWithoutContext ("RxOutcome", MakeCallback (&YansWifiRxTraceWriter::Write, this));
+}
+
+void
+YansWifiRxTraceWriter::InstallAll (void)
+{
+  NS_LOG_FUNCTION (this);
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/$ns3::YansWifiPhy/RxOutcome",
+                                 MakeCallback (&YansWifiRxTraceWriter::Write, this));
+}
+
+void
+YansWifiRxTraceWriter::Write (const struct YansWifiPhy::RxRecord &record)
+{
+  if (m_current == 0)
+    {
+      return;
+    }
+  Block *block = m_current;
+  uint32_t k = block->size;
+  block->time[k] = record.time;
+  block->sender[k] = record.sender;
+  block->receiver[k] = record.receiver;
+  block->rxPowerDbm[k] = record.rxPowerDbm;
+  block->overlapFactorDb[k] = record.overlapFactorDb;
+  block->snr[k] = record.snr;
+  block->per[k] = record.per;
+  block->outcome[k] = record.outcome;
+  block->size++;
+  m_records++;
+  if (block->size == m_blockSize)
+    {
+      Submit (block);
+      m_current = GetFreeBlock ();
+    }
+}
+
+uint64_t
+YansWifiRxTraceWriter::GetRecordCount (void) const
+{
+  return m_records;
+}
+
+YansWifiRxTraceWriter::Block *
+YansWifiRxTraceWriter::GetFreeBlock (void)
+{
+  Block *block = 0;
+  {
+    CriticalSection cs (m_mutex);
+    if (!m_free.empty ())
+      {
+        block = m_free.back ();
+        m_free.pop_back ();
+      }
+  }
+  if (block == 0)
+    {
+      block = new Block;
+    }
+  block->size = 0;
+  block->time.resize (m_blockSize);
+  block->sender.resize (m_blockSize);
+  block->receiver.resize (m_blockSize);
+  block->rxPowerDbm.resize (m_blockSize);
+  block->overlapFactorDb.resize (m_blockSize);
+  block->snr.resize (m_blockSize);
+  block->per.resize (m_blockSize);
+  block->outcome.resize (m_blockSize);
+  return block;
+}
+
+void
+YansWifiRxTraceWriter::Submit (Block *block)
+{
+  while (true)
+    {
+      {
+        CriticalSection cs (m_mutex);
+        if (m_pending.size () < m_maxPendingBlocks)
+          {
+            m_pending.push_back (block);
+            break;
+          }
+      }
+      NS_LOG_DEBUG ("waiting for the writer thread");
+      m_spaceReady.Wait ();
+      m_spaceReady.SetCondition (false);
+    }
+  m_dataReady.SetCondition (true);
+  m_dataReady.Signal ();
+}
+
+void
+YansWifiRxTraceWriter::WriterLoop (void)
+{
+  bool stop = false;
+  while (!stop)
+    {
+      m_dataReady.Wait ();
+      m_dataReady.SetCondition (false);
+      while (true)
+        {
+          Block *block = 0;
+          {
+            CriticalSection cs (m_mutex);
+            if (m_pending.empty ())
+              {
+                stop = m_stopping;
+                break;
+              }
+            block = m_pending.front ();
+            m_pending.pop_front ();
+          }
+          WriteBlock (block);
+          {
+            CriticalSection cs (m_mutex);
+            m_free.push_back (block);
+          }
+          m_spaceReady.SetCondition (true);
+          m_spaceReady.Signal ();
+        }
+    }
+  m_file.flush ();
+}
+
+void
+YansWifiRxTraceWriter::WriteBlock (const Block *block)
+{
+  uint32_t n = block->size;
+  m_file.write (reinterpret_cast<const char *> (&n), sizeof (n));
+  WriteColumn (m_file, block->time, n);
+  WriteColumn (m_file, block->sender, n);
+  WriteColumn (m_file, block->receiver, n);
+  WriteColumn (m_file, block->rxPowerDbm, n);
+  WriteColumn (m_file, block->overlapFactorDb, n);
+  WriteColumn (m_file, block->snr, n);
+  WriteColumn (m_file, block->per, n);
+  WriteColumn (m_file, block->outcome, n);
+}
+
+YansWifiRxTraceReader::YansWifiRxTraceReader (std::string filename)
+  : m_file (filename.c_str (), std::ios::in | std::ios::binary)
+{
+  NS_ABORT_MSG_IF (!m_file.is_open (), "Could not open rx trace file " << filename);
+  char magic[4];
+  uint32_t version = 0;
+  m_file.read (magic, 4);
+  m_file.read (reinterpret_cast<char *> (&version), sizeof (version));
+  NS_ABORT_MSG_IF (!m_file || std::string (magic, 4) != std::string (g_magic, 4),
+                   filename << " is not an rx trace file");
+  NS_ABORT_MSG_IF (version != g_version, "Unsupported rx trace version " << version);
+}
+
+bool
+YansWifiRxTraceReader::ReadBlock (std::vector<struct YansWifiPhy::RxRecord> &records)
+{
+  uint32_t n;
+  if (!m_file.read (reinterpret_cast<char *> (&n), sizeof (n)))
+    {
+      return false;
+    }
+  std::vector<int64_t> time;
+  std::vector<uint32_t> sender;
+  std::vector<uint32_t> receiver;
+  std::vector<double> rxPowerDbm;
+  std::vector<double> overlapFactorDb;
+  std::vector<double> snr;
+  std::vector<double> per;
+  std::vector<uint8_t> outcome;
+  bool ok = ReadColumn (m_file, time, n)
+    && ReadColumn (m_file, sender, n)
+    && ReadColumn (m_file, receiver, n)
+    && ReadColumn (m_file, rxPowerDbm, n)
+    && ReadColumn (m_file, overlapFactorDb, n)
+    && ReadColumn (m_file, snr, n)
+    && ReadColumn (m_file, per, n)
+    && ReadColumn (m_file, outcome, n);
+  NS_ABORT_MSG_IF (!ok, "Truncated rx trace block");
+  records.resize (n);
+  for (uint32_t k = 0; k < n; k++)
+    {
+      records[k].time = time[k];
+      records[k].sender = sender[k];
+      records[k].receiver = receiver[k];
+      records[k].rxPowerDbm = rxPowerDbm[k];
+      records[k].overlapFactorDb = overlapFactorDb[k];
+      records[k].snr = snr[k];
+      records[k].per = per[k];
+      records[k].outcome = outcome[k];
+    }
+  return true;
+}
+
+uint64_t
+YansWifiRxTraceReader::ExportCsv (std::string traceFile, std::string csvFile)
+{
+  YansWifiRxTraceReader reader (traceFile);
+  std::ofstream os (csvFile.c_str ());
+  NS_ABORT_MSG_IF (!os.is_open (), "Could not open " << csvFile);
+  os << "time_ns,sender,receiver,rx_power_dbm,overlap_factor_db,snr_db,per,outcome" << std::endl;
+  uint64_t count = 0;
+  std::vector<struct YansWifiPhy::RxRecord> records;
+  while (reader.ReadBlock (records))
+    {
+      for (std::vector<struct YansWifiPhy::RxRecord>::const_iterator i = records.begin (); i != records.end (); i++)
+        {
+          os << i->time << "," << i->sender << "," << i->receiver << ","
+             << i->rxPowerDbm << "," << i->overlapFactorDb << ","
+             << 10.0 * std::log10 (i->snr) << "," << i->per << ","
+             << static_cast<uint32_t> (i->outcome) << "\n";
+        }
+      count += records.size ();
+    }
+  return count;
+}
+
+uint64_t
+YansWifiRxTraceReader::ExportColumns (std::string traceFile, std::string prefix)
+{
+  YansWifiRxTraceReader reader (traceFile);
+  const char *names[8] = {"time", "sender", "receiver", "rx_power_dbm", "overlap_factor_db", "snr", "per", "outcome"};
+  std::ofstream columns[8];
+  for (uint32_t c = 0; c < 8; c++)
+    {
+      std::string name = prefix + names[c] + ".bin";
+      columns[c].open (name.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+      NS_ABORT_MSG_IF (!columns[c].is_open (), "Could not open " << name);
+    }
+  uint64_t count = 0;
+  std::vector<struct YansWifiPhy::RxRecord> records;
+  while (reader.ReadBlock (records))
+    {
+      for (std::vector<struct YansWifiPhy::RxRecord>::const_iterator i = records.begin (); i != records.end (); i++)
+        {
+          columns[0].write (reinterpret_cast<const char *> (&i->time), sizeof (i->time));
+          columns[1].write (reinterpret_cast<const char *> (&i->sender), sizeof (i->sender));
+          columns[2].write (reinterpret_cast<const char *> (&i->receiver), sizeof (i->receiver));
+          columns[3].write (reinterpret_cast<const char *> (&i->rxPowerDbm), sizeof (i->rxPowerDbm));
+          columns[4].write (reinterpret_cast<const char *> (&i->overlapFactorDb), sizeof (i->overlapFactorDb));
+          columns[5].write (reinterpret_cast<const char *> (&i->snr), sizeof (i->snr));
+          columns[6].write (reinterpret_cast<const char *> (&i->per), sizeof (i->per));
+          columns[7].write (reinterpret_cast<const char *> (&i->outcome), sizeof (i->outcome));
+        }
+      count += records.size ();
+    }
+  return count;
+}
+
+} //namespace ns3
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#ifndef YANS_WIFI_RX_TRACE_H
+#define YANS_WIFI_RX_TRACE_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <stdint.h>
+#include "ns3/object.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#include "yans-wifi-phy.h"
+
+namespace ns3 {
+
+/**
+ * \brief Binary columnar trace of the link metrics of every reception
+ * \ingroup wifi
+ *
+ * The writer is connected to the RxOutcome trace source of YansWifiPhys
+ * and stores the records in blocks of fixed-width columns. Full blocks
+ * are handed over to a background thread that writes them to the file,
+ * so that the simulation thread only appends to in-memory arrays.
+ *
+ * File layout: the 4-byte magic "YWRT" and a uint32_t version, followed
+ * by blocks. Each block is a uint32_t record count n and then the
+ * columns, each made of n values in host byte order: time (int64_t, ns),
+ * sender (uint32_t), receiver (uint32_t), rx power (double, dBm),
+ * overlap factor (double, dB), SNR (double, linear), PER (double) and
+ * outcome (uint8_t, see YansWifiPhy::RxOutcome).
+ */
+class YansWifiRxTraceWriter : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  YansWifiRxTraceWriter ();
+  virtual ~YansWifiRxTraceWriter ();
+
+  /**
+   * Create the trace file and start the background writer thread.
+   *
+   * \param filename the name of the trace file
+   */
+  void Open (std::string filename);
+  /**
+   * Write the pending records, stop the background writer thread and
+   * close the file. This is done automatically when the object is disposed.
+   */
+  void Close (void);
+
+  /**
+   * Trace the receptions of the given PHY.
+   *
+   * \param phy the YansWifiPhy to trace
+   */
+  void Install (Ptr<YansWifiPhy> phy);
+  /**
+   * Trace the receptions of all the YansWifiPhys of all the nodes.
+   */
+  void InstallAll (void);
+
+  /**
+   * Append a record to the trace.
+   *
+   * \param record the link metrics of the reception
+   */
+  void Write (const struct YansWifiPhy::RxRecord &record);
+
+  /**
+   * \return the number of records appended so far
+   */
+  uint64_t GetRecordCount (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * A block of records stored column by column.
+   */
+  struct Block
+  {
+    uint32_t size;                        //!< number of records in the block
+    std::vector<int64_t> time;            //!< time column
+    std::vector<uint32_t> sender;         //!< sender column
+    std::vector<uint32_t> receiver;       //!< receiver column
+    std::vector<double> rxPowerDbm;       //!< rx power column
+    std::vector<double> overlapFactorDb;  //!< overlap factor column
+    std::vector<double> snr;              //!< SNR column
+    std::vector<double> per;              //!< PER column
+    std::vector<uint8_t> outcome;         //!< outcome column
+  };
+
+  /**
+   * \return an empty block, recycled if possible
+   */
+  Block * GetFreeBlock (void);
+  /**
+   * Queue a block for the background writer, waiting if too many
+   * blocks are already queued.
+   *
+   * \param block the block to write
+   */
+  void Submit (Block *block);
+  /**
+   * Main loop of the background writer thread.
+   */
+  void WriterLoop (void);
+  /**
+   * Write a block to the file. Called by the background writer thread.
+   *
+   * \param block the block to write
+   */
+  void WriteBlock (const Block *block);
+
+  uint32_t m_blockSize;            //!< number of records per block
+  uint32_t m_maxPendingBlocks;     //!< maximum number of blocks queued for the writer thread
+  std::ofstream m_file;            //!< the trace file, only used by the writer thread once open
+  Block *m_current;                //!< block being filled by the simulation thread
+  std::deque<Block *> m_pending;   //!< blocks queued for the writer thread
+  std::vector<Block *> m_free;     //!< blocks that can be reused
+  bool m_stopping;                 //!< whether the writer thread has to exit once the queue is empty
+  uint64_t m_records;              //!< number of records appended
+  Ptr<SystemThread> m_thread;      //!< the background writer thread
+  SystemMutex m_mutex;             //!< protects m_pending, m_free and m_stopping
+  SystemCondition m_dataReady;     //!< set when a block is queued
+  SystemCondition m_spaceReady;    //!< set when a block has been written
+};
+
+/**
+ * \brief Reader for the traces written by YansWifiRxTraceWriter
+ * \ingroup wifi
+ */
+class YansWifiRxTraceReader
+{
+public:
+  /**
+   * Open a trace file.
+   *
+   * \param filename the name of the trace file
+   */
+  YansWifiRxTraceReader (std::string filename);
+
+  /**
+   * Read the next block of records.
+   *
+   * \param records the records of the block
+   *
+   * \return false if there is no block left
+   */
+  bool ReadBlock (std::vector<struct YansWifiPhy::RxRecord> &records);
+
+  /**
+   * Convert a trace to CSV, one reception per line with a header line.
+   * The SNR is written in dB.
+   *
+   * \param traceFile the name of the trace file
+   * \param csvFile the name of the CSV file to write
+   *
+   * \return the number of records converted
+   */
+  static uint64_t ExportCsv (std::string traceFile, std::string csvFile);
+  /**
+   * Convert a trace to one flat binary file per column, named
+   * prefix + column name + ".bin", that can be loaded as typed arrays
+   * (e.g., with numpy.fromfile) and turned into a Parquet table.
+   *
+   * \param traceFile the name of the trace file
+   * \param prefix the prefix of the column files
+   *
+   * \return the number of records converted
+   */
+  static uint64_t ExportColumns (std::string traceFile, std::string prefix);
+
+private:
+  std::ifstream m_file;  //!< the trace file
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_RX_TRACE_H */
@@ -0,0 +1,557 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+/*
+ * Scheduler benchmark on the event pattern of the wifi channel with adjacent
+ * channel interference: each transmission schedules the arrival of its first
+ * bit at every other node after the propagation delay, and each arrival a
+ * receiver synchronizes to schedules the end of the PLCP header and the end
+ * of the reception. The events are fed directly to the schedulers, so that
+ * only the scheduler cost is measured, and the order in which they are
+ * removed is summed up in a checksum that has to be the same for all of them.
+ *
+ * The synthetic workload can be replaced by the events of a real simulation:
+ * --record=<file> runs an 802.11ac ad hoc network on adjacent and partially
+ * overlapping channels (20, 40 and 80 MHz) with UDP traffic between pairs of
+ * nodes, and writes every insertion and removal of the scheduler to the
+ * file; --trace=<file> replays such a file on each of the schedulers.
+ *
+ * Copy this file to the scratch directory of ns-3.26 and run, e.g.,
+ *   ./waf --run "yans-wifi-scheduler-benchmark --nodes=200 --transmissions=100000"
+ *   ./waf --run "yans-wifi-scheduler-benchmark --nodes=60 --record=aci.ops"
+ *   ./waf --run "yans-wifi-scheduler-benchmark --trace=aci.ops"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/scheduler.h"
+#include "ns3/map-scheduler.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * The kinds of events, stored in the two lowest bits of the event context.
+ */
+enum EventKind
+{
+  TX_START = 0,   //!< a node starts a transmission
+  ARRIVAL,        //!< the first bit of a frame arrives at a node
+  END_PLCP,       //!< end of the PLCP header at a synchronized node
+  END_RX          //!< end of the reception at a synchronized node
+};
+
+/**
+ * Linear congruential generator, so that all the schedulers see the same workload.
+ */
+class Lcg
+{
+public:
+  /**
+   * \param seed the seed
+   */
+  Lcg (uint64_t seed)
+    : m_state (seed)
+  {
+  }
+  /**
+   * \return a uniform random number in [0, 1)
+   */
+  double Next (void)
+  {
+    m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (m_state >> 11) * (1.0 / 9007199254740992.0);
+  }
+  /**
+   * \param min the minimum
+   * \param max the maximum
+   * \return a uniform random integer in [min, max)
+   */
+  uint64_t Next (uint64_t min, uint64_t max)
+  {
+    return min + static_cast<uint64_t> (Next () * (max - min));
+  }
+private:
+  uint64_t m_state;  //!< the state
+};
+
+/**
+ * The parameters of the workload.
+ */
+struct Workload
+{
+  uint32_t nodes;           //!< number of nodes
+  uint32_t transmissions;   //!< total number of transmissions
+  double side;              //!< side of the square the nodes are placed in, in m
+  double syncProbability;   //!< probability that a receiver synchronizes to a frame
+  uint64_t seed;            //!< seed of the generator
+};
+
+/**
+ * The result of a run.
+ */
+struct Result
+{
+  uint64_t events;          //!< number of events removed
+  uint64_t checksum;        //!< checksum of the removal order
+  uint32_t maxSize;         //!< maximum number of events in the queue
+  int64_t ms;               //!< wall-clock time in ms
+};
+
+/**
+ * Run the workload on a scheduler.
+ *
+ * \param scheduler the scheduler, empty
+ * \param w the workload
+ * \return the result
+ */
+Result
+Run (Ptr<Scheduler> scheduler, const struct Workload &w)
+{
+  Lcg rng (w.seed);
+  std::vector<double> x (w.nodes);
+  std::vector<double> y (w.nodes);
+  for (uint32_t i = 0; i < w.nodes; i++)
+    {
+      x[i] = rng.Next () * w.side;
+      y[i] = rng.Next () * w.side;
+    }
+  //propagation delays in ns, as computed by ConstantSpeedPropagationDelayModel
+  std::vector<uint64_t> delay (w.nodes * w.nodes);
+  for (uint32_t i = 0; i < w.nodes; i++)
+    {
+      for (uint32_t j = 0; j < w.nodes; j++)
+        {
+          double d = std::sqrt ((x[i] - x[j]) * (x[i] - x[j]) + (y[i] - y[j]) * (y[i] - y[j]));
+          delay[i * w.nodes + j] = static_cast<uint64_t> (d / 299792458.0 * 1e9);
+        }
+    }
+
+  struct Result result = {0, 0, 0, 0};
+  uint32_t uid = 0;
+  uint32_t size = 0;
+  uint32_t transmissions = 0;
+  Scheduler::Event ev;
+  ev.impl = 0;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < w.nodes; i++)
+    {
+      ev.key.m_ts = rng.Next (0, 1000000);
+      ev.key.m_uid = uid++;
+      ev.key.m_context = i * 4 + TX_START;
+      scheduler->Insert (ev);
+      size++;
+    }
+  while (!scheduler->IsEmpty ())
+    {
+      Scheduler::Event next = scheduler->RemoveNext ();
+      size--;
+      result.events++;
+      result.checksum = result.checksum * 1099511628211ULL + (next.key.m_ts ^ next.key.m_uid);
+      uint64_t now = next.key.m_ts;
+      uint32_t node = next.key.m_context / 4;
+      switch (next.key.m_context % 4)
+        {
+        case TX_START:
+          if (transmissions == w.transmissions)
+            {
+              break;
+            }
+          transmissions++;
+          for (uint32_t j = 0; j < w.nodes; j++)
+            {
+              if (j == node)
+                {
+                  continue;
+                }
+              ev.key.m_ts = now + delay[node * w.nodes + j];
+              ev.key.m_uid = uid++;
+              ev.key.m_context = j * 4 + ARRIVAL;
+              scheduler->Insert (ev);
+              size++;
+            }
+          //frame duration and backoff
+          ev.key.m_ts = now + rng.Next (100000, 2000000) + rng.Next (34000, 700000);
+          ev.key.m_uid = uid++;
+          ev.key.m_context = node * 4 + TX_START;
+          scheduler->Insert (ev);
+          size++;
+          break;
+        case ARRIVAL:
+          if (rng.Next () < w.syncProbability)
+            {
+              ev.key.m_ts = now + 40000;
+              ev.key.m_uid = uid++;
+              ev.key.m_context = node * 4 + END_PLCP;
+              scheduler->Insert (ev);
+              ev.key.m_ts = now + rng.Next (100000, 2000000);
+              ev.key.m_uid = uid++;
+              ev.key.m_context = node * 4 + END_RX;
+              scheduler->Insert (ev);
+              size += 2;
+            }
+          break;
+        default:
+          break;
+        }
+      result.maxSize = std::max (result.maxSize, size);
+    }
+  result.ms = clock.End ();
+  return result;
+}
+
+/**
+ * An operation on the scheduler, as recorded by RecordingScheduler.
+ */
+struct Operation
+{
+  char op;                  //!< 'i' for Insert, 'r' for RemoveNext, 'x' for Remove
+  uint64_t ts;              //!< timestamp of the event
+  uint32_t uid;             //!< uid of the event
+};
+
+/**
+ * Map scheduler which writes every operation to a file, to record the
+ * events of a real simulation.
+ */
+class RecordingScheduler : public MapScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::YansWifiRecordingScheduler")
+      .SetParent<MapScheduler> ()
+      .SetGroupName ("Wifi")
+      .AddConstructor<RecordingScheduler> ()
+    ;
+    return tid;
+  }
+  /**
+   * The file the operations of all the recording schedulers are written to.
+   */
+  static std::ofstream *g_file;
+
+  virtual void Insert (const Scheduler::Event &ev)
+  {
+    Write ('i', ev);
+    MapScheduler::Insert (ev);
+  }
+  virtual Scheduler::Event RemoveNext (void)
+  {
+    Scheduler::Event ev = MapScheduler::RemoveNext ();
+    Write ('r', ev);
+    return ev;
+  }
+  virtual void Remove (const Scheduler::Event &ev)
+  {
+    Write ('x', ev);
+    MapScheduler::Remove (ev);
+  }
+
+private:
+  /**
+   * \param op the operation
+   * \param ev the event
+   */
+  void Write (char op, const Scheduler::Event &ev)
+  {
+    if (g_file != 0)
+      {
+        g_file->write (&op, sizeof (op));
+        g_file->write (reinterpret_cast<const char *> (&ev.key.m_ts), sizeof (ev.key.m_ts));
+        g_file->write (reinterpret_cast<const char *> (&ev.key.m_uid), sizeof (ev.key.m_uid));
+      }
+  }
+};
+
+std::ofstream *RecordingScheduler::g_file = 0;
+
+NS_OBJECT_ENSURE_REGISTERED (RecordingScheduler);
+
+/**
+ * Run a simulation with adjacent channel interference on the recording
+ * scheduler: pairs of nodes exchanging UDP packets, the pairs assigned
+ * round robin to adjacent 20 MHz channels and to partially overlapping
+ * 40 and 80 MHz channels.
+ *
+ * \param filename the name of the file to write the operations to
+ * \param w the workload, of which the nodes, the side and the seed are used
+ * \param duration the simulated time in s
+ */
+void
+Record (std::string filename, const struct Workload &w, double duration)
+{
+  std::ofstream file (filename.c_str (), std::ios::binary);
+  NS_ABORT_MSG_IF (!file, "Cannot open " << filename);
+  RecordingScheduler::g_file = &file;
+  GlobalValue::Bind ("SchedulerType", StringValue ("ns3::YansWifiRecordingScheduler"));
+
+  NodeContainer nodes;
+  nodes.Create (w.nodes);
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  Lcg rng (w.seed);
+  for (uint32_t i = 0; i < w.nodes; i++)
+    {
+      double x = rng.Next () * w.side;
+      double y = rng.Next () * w.side;
+      positions->Add (Vector (x, y, 0));
+    }
+  mobility.SetPositionAllocator (positions);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ac);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("VhtMcs5"),
+                                "ControlMode", StringValue ("VhtMcs0"));
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+  wifi.AssignStreams (devices, w.seed);
+
+  //center frequency in MHz and width in MHz of the channels
+  const uint32_t channels[][2] = {{5180, 20}, {5200, 20}, {5190, 40}, {5210, 80}};
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      const uint32_t *configuration = channels[(i / 2) % 4];
+      Ptr<YansWifiPhy> yansPhy = DynamicCast<YansWifiPhy> (DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ());
+      yansPhy->SetChannelWidth (configuration[1]);
+      yansPhy->SetFrequency (configuration[0]);
+    }
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  ApplicationContainer applications;
+  for (uint32_t i = 0; i + 1 < w.nodes; i += 2)
+    {
+      UdpServerHelper server (9);
+      applications.Add (server.Install (nodes.Get (i + 1)));
+      UdpClientHelper client (interfaces.GetAddress (i + 1), 9);
+      client.SetAttribute ("MaxPackets", UintegerValue (0xffffffff));
+      client.SetAttribute ("Interval", TimeValue (MilliSeconds (2)));
+      client.SetAttribute ("PacketSize", UintegerValue (1000));
+      ApplicationContainer sender = client.Install (nodes.Get (i));
+      sender.Start (Seconds (1.0 + 0.001 * i));
+      applications.Add (sender);
+    }
+  applications.Stop (Seconds (1.0 + duration));
+
+  Simulator::Stop (Seconds (1.5 + duration));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  RecordingScheduler::g_file = 0;
+  file.close ();
+}
+
+/**
+ * Read the operations recorded by Record.
+ *
+ * \param filename the name of the file
+ * \param operations the operations read
+ */
+void
+Load (std::string filename, std::vector<struct Operation> &operations)
+{
+  std::ifstream file (filename.c_str (), std::ios::binary);
+  NS_ABORT_MSG_IF (!file, "Cannot open " << filename);
+  struct Operation operation;
+  while (file.read (&operation.op, sizeof (operation.op))
+         && file.read (reinterpret_cast<char *> (&operation.ts), sizeof (operation.ts))
+         && file.read (reinterpret_cast<char *> (&operation.uid), sizeof (operation.uid)))
+    {
+      operations.push_back (operation);
+    }
+}
+
+/**
+ * Replay recorded operations on a scheduler.
+ *
+ * \param scheduler the scheduler, empty
+ * \param operations the operations
+ * \return the result
+ */
+Result
+Replay (Ptr<Scheduler> scheduler, const std::vector<struct Operation> &operations)
+{
+  struct Result result = {0, 0, 0, 0};
+  uint32_t size = 0;
+  Scheduler::Event ev;
+  ev.impl = 0;
+  ev.key.m_context = 0;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (std::vector<struct Operation>::const_iterator it = operations.begin (); it != operations.end (); ++it)
+    {
+      switch (it->op)
+        {
+        case 'i':
+          ev.key.m_ts = it->ts;
+          ev.key.m_uid = it->uid;
+          scheduler->Insert (ev);
+          size++;
+          break;
+        case 'r':
+          {
+            Scheduler::Event next = scheduler->RemoveNext ();
+            size--;
+            result.events++;
+            result.checksum = result.checksum * 1099511628211ULL + (next.key.m_ts ^ next.key.m_uid);
+          }
+          break;
+        case 'x':
+          ev.key.m_ts = it->ts;
+          ev.key.m_uid = it->uid;
+          scheduler->Remove (ev);
+          size--;
+          break;
+        default:
+          NS_ABORT_MSG ("Unknown operation in the trace");
+        }
+      result.maxSize = std::max (result.maxSize, size);
+    }
+  result.ms = clock.End ();
+  return result;
+}
+
+} //anonymous namespace
+
+int
+main (int argc, char *argv[])
+{
+  struct Workload w;
+  w.nodes = 100;
+  w.transmissions = 50000;
+  w.side = 100;
+  w.syncProbability = 0.3;
+  w.seed = 1;
+  std::string schedulers = "ns3::MapScheduler,ns3::HeapScheduler,ns3::CalendarScheduler,ns3::YansWifiBucketScheduler";
+  uint32_t repetitions = 3;
+  std::string record;
+  std::string trace;
+  double duration = 2.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", w.nodes);
+  cmd.AddValue ("transmissions", "Total number of transmissions", w.transmissions);
+  cmd.AddValue ("side", "Side of the square the nodes are placed in, in m", w.side);
+  cmd.AddValue ("syncProbability", "Probability that a receiver synchronizes to a frame", w.syncProbability);
+  cmd.AddValue ("seed", "Seed of the workload", w.seed);
+  cmd.AddValue ("schedulers", "Comma-separated TypeIds of the schedulers", schedulers);
+  cmd.AddValue ("repetitions", "Number of runs per scheduler, the fastest one is reported", repetitions);
+  cmd.AddValue ("record", "Record the scheduler operations of a simulation with adjacent channel interference "
+                "to this file, and exit", record);
+  cmd.AddValue ("duration", "Simulated time of the recorded simulation in s", duration);
+  cmd.AddValue ("trace", "Replay the scheduler operations recorded in this file instead of the synthetic workload",
+                trace);
+  cmd.Parse (argc, argv);
+
+  if (!record.empty ())
+    {
+      Record (record, w, duration);
+      return 0;
+    }
+  std::vector<struct Operation> operations;
+  if (!trace.empty ())
+    {
+      Load (trace, operations);
+    }
+
+  std::cout << std::left << std::setw (32) << "scheduler"
+            << std::right << std::setw (12) << "events"
+            << std::setw (12) << "max queue"
+            << std::setw (10) << "ms"
+            << std::setw (14) << "events/s"
+            << std::setw (22) << "checksum" << std::endl;
+
+  uint64_t reference = 0;
+  bool first = true;
+  bool identical = true;
+  std::istringstream list (schedulers);
+  std::string name;
+  while (std::getline (list, name, ','))
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (name);
+      struct Result best = {0, 0, 0, 0};
+      for (uint32_t r = 0; r < repetitions; r++)
+        {
+          struct Result result = trace.empty () ? Run (factory.Create<Scheduler> (), w)
+            : Replay (factory.Create<Scheduler> (), operations);
+          if (r == 0 || result.ms < best.ms)
+            {
+              best = result;
+            }
+        }
+      if (first)
+        {
+          reference = best.checksum;
+          first = false;
+        }
+      identical = identical && best.checksum == reference;
+      std::cout << std::left << std::setw (32) << name
+                << std::right << std::setw (12) << best.events
+                << std::setw (12) << best.maxSize
+                << std::setw (10) << best.ms
+                << std::setw (14) << static_cast<uint64_t> (best.events * 1000.0 / std::max<int64_t> (best.ms, 1))
+                << std::setw (22) << std::hex << best.checksum << std::dec << std::endl;
+    }
+  if (!identical)
+    {
+      std::cout << "The schedulers did not remove the events in the same order" << std::endl;
+      return 1;
+    }
+  return 0;
+}
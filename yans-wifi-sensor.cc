@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#include "yans-wifi-sensor.h"
+#include "yans-wifi-phy.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include <cmath>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("YansWifiSensor");
+
+NS_OBJECT_ENSURE_REGISTERED (YansWifiSensor);
+
+TypeId
+YansWifiSensor::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::YansWifiSensor")
+    .SetParent<Object> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<YansWifiSensor> ()
+    .AddAttribute ("Frequency",
+                   "The central frequency of the sensor in MHz.",
+                   UintegerValue (5180),
+                   MakeUintegerAccessor (&YansWifiSensor::SetFrequency,
+                                         &YansWifiSensor::GetFrequency),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ChannelWidth",
+                   "The channel width of the sensor in MHz, split into 20 MHz subchannels.",
+                   UintegerValue (20),
+                   MakeUintegerAccessor (&YansWifiSensor::SetChannelWidth,
+                                         &YansWifiSensor::GetChannelWidth),
+                   MakeUintegerChecker<uint32_t> (5, 160))
+    .AddAttribute ("RxGain",
+                   "The reception gain in dB.",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&YansWifiSensor::m_rxGainDb),
+                   MakeDoubleChecker<double> ())
+  ;
+  return tid;
+}
+
+YansWifiSensor::YansWifiSensor ()
+  : m_frequency (5180),
+    m_channelWidth (0),
+    m_rxGainDb (1.0),
+    m_signals (0)
+{
+  NS_LOG_FUNCTION (this);
+  SetChannelWidth (20);
+}
+
+YansWifiSensor::~YansWifiSensor ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+YansWifiSensor::SetFrequency (uint32_t frequency)
+{
+  NS_LOG_FUNCTION (this << frequency);
+  m_frequency = frequency;
+}
+
+uint32_t
+YansWifiSensor::GetFrequency (void) const
+{
+  return m_frequency;
+}
+
+void
+YansWifiSensor::SetChannelWidth (uint32_t width)
+{
+  NS_LOG_FUNCTION (this << width);
+  m_channelWidth = width;
+  //the same split as the overlap factors computed by YansWifiChannel
+  uint32_t nSubchannels = std::max<uint32_t> (1, std::min<uint32_t> (Parameters::MAX_SUBCHANNELS, width / 20));
+  m_energyJ.assign (nSubchannels, 0.0);
+  m_reportedJ.assign (nSubchannels, 0.0);
+}
+
+uint32_t
+YansWifiSensor::GetChannelWidth (void) const
+{
+  return m_channelWidth;
+}
+
+void
+YansWifiSensor::SetMobility (Ptr<MobilityModel> mobility)
+{
+  m_mobility = mobility;
+}
+
+Ptr<MobilityModel>
+YansWifiSensor::GetMobility (void) const
+{
+  return m_mobility;
+}
+
+uint32_t
+YansWifiSensor::GetNSubchannels (void) const
+{
+  return m_energyJ.size ();
+}
+
+uint32_t
+YansWifiSensor::GetSubchannelFrequency (uint32_t k) const
+{
+  uint32_t n = m_energyJ.size ();
+  return m_frequency - m_channelWidth / 2 + m_channelWidth * (2 * k + 1) / (2 * n);
+}
+
+double
+YansWifiSensor::GetEnergy (uint32_t k) const
+{
+  return m_energyJ[k];
+}
+
+uint64_t
+YansWifiSensor::GetSignalCount (void) const
+{
+  return m_signals;
+}
+
+void
+YansWifiSensor::AddEnergy (const double *subchannelRxPowerDbm, uint32_t nSubchannels, Time duration)
+{
+  NS_ASSERT (nSubchannels == m_energyJ.size ());
+  double seconds = duration.GetSeconds ();
+  for (uint32_t k = 0; k < nSubchannels; k++)
+    {
+      m_energyJ[k] += std::pow (10.0, (subchannelRxPowerDbm[k] + m_rxGainDb - 30) / 10.0) * seconds;
+    }
+  m_signals++;
+}
+
+void
+YansWifiSensor::WriteSample (std::ostream &os, uint32_t id)
+{
+  double now = Simulator::Now ().GetSeconds ();
+  for (uint32_t k = 0; k < m_energyJ.size (); k++)
+    {
+      if (m_energyJ[k] != m_reportedJ[k])
+        {
+          os << now << "," << id << "," << GetSubchannelFrequency (k) << ","
+             << m_energyJ[k] - m_reportedJ[k] << "\n";
+          m_reportedJ[k] = m_energyJ[k];
+        }
+    }
+}
+
+} //namespace ns3
@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+*  Copyright (C) 2017 Institute for Networked Systems, RWTH Aachen University
+*
+*  This program is free software; you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation; either version 2 of the License, or
+*  (at your option) any later version.
+*
+*  This program is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License along
+*  with this program; if not, write to the Free Software Foundation, Inc.,
+*  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*
+*  Contact information:
+*  Andra Voicu
+*  avo@inets.rwth-aachen.de
+*  Institute for Networked Systems
+*  RWTH Aachen University
+*  Kackertstr. 9
+*  52072 Aachen, Germany
+*  www.inets.rwth-aachen.de
+*/
+
+#ifndef YANS_WIFI_SENSOR_H
+#define YANS_WIFI_SENSOR_H
+
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/mobility-model.h"
+
+namespace ns3 {
+
+/**
+ * \brief Passive spectrum sensor attached to a YansWifiChannel
+ * \ingroup wifi
+ *
+ * A sensor is a receiver that never decodes anything: it has no state
+ * machine, no interference tracker, no A-MPDU tracking and gets no packet
+ * and no event. For each transmission on the channel, YansWifiChannel::Send
+ * computes the rx power of the sensor with the mean log-distance loss and
+ * the overlap factors of its 20 MHz subchannels, and adds the energy of
+ * the transmission (rx power times duration) to each subchannel at once.
+ * The loss model of the PHYs is not used, so that the sensors do not draw
+ * from its random streams; another model can be given with
+ * YansWifiChannel::SetSensorPropagationLossModel.
+ * The propagation delay is neglected, so the energy is accounted at the
+ * start of the transmission.
+ *
+ * The energies are cumulative; YansWifiChannel::EnableSensorReport
+ * writes them periodically as a time series.
+ */
+class YansWifiSensor : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  YansWifiSensor ();
+  virtual ~YansWifiSensor ();
+
+  /**
+   * \param frequency the central frequency in MHz
+   */
+  void SetFrequency (uint32_t frequency);
+  /**
+   * \return the central frequency in MHz
+   */
+  uint32_t GetFrequency (void) const;
+  /**
+   * Set the channel width. The accumulated energies are reset.
+   *
+   * \param width the channel width in MHz
+   */
+  void SetChannelWidth (uint32_t width);
+  /**
+   * \return the channel width in MHz
+   */
+  uint32_t GetChannelWidth (void) const;
+  /**
+   * \param mobility the mobility model giving the position of the sensor
+   */
+  void SetMobility (Ptr<MobilityModel> mobility);
+  /**
+   * \return the mobility model giving the position of the sensor
+   */
+  Ptr<MobilityModel> GetMobility (void) const;
+
+  /**
+   * \return the number of 20 MHz subchannels of the sensor
+   */
+  uint32_t GetNSubchannels (void) const;
+  /**
+   * \param k the index of the subchannel, lowest first
+   *
+   * \return the central frequency of the subchannel in MHz
+   */
+  uint32_t GetSubchannelFrequency (uint32_t k) const;
+  /**
+   * \param k the index of the subchannel, lowest first
+   *
+   * \return the energy received on the subchannel in J
+   */
+  double GetEnergy (uint32_t k) const;
+  /**
+   * \return the number of signals received
+   */
+  uint64_t GetSignalCount (void) const;
+
+  /**
+   * Add the energy of a signal. Called by YansWifiChannel.
+   *
+   * \param subchannelRxPowerDbm the rx power of each subchannel in dBm, before the rx gain
+   * \param nSubchannels the number of subchannels, as returned by GetNSubchannels
+   * \param duration the duration of the signal
+   */
+  void AddEnergy (const double *subchannelRxPowerDbm, uint32_t nSubchannels, Time duration);
+  /**
+   * Write one "time,sensor,frequency,energy" line for each subchannel
+   * that received energy since the previous call.
+   *
+   * \param os the output stream
+   * \param id the identifier of the sensor written in the lines
+   */
+  void WriteSample (std::ostream &os, uint32_t id);
+
+private:
+  uint32_t m_frequency;           //!< central frequency in MHz
+  uint32_t m_channelWidth;        //!< channel width in MHz
+  double m_rxGainDb;              //!< reception gain in dB
+  Ptr<MobilityModel> m_mobility;  //!< position of the sensor
+  std::vector<double> m_energyJ;  //!< energy of each subchannel in J
+  std::vector<double> m_reportedJ; //!< energy of each subchannel at the last sample in J
+  uint64_t m_signals;             //!< number of signals received
+};
+
+} //namespace ns3
+
+#endif /* YANS_WIFI_SENSOR_H */